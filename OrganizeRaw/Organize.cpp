@@ -79,7 +79,7 @@
 //---------------------------------------------------------------------------------------------------------
 //Useful ROOT stuff
 //I haven't defined many histos. Feel free to do so
-//I have two MyFill functions defined (for 1d and 2d histos)--very convenient
+//Declare a histogram (family) with fh.Book() and fill it with fh.Fill(handle(indices),...)--very convenient (see ../include/HistRegistry.h)
 //Or you can define histos in a standard way
 //I draw things from a root terminal
 //E-DE:
@@ -123,22 +123,33 @@
 #include "../include/ChannelMap.h"
 #include "../include/2016_detclass.h"
 #include "SortSilicon.h"
+#include "../include/HistRegistry.h"
 
 #define MaxPCHits 24
 #define NPCWires  24
 
 using namespace std;
 
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY);
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX);
-
 Int_t FindMaxPC(Double_t phi, PCHit& PC);
 
 TList* fhlist;
-std::map<string,TH1*> fhmap;
+HistRegistry fh; //histograms of fhlist, filled through the handles below (../include/HistRegistry.h)
+HistFamily hPCEnergy_Wire8_vs_9 = fh.Book("PCEnergy_Wire8_vs_9");
+HistFamily hTiming = fh.Book("Timing");
+HistFamily hback_vs_frontN = fh.Book("back_vs_front%i",NumDet);
+HistFamily hback_vs_frontN_frontN = fh.Book("back_vs_front%i_front%i",NumDet,16);
+HistFamily hback_vs_frontN_backN = fh.Book("back_vs_front%i_back%i",NumDet,16);
+HistFamily hback_vs_frontN_N_N = fh.Book("back_vs_front%i_%i_%i",NumDet,16,16);
+HistFamily hdown_vs_upN_frontN = fh.Book("down_vs_up%i_front%i",NumDet,16);
+HistFamily hdown_vs_up_divideBackN_frontN = fh.Book("down_vs_up_divideBack%i_front%i",NumDet,16);
+HistFamily hPCPhi_vs_SiPhi_SX3 = fh.Book("PCPhi_vs_SiPhi_SX3");
+HistFamily hPCEnergy_Wire8_vs_9_cut = fh.Book("PCEnergy_Wire8_vs_9_cut");
+HistFamily hPCPhi_vs_SiPhi_QQQ = fh.Book("PCPhi_vs_SiPhi_QQQ");
+HistFamily hE_de_QQQ = fh.Book("E_de_QQQ");
+HistFamily hE_theta_QQQ = fh.Book("E_theta_QQQ");
+HistFamily hE_de_SX3 = fh.Book("E_de_SX3");
+HistFamily hE_theta_SX3 = fh.Book("E_theta_SX3");
+HistFamily hPCZ_vs_Z_nocalN = fh.Book("PCZ_vs_Z_nocal%i",NPCWires);
 
 bool Track::Si_sort_method(struct Silicon_Event a,struct Silicon_Event b){
   if(a.SiEnergy > b.SiEnergy)
@@ -196,6 +207,7 @@ int main(int argc, char* argv[]){
   //-------------------------------------------------------------------------------------------------------------------------------------------
 
   fhlist = new TList;
+  fh.SetList(fhlist);
   RootObjects->Add(fhlist);
 
   ChannelMap *CMAP;
@@ -439,7 +451,7 @@ int main(int argc, char* argv[]){
       }
     }
     if (Good8 == 1 && Good9 == 1){
-      MyFill("PCEnergy_Wire8_vs_9",300,0,1,Energy8,300,0,1,Energy9);
+      fh.Fill(hPCEnergy_Wire8_vs_9(),300,0,1,Energy8,300,0,1,Energy9);
     }
  
     //--------------MCP/RF TIMING------------------------
@@ -460,7 +472,7 @@ int main(int argc, char* argv[]){
       }
     }
 
-    MyFill("Timing",600,1,600,fmod((MCPTime*correct-RFTime),546)); //by M.A.
+    fh.Fill(hTiming(),600,1,600,fmod((MCPTime*correct-RFTime),546)); //by M.A.
     
     //MyFill("Timing",400,-600,600,(MCPTime-RFTime)%538);
     //Can define the TimingCut at the top of the program
@@ -584,26 +596,26 @@ int main(int argc, char* argv[]){
 	//---Histos after the energy calibration
 
 	if (Si.hit_place_holder.HitType==111){
-	  MyFill(Form("back_vs_front%i",Si.hit_place_holder.DetID),300,0,30,Si.hit_place_holder.EnergyFront,300,0,30,Si.hit_place_holder.EnergyBack);
-	  MyFill(Form("back_vs_front%i_front%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("back_vs_front%i_back%i",Si.det_place_holder.DetID,Si.det_place_holder.BackChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("back_vs_front%i_%i_%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0],Si.det_place_holder.BackChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("down_vs_up%i_front%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0],300,0,30,Si.det_place_holder.EnergyDown_Cal[0]);
+	  fh.Fill(hback_vs_frontN(Si.hit_place_holder.DetID),300,0,30,Si.hit_place_holder.EnergyFront,300,0,30,Si.hit_place_holder.EnergyBack);
+	  fh.Fill(hback_vs_frontN_frontN(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN_backN(Si.det_place_holder.DetID,Si.det_place_holder.BackChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN_N_N(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0],Si.det_place_holder.BackChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hdown_vs_upN_frontN(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0],300,0,30,Si.det_place_holder.EnergyDown_Cal[0]);
 	}
 
 	//---Histos before energy calibration
 	
 	if (Si.hit_place_holder.HitType==111){
-	  MyFill(Form("back_vs_front%i",Si.hit_place_holder.DetID),512,0,16384,Si.hit_place_holder.EnergyFront,512,0,16384,Si.hit_place_holder.EnergyBack);
-	  MyFill(Form("back_vs_front%i_front%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("back_vs_front%i_back%i",Si.det_place_holder.DetID,Si.det_place_holder.BackChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("back_vs_front%i_%i_%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0],Si.det_place_holder.BackChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("down_vs_up%i_front%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0],512,0,16384,Si.det_place_holder.EnergyDown_Cal[0]);
-	  MyFill(Form("down_vs_up_divideBack%i_front%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),100,0,1,(Si.det_place_holder.EnergyUp_Cal[0]/Si.det_place_holder.EnergyBack_Cal[0]),100,0,1,(Si.det_place_holder.EnergyDown_Cal[0]/Si.det_place_holder.EnergyBack_Cal[0]));
+	  fh.Fill(hback_vs_frontN(Si.hit_place_holder.DetID),512,0,16384,Si.hit_place_holder.EnergyFront,512,0,16384,Si.hit_place_holder.EnergyBack);
+	  fh.Fill(hback_vs_frontN_frontN(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN_backN(Si.det_place_holder.DetID,Si.det_place_holder.BackChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN_N_N(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0],Si.det_place_holder.BackChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0]+Si.det_place_holder.EnergyDown_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hdown_vs_upN_frontN(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0],512,0,16384,Si.det_place_holder.EnergyDown_Cal[0]);
+	  fh.Fill(hdown_vs_up_divideBackN_frontN(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),100,0,1,(Si.det_place_holder.EnergyUp_Cal[0]/Si.det_place_holder.EnergyBack_Cal[0]),100,0,1,(Si.det_place_holder.EnergyDown_Cal[0]/Si.det_place_holder.EnergyBack_Cal[0]));
 	  }
 	
 	for ( Int_t hits=0; hits<PC.NPCHits; hits++ ){
-	  MyFill("PCPhi_vs_SiPhi_SX3",300,0,8,Si.hit_place_holder.PhiW,300,0,8,PC.Hit.at(hits).PhiW);
+	  fh.Fill(hPCPhi_vs_SiPhi_SX3(),300,0,8,Si.hit_place_holder.PhiW,300,0,8,PC.Hit.at(hits).PhiW);
 	}
 
       }
@@ -623,7 +635,7 @@ int main(int argc, char* argv[]){
 	    Si.det_place_holder.EnergyBack_Cal.push_back(QQQ3Energy_Cal[i][j]);
 	    Si.det_place_holder.TimeBack.push_back(QQQ3Time[i][j]);
 	    if (i==1 && j==14){
-	      MyFill("PCEnergy_Wire8_vs_9_cut",300,0,1,Energy8,300,0,1,Energy9);
+	      fh.Fill(hPCEnergy_Wire8_vs_9_cut(),300,0,1,Energy8,300,0,1,Energy9);
 	    }
 	  }else if(j>15){
 	    Si.det_place_holder.UpChNum.push_back(j-16);
@@ -654,23 +666,23 @@ int main(int argc, char* argv[]){
 	//---Histos after the energy calibration
 
 	if (Si.det_place_holder.HitType==11){
-	  MyFill(Form("back_vs_front%i",Si.hit_place_holder.DetID),300,0,30,Si.hit_place_holder.EnergyFront,300,0,30,Si.hit_place_holder.EnergyBack);
-	  MyFill(Form("back_vs_front%i_front%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("back_vs_front%i_back%i",Si.det_place_holder.DetID,Si.det_place_holder.BackChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("back_vs_front%i_%i_%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0],Si.det_place_holder.BackChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN(Si.hit_place_holder.DetID),300,0,30,Si.hit_place_holder.EnergyFront,300,0,30,Si.hit_place_holder.EnergyBack);
+	  fh.Fill(hback_vs_frontN_frontN(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN_backN(Si.det_place_holder.DetID,Si.det_place_holder.BackChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN_N_N(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0],Si.det_place_holder.BackChNum[0]),300,0,30,Si.det_place_holder.EnergyUp_Cal[0],300,0,30,Si.det_place_holder.EnergyBack_Cal[0]);
 	}
 
 	//---Histos before the energy calibration
 
 	if (Si.det_place_holder.HitType==11){
-	  MyFill(Form("back_vs_front%i",Si.hit_place_holder.DetID),512,0,16384,Si.hit_place_holder.EnergyFront,512,0,16384,Si.hit_place_holder.EnergyBack);
-	  MyFill(Form("back_vs_front%i_front%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("back_vs_front%i_back%i",Si.det_place_holder.DetID,Si.det_place_holder.BackChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
-	  MyFill(Form("back_vs_front%i_%i_%i",Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0],Si.det_place_holder.BackChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN(Si.hit_place_holder.DetID),512,0,16384,Si.hit_place_holder.EnergyFront,512,0,16384,Si.hit_place_holder.EnergyBack);
+	  fh.Fill(hback_vs_frontN_frontN(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN_backN(Si.det_place_holder.DetID,Si.det_place_holder.BackChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
+	  fh.Fill(hback_vs_frontN_N_N(Si.det_place_holder.DetID,Si.det_place_holder.UpChNum[0],Si.det_place_holder.BackChNum[0]),512,0,16384,Si.det_place_holder.EnergyUp_Cal[0],512,0,16384,Si.det_place_holder.EnergyBack_Cal[0]);
 	  }
 
 	for ( Int_t hits=0; hits<PC.NPCHits; hits++ ){
-	  MyFill("PCPhi_vs_SiPhi_QQQ",300,0,8,Si.hit_place_holder.PhiW,300,0,8,PC.Hit.at(hits).PhiW);
+	  fh.Fill(hPCPhi_vs_SiPhi_QQQ(),300,0,8,Si.hit_place_holder.PhiW,300,0,8,PC.Hit.at(hits).PhiW);
 	}
 
 	
@@ -736,14 +748,14 @@ int main(int argc, char* argv[]){
 	//--------------------E_dE histograms--------------------------------------------------------
 	
        	for(int i=0;i<NumQQQ3; i++){
-	MyFill("E_de_QQQ",300,0,30,Tr.track_place_holder.SiEnergy,300,0,1,Tr.track_place_holder.PCEnergy*sin(Tr.track_place_holder.Theta));
-	MyFill("E_theta_QQQ",300,0,180,Tr.track_place_holder.Theta*180/TMath::Pi(),300,0,35,Tr.track_place_holder.SiEnergy);
+	fh.Fill(hE_de_QQQ(),300,0,30,Tr.track_place_holder.SiEnergy,300,0,1,Tr.track_place_holder.PCEnergy*sin(Tr.track_place_holder.Theta));
+	fh.Fill(hE_theta_QQQ(),300,0,180,Tr.track_place_holder.Theta*180/TMath::Pi(),300,0,35,Tr.track_place_holder.SiEnergy);
 	}
 	
 	
 	for(int i=0;i<NumX3; i++){
-	MyFill("E_de_SX3",300,0,30,Tr.track_place_holder.SiEnergy,300,0,1,Tr.track_place_holder.PCEnergy*sin(Tr.track_place_holder.Theta));
-	MyFill("E_theta_SX3",300,0,180,Tr.track_place_holder.Theta*180/TMath::Pi(),300,0,35,Tr.track_place_holder.SiEnergy);
+	fh.Fill(hE_de_SX3(),300,0,30,Tr.track_place_holder.SiEnergy,300,0,1,Tr.track_place_holder.PCEnergy*sin(Tr.track_place_holder.Theta));
+	fh.Fill(hE_theta_SX3(),300,0,180,Tr.track_place_holder.Theta*180/TMath::Pi(),300,0,35,Tr.track_place_holder.SiEnergy);
 	}
 
 
@@ -762,7 +774,7 @@ int main(int argc, char* argv[]){
 	Double_t bpc = Tr.track_place_holder.SiZ - mpc*Tr.track_place_holder.SiR;
 
 	Tr.track_place_holder.PCZ_Ref = mpc*3.75 + bpc;
-	MyFill(Form("PCZ_vs_Z_nocal%i",Tr.track_place_holder.WireID),300,0,50,Tr.track_place_holder.PCZ_Ref,300,-1,1,PC.Hit.at(GoodPC).Z);
+	fh.Fill(hPCZ_vs_Z_nocalN(Tr.track_place_holder.WireID),300,0,50,Tr.track_place_holder.PCZ_Ref,300,-1,1,PC.Hit.at(GoodPC).Z);
 #endif
 
 	Tr.NTracks++;
@@ -787,34 +799,6 @@ outputFile->Close();
   return 0;
 }
 
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX){
-  try{
-    fhmap.at(name)->Fill(valueX);
-  } catch(out_of_range e) {
-    TH1F* newHist = new TH1F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX);
-    newHist->Fill(valueX);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }
-}
-
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY){
-  try{
-    fhmap.at(name)->Fill(valueX,valueY);
-  } catch(out_of_range e) {
-    TH2F* newHist = new TH2F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX,
-			     binsY,lowY,highY);
-    newHist->Fill(valueX,valueY);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }
-}
-
 Int_t FindMaxPC(Double_t phi, PCHit& PC){
   Int_t GoodPC = -1;
   Double_t MaxPC = -10;
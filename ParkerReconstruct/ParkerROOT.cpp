@@ -11,6 +11,8 @@
 
 #define FillHists
 #define FillTree
+#define InputCache (Long64_t) 30000000 //bytes of TTreeCache for the branches read from the input MainTree (../include/TreeInput.h)
+#define AsyncPrefetch (Bool_t) kFALSE  //read the next cache blocks on a ROOT thread, for input files on a network file system
 
 #define MaxSiHits   500
 #define MaxADCHits  500
@@ -47,6 +49,7 @@
 #include <TVector3.h>
 
 #include "../include/organizetree.h"
+#include "../include/TreeInput.h"
 #include "/home/manasta/Desktop/parker_codes/Include/Reconstruct.h"
 
 using namespace std;
@@ -180,6 +183,8 @@ int main(int argc, char* argv[]){
   }
   string rootfile;
   char rootfile_char[100];
+  TreeInput::SetAsyncPrefetch(AsyncPrefetch);
+  TreeReadStats read_stats;
 
   //EnergyLoss *E_Loss_alpha = new EnergyLoss("/home2/parker/ANASEN/LSU/CalParamFiles/He4_D2_400Torr.eloss",M_alpha);
 
@@ -199,24 +204,28 @@ int main(int argc, char* argv[]){
 
     TTree *raw_tree = (TTree*) inputFile->Get("MainTree");
 
-    raw_tree->SetBranchAddress("Si.NSiHits",&Si.NSiHits);
-    raw_tree->SetBranchAddress("Si.Detector",&Si.ReadDet);
-    raw_tree->SetBranchAddress("Si.Hit",&Si.ReadHit);
-    raw_tree->SetBranchAddress("PC.NPCHits",&PC.NPCHits);
-    raw_tree->SetBranchAddress("PC.Hit",&PC.ReadHit);
-    raw_tree->SetBranchAddress("Tr.NTracks",&Old_Tr.NTracks);
-    raw_tree->SetBranchAddress("Tr.TrackEvent",&Old_Tr.ReadTrEvent);
-    raw_tree->SetBranchAddress("RFTime",&Old_RFTime);
-    raw_tree->SetBranchAddress("MCPTime",&Old_MCPTime);
-    raw_tree->SetBranchAddress("IC",&Old_IC);
-    raw_tree->SetBranchAddress("E_IC",&Old_E_IC);
+    //only the branches bound here are read; Si.Detector is not used (../include/TreeInput.h)
+    TreeInput input(raw_tree,InputCache);
+    input.Read("Si.NSiHits",&Si.NSiHits);
+    input.Read("Si.Hit",&Si.ReadHit);
+    input.Use("Si.Hit.*");
+    input.Read("PC.NPCHits",&PC.NPCHits);
+    input.Read("PC.Hit",&PC.ReadHit);
+    input.Use("PC.Hit.*");
+    input.Read("Tr.NTracks",&Old_Tr.NTracks);
+    input.Read("Tr.TrackEvent",&Old_Tr.ReadTrEvent);
+    input.Use("Tr.TrackEvent.*");
+    input.Read("RFTime",&Old_RFTime);
+    input.Read("MCPTime",&Old_MCPTime);
+    input.Read("IC",&Old_IC);
+    input.Read("E_IC",&Old_E_IC);
     
 
     
     Long64_t nentries = raw_tree->GetEntries();
     Int_t status;
     for (Long64_t i=0; i<nentries; i++){//loop over all events
-      status = raw_tree->GetEvent(i);
+      status = input.GetEntry(i);
 
       //cout << "Event_Number: " << i << endl;
       if (i == TMath::Nint(0.01*nentries))  cout << " 1% through the data" << endl;
@@ -422,10 +431,12 @@ int main(int argc, char* argv[]){
       MainTree->Fill();
 #endif
     }
+    read_stats += input.GetStats();
     //    delete inputFile;
   }
 
 
+  read_stats.Print("Input MainTree");
   outputfile->cd();
   RootObjects->Write();
 
@@ -16,6 +16,8 @@
 
 #define FillHists
 #define FillTree
+#define InputCache (Long64_t) 30000000 //bytes of TTreeCache for the branches read from the input MainTree (../include/TreeInput.h)
+#define AsyncPrefetch (Bool_t) kFALSE  //read the next cache blocks on a ROOT thread, for input files on a network file system
 
 #define MaxSiHits   500
 #define MaxADCHits  500
@@ -52,19 +54,18 @@
 #include <TVector3.h>
 
 #include "../include/organizetree.h"
+#include "../include/TreeInput.h"
+#include "../include/HistRegistry.h"
+#include "../include/CutRegistry.h"
 #include "/home/manasta/Desktop/parker_codes/Include/Reconstruct.h"
 
 using namespace std;
 
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX);
-
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY);
-
 TList* fhlist;
-std::map<string,TH1*> fhmap;
+HistRegistry fh; //histograms of fhlist, filled through the handles below (../include/HistRegistry.h)
+HistFamily hTiming = fh.Book("Timing");
+HistFamily hE_de_corrected = fh.Book("E_de_corrected");
+HistFamily hE_theta = fh.Book("E_theta");
 
 bool Track::Si_sort_method(struct Silicon_Event a,struct Silicon_Event b){
   if(a.SiEnergy > b.SiEnergy)
@@ -96,34 +97,32 @@ int main(int argc, char* argv[]){
   strcpy( filename_cut, argv[3] );
   strcpy( filename_cut2, argv[4] );
 
-  TFile *cut_file = new TFile(filename_cut);
-  if (!cut_file->IsOpen()){
+  CutRegistry Cuts; //all the cuts of the files, read once (../include/CutRegistry.h)
+  if (!Cuts.LoadFile(filename_cut)){
     cout << "Cut file: " << filename_cut << " could not be opened.\n";
     exit(EXIT_FAILURE);
   }
-  TCutG *cut = NULL;
-  cut = (TCutG*)cut_file->Get("alphas");
+  const FastCut *cut = NULL;
+  cut = Cuts.Get(filename_cut,"alphas");
   if (cut == NULL){
     cout << "Cut does not exist\n";
     exit(EXIT_FAILURE);
   }
-  cut_file->Close();
-  TFile *cut_file2 = new TFile(filename_cut2);
-  if (!cut_file2->IsOpen()){
+  if (!Cuts.LoadFile(filename_cut2)){
     cout << "Cut file: " << filename_cut2 << " could not be opened.\n";
     exit(EXIT_FAILURE);
   }else{
     cout << "Opened File: " << filename_cut2 << endl;
   }
-  TCutG *cut_protons1 = NULL;
-  cut_protons1 = (TCutG*)cut_file2->Get("protons");
+  const FastCut *cut_protons1 = NULL;
+  cut_protons1 = Cuts.Get(filename_cut2,"protons");
   if (cut_protons1 == NULL){
     cout << "Cut does not exist\n";
     exit(EXIT_FAILURE);
   }
 
-  /* TCutG *cut_protons2 = NULL;
-  cut_protons2 = (TCutG*)cut_file2->Get("protons2");
+  /* const FastCut *cut_protons2 = NULL;
+  cut_protons2 = Cuts.Get(filename_cut2,"protons2");
   if (cut_protons2 == NULL){
     cout << "Cut does not exist\n";
     exit(EXIT_FAILURE);
@@ -173,6 +172,7 @@ int main(int argc, char* argv[]){
   RootObjects->Add(E_de);
 
   fhlist = new TList;
+  fh.SetList(fhlist);
   RootObjects->Add(fhlist);
   Double_t avg_beam_energy = 0;
 
@@ -184,6 +184,8 @@ int main(int argc, char* argv[]){
   }
   string rootfile;
   char rootfile_char[100];
+  TreeInput::SetAsyncPrefetch(AsyncPrefetch);
+  TreeReadStats read_stats;
 
   //EnergyLoss *E_Loss_alpha = new EnergyLoss("/home2/parker/ANASEN/LSU/CalParamFiles/He4_D2_400Torr.eloss",M_alpha);
 
@@ -203,23 +205,27 @@ int main(int argc, char* argv[]){
 
     TTree *raw_tree = (TTree*) inputFile->Get("MainTree");
 
-    raw_tree->SetBranchAddress("Si.NSiHits",&Si.NSiHits);
-    raw_tree->SetBranchAddress("Si.Detector",&Si.ReadDet);
-    raw_tree->SetBranchAddress("Si.Hit",&Si.ReadHit);
-    raw_tree->SetBranchAddress("PC.NPCHits",&PC.NPCHits);
-    raw_tree->SetBranchAddress("PC.Hit",&PC.ReadHit);
-    raw_tree->SetBranchAddress("Tr.NTracks",&Old_Tr.NTracks);
-    raw_tree->SetBranchAddress("Tr.TrackEvent",&Old_Tr.ReadTrEvent);
-    raw_tree->SetBranchAddress("RFTime",&Old_RFTime);
-    raw_tree->SetBranchAddress("MCPTime",&Old_MCPTime);
-    raw_tree->SetBranchAddress("IC",&Old_IC);
-    raw_tree->SetBranchAddress("E_IC",&Old_E_IC);
+    //only the branches bound here are read; Si.Detector is not used (../include/TreeInput.h)
+    TreeInput input(raw_tree,InputCache);
+    input.Read("Si.NSiHits",&Si.NSiHits);
+    input.Read("Si.Hit",&Si.ReadHit);
+    input.Use("Si.Hit.*");
+    input.Read("PC.NPCHits",&PC.NPCHits);
+    input.Read("PC.Hit",&PC.ReadHit);
+    input.Use("PC.Hit.*");
+    input.Read("Tr.NTracks",&Old_Tr.NTracks);
+    input.Read("Tr.TrackEvent",&Old_Tr.ReadTrEvent);
+    input.Use("Tr.TrackEvent.*");
+    input.Read("RFTime",&Old_RFTime);
+    input.Read("MCPTime",&Old_MCPTime);
+    input.Read("IC",&Old_IC);
+    input.Read("E_IC",&Old_E_IC);
 
     
     Long64_t nentries = raw_tree->GetEntries();
 MainTree->Branch("Tr.AlEvent",&Tr.AlEvent);MainTree->Branch("Tr.AlEvent",&Tr.AlEvent);    Int_t status;
     for (Long64_t i=0; i<nentries; i++){//loop over all events
-      status = raw_tree->GetEvent(i);
+      status = input.GetEntry(i);
 
       //cout << "Event_Number: " << i << endl;
       if (i == TMath::Nint(0.01*nentries))  cout << " 1% through the data" << endl;
@@ -246,7 +252,7 @@ MainTree->Branch("Tr.AlEvent",&Tr.AlEvent);MainTree->Branch("Tr.AlEvent",&Tr.AlE
 
       // cout << Old_MCPTime << " " << Old_RFTime << endl;
 
-      MyFill("Timing",600,1,600,fmod((MCPTime*correct-RFTime),546));
+      fh.Fill(hTiming(),600,1,600,fmod((MCPTime*correct-RFTime),546));
 
       //MyFill("Timing",600,1,600,(MCPTime-RFTime)%546);
 
@@ -291,10 +297,10 @@ MainTree->Branch("Tr.AlEvent",&Tr.AlEvent);MainTree->Branch("Tr.AlEvent",&Tr.AlE
 #ifdef FillHists
 	
 	E_de->Fill(Tr.track_place_holder.SiEnergy,Tr.track_place_holder.PCEnergy);
-	MyFill("E_de_corrected",300,0,30,Tr.track_place_holder.SiEnergy,300,0,1,Tr.track_place_holder.PCEnergy*sin(Tr.track_place_holder.Theta));
+	fh.Fill(hE_de_corrected(),300,0,30,Tr.track_place_holder.SiEnergy,300,0,1,Tr.track_place_holder.PCEnergy*sin(Tr.track_place_holder.Theta));
 	
 	E_theta->Fill(Tr.track_place_holder.Theta*180/M_PI,Tr.track_place_holder.SiEnergy);
-	MyFill("E_theta",300,0,180,Tr.track_place_holder.Theta*180/M_PI,300,0,35,Tr.track_place_holder.SiEnergy);
+	fh.Fill(hE_theta(),300,0,180,Tr.track_place_holder.Theta*180/M_PI,300,0,35,Tr.track_place_holder.SiEnergy);
 
 #endif
 
@@ -370,10 +376,12 @@ MainTree->Branch("Tr.AlEvent",&Tr.AlEvent);MainTree->Branch("Tr.AlEvent",&Tr.AlE
       MainTree->Fill();
 #endif
     }
+    read_stats += input.GetStats();
     //    delete inputFile;
   }
 
 
+  read_stats.Print("Input MainTree");
   outputfile->cd();
   RootObjects->Write();
 
@@ -382,32 +390,3 @@ MainTree->Branch("Tr.AlEvent",&Tr.AlEvent);MainTree->Branch("Tr.AlEvent",&Tr.AlE
 
 }
 
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX){
-  try{
-    fhmap.at(name)->Fill(valueX);
-  } catch(out_of_range e) {
-    TH1F* newHist = new TH1F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX);
-    newHist->Fill(valueX);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }
-}
-
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY){
-
-  try{
-    //cout << name << endl;
-    fhmap.at(name)->Fill(valueX,valueY);
-  } catch(std::out_of_range e) {
-    TH2F* newHist = new TH2F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX,
-			     binsY,lowY,highY);
-    newHist->Fill(valueX,valueY);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }  
-}
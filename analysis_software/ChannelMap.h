@@ -16,7 +16,6 @@
 
 #include <TROOT.h>
 #include <TMath.h>
-#include <TRandom3.h>
 
 #include <iostream>
 #include <fstream>
@@ -34,10 +33,38 @@
 #define MaxADC 5
 #define MaxADCCh 32
 
+//ranges of the ASICs channel lookup table (motherboard, chip, chip channel)
+#define MaxMBID 4
+#define MaxCBID 16
+#define MaxASICsCh 16
+
 #define doprint kFALSE
 #define dodiag kFALSE
 
 using namespace std;
+///////////////////////////////////////////////////////////////////////////////////
+// Energy calibration of one ASICs channel, with the coefficients of all the steps
+// (pulser alignment, relative gain, final zero shift, alpha gain) collected when
+// the calibration files are loaded:
+//   Pulser = p2*Raw*Raw + p1*Raw + p0     (linear alignment: p2=0, p1=1, p0=zero/gain)
+//   Rel    = Pulser*rel + shift
+//   Cal    = Rel*alpha = c2*Raw*Raw + c1*Raw + c0
+struct SiCalibration {
+  Double_t p0, p1, p2;
+  Double_t rel, shift, alpha;
+  Double_t c0, c1, c2;
+
+  // All the steps, in the order Main has always done them.
+  void Steps(Double_t raw, Double_t& pulser, Double_t& erel, Double_t& cal) const {
+    pulser = (p2*raw + p1)*raw + p0;
+    erel = pulser*rel;
+    erel += shift;
+    cal = erel*alpha;
+  };
+  // Only the calibrated energy. It may differ from Steps() in the last bits.
+  Double_t Energy(Double_t raw) const { return (c2*raw + c1)*raw + c0; };
+};
+
 ///////////////////////////////////////////////////////////////////////////////////
 class ChannelMap {
   
@@ -70,6 +97,8 @@ class ChannelMap {
 
   //added by M.Anastasiou 10/20/2016
   Double_t a[MaxChNum],b[MaxChNum],c[MaxChNum],q0[MaxChNum];
+  Int_t MBID_Quad[MaxChNum],CID_Quad[MaxChNum],ASICs_Ch_Quad[MaxChNum];
+  Int_t TotalQuadraticASICsChannels;
 
   Double_t ZOffset[NumSX3],XAt0[NumSX3],XAt4[NumSX3],YAt0[NumSX3],YAt4[NumSX3];
 
@@ -80,7 +109,33 @@ class ChannelMap {
   Double_t PC_UD_Slope[WireNum];
   Double_t PC_UD_Offset[WireNum];
 
-  TRandom3 *Randomm;
+  // Lookup tables indexed by (motherboard, chip, chip channel) and by (ADC, channel),
+  // built when the maps are loaded, so that a hit is identified with one indexed load
+  // instead of a scan over the whole map. Channels outside the table ranges are
+  // still found by the scan.
+  struct ASICsChannelInfo {
+    Int_t det, det_ch;   //first entry of the channel map, as IdentifyDetChan
+    Double_t zero, gain; //last entry of the alignment file, as AlignASICsChannels
+    Bool_t mapped, aligned;
+    SiCalibration cal;   //valid if calibrated (mapped to an existing detector channel)
+    Bool_t calibrated;
+  };
+  struct ADCChannelInfo {
+    Int_t det_type, wire, side; //last entry of the PC map, as IdentifyADC and IdentifyWire
+    Bool_t mapped;
+  };
+  ASICsChannelInfo ASICsLookup[MaxMBID][MaxCBID][MaxASICsCh];
+  ADCChannelInfo ADCLookup[MaxADC][MaxADCCh];
+
+  static Bool_t InASICsLookup(Int_t mb_id, Int_t chip_id, Int_t asic_ch) {
+    return mb_id>=0 && mb_id<MaxMBID && chip_id>=0 && chip_id<MaxCBID && asic_ch>=0 && asic_ch<MaxASICsCh;
+  };
+  static Bool_t InADCLookup(Int_t ADCid, Int_t CHid) {
+    return ADCid>=0 && ADCid<MaxADC && CHid>=0 && CHid<MaxADCCh;
+  };
+  void BuildASICsLookup(Bool_t report);
+  void BuildADCLookup(Bool_t report);
+  void BuildSiCalibration();
   
  public:
   
@@ -96,13 +151,13 @@ class ChannelMap {
     NumberOfSX3RelativeSlopes=0;
     NumberOfQ3RelativeSlopes=0;
     NumberOfADCChannels=0;
+    TotalQuadraticASICsChannels=0;
 
-    Randomm = new TRandom3();
+    BuildASICsLookup(kFALSE);
+    BuildADCLookup(kFALSE);
   };
   //////////////// Destructor //////////////////////////////////////////
   ~ChannelMap() {
-    
-    delete Randomm;
   };
   ///////////  Load && Initializes Maps and Calibration Files //////////////////////
 
@@ -110,7 +165,7 @@ class ChannelMap {
   int LoadASICsPulserAlignment(const char* ASICsPulserFilename);
 
   //added by M.Anastasiou 10/20/2016
-  //int LoadASICsPulserAlignment_Quadratic (const char* ASICsPulserFilename);
+  int LoadASICsPulserAlignment_Quadratic (const char* ASICsPulserFilename);
 
   int LoadSiGains(const char* SiGainsFilename);
   int LoadSX3RelativeSlopes(const char* SX3SlopeFilename);
@@ -143,38 +198,41 @@ class ChannelMap {
 
   /////////////////////// Use Coefficients && Calculations //////////////////////////
   
-  void IdentifyADC(Int_t ADCid, Int_t CHid, Int_t& DetType);
-  void IdentifyWire(Int_t ADCid, Int_t CHid, Int_t& WireID, Int_t& Side);
-  Bool_t ConvertToVoltage(Int_t ADCid, Int_t CHid, Int_t PCData, Double_t& Vcal);
-  void Get_PCWire_RelGain(Int_t WireID,Double_t& PCRelGain); 
-  void GetPCWorldCoordinates(Int_t wireid, Double_t zpos, Double_t& xw, Double_t& yw, Double_t& zw, Double_t& rw, Double_t& phiw);
+  void IdentifyADC(Int_t ADCid, Int_t CHid, Int_t& DetType) const;
+  void IdentifyWire(Int_t ADCid, Int_t CHid, Int_t& WireID, Int_t& Side) const;
+  void IdentifyADCChannel(Int_t ADCid, Int_t CHid, Int_t& DetType, Int_t& WireID, Int_t& Side) const;
+  Bool_t ConvertToVoltage(Int_t ADCid, Int_t CHid, Int_t PCData, Double_t& Vcal) const;
+  void Get_PCWire_RelGain(Int_t WireID,Double_t& PCRelGain) const; 
+  void GetPCWorldCoordinates(Int_t wireid, Double_t zpos, Double_t rndm, Double_t& xw, Double_t& yw, Double_t& zw, Double_t& rw, Double_t& phiw) const;
  
   
-  void IdentifyDetChan(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Int_t& det, Int_t& det_ch);  
-  void AlignASICsChannels(Int_t mb_id_al, Int_t chip_id_al, Int_t asic_ch_al, Double_t& zero, Double_t& gain);  
+  void IdentifyDetChan(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Int_t& det, Int_t& det_ch) const;  
+  void AlignASICsChannels(Int_t mb_id_al, Int_t chip_id_al, Int_t asic_ch_al, Double_t& zero, Double_t& gain) const;  
+  void IdentifySiChannel(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Int_t& det, Int_t& det_ch, Double_t& zero, Double_t& gain) const;
+  const SiCalibration* GetSiCalibration(Int_t mb_id, Int_t chip_id, Int_t asic_ch) const;
 
   //added by M.Anastasiou 10/20/2016 
   //void AlignASICsChannels_Quadratic(Int_t mb_id_al, Int_t chip_id_al, Int_t asic_ch_al, Double_t& alpha, Double_t& beta, Double_t& gamma, Double_t& Z_shift);  
 
   
-  void GetSX3MeVPerChannel1(Int_t DN, Int_t DetCh, Double_t& slope);
-  void GetSX3MeVPerChannel2(Int_t DN, Int_t DetCh, Double_t& slope);
-  void GetSX3FinalEnergyOffsetInMeV(Int_t DNum, Int_t ChNum, Double_t& zshift);
-  void GetQ3MeVPerChannel1(Int_t DN, Int_t DetCh, Double_t& slope);
-  void GetQ3MeVPerChannel2(Int_t DN, Int_t DetCh, Double_t& slope);  
-  void GetQ3FinalEnergyOffsetInMeV(Int_t DNum, Int_t ChNum, Double_t& zshift);
-
-  void GetQ3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiY, Double_t& WSiX, Double_t& WSiY, Double_t& WSiR, Double_t& WSiPhi );
-  void GetSX3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiZ, Double_t& WSiX, Double_t& WSiY, Double_t& WSiZ, Double_t& WSiR, Double_t& WSiPhi);
-  void PosCal(Int_t DNum, Int_t StripNum, Int_t ChNum, Double_t FinalZPos, Double_t& FinalZPosCal);
+  void GetSX3MeVPerChannel1(Int_t DN, Int_t DetCh, Double_t& slope) const;
+  void GetSX3MeVPerChannel2(Int_t DN, Int_t DetCh, Double_t& slope) const;
+  void GetSX3FinalEnergyOffsetInMeV(Int_t DNum, Int_t ChNum, Double_t& zshift) const;
+  void GetQ3MeVPerChannel1(Int_t DN, Int_t DetCh, Double_t& slope) const;
+  void GetQ3MeVPerChannel2(Int_t DN, Int_t DetCh, Double_t& slope) const;  
+  void GetQ3FinalEnergyOffsetInMeV(Int_t DNum, Int_t ChNum, Double_t& zshift) const;
+
+  void GetQ3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiY, Double_t& WSiX, Double_t& WSiY, Double_t& WSiR, Double_t& WSiPhi ) const;
+  void GetSX3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiZ, Double_t& WSiX, Double_t& WSiY, Double_t& WSiZ, Double_t& WSiR, Double_t& WSiPhi) const;
+  void PosCal(Int_t DNum, Int_t StripNum, Int_t ChNum, Double_t FinalZPos, Double_t& FinalZPosCal) const;
   
-  void GetZeroShift(Int_t det, Int_t det_ch, Double_t& zero, Double_t& slope);
+  void GetZeroShift(Int_t det, Int_t det_ch, Double_t& zero, Double_t& slope) const;
   Double_t GetRelLinCoeff(Int_t det, Int_t det_ch) { return SX3RelativeSlope[det-4][det_ch]; };  
-  void IdentifyMbChipChan(Int_t det, Int_t det_ch,Int_t &mb_id,Int_t &chip_id,Int_t &asic_ch);
+  void IdentifyMbChipChan(Int_t det, Int_t det_ch,Int_t &mb_id,Int_t &chip_id,Int_t &asic_ch) const;
 
   //------------------------PC Relative Gains---------------------added 05/05/2017------------------//
   int Init_PC_UD_RelCal(const char* PC_UD_RelCal_Filename);
-  void Get_PC_UD_RelCal(Int_t WireID, Double_t& SlopeUD, Double_t& OffsetUD);
+  void Get_PC_UD_RelCal(Int_t WireID, Double_t& SlopeUD, Double_t& OffsetUD) const;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -209,6 +267,7 @@ int ChannelMap::LoadASICsChannelMapFile (const char* ASICsChannelMapFilename) {
   }
   else LoadFail(ASICsChannelMapFilename);
   channelmapfile.close();
+  BuildASICsLookup(kFALSE);
   return 1;
 }
 
@@ -230,29 +289,34 @@ int ChannelMap::LoadASICsPulserAlignment (const char* ASICsPulserFilename) {
     TotalAlignedASICsChannels = j-1;
   }
   else LoadFail(ASICsPulserFilename);
+  BuildASICsLookup(kFALSE);
   return 1;
 }
 
 //------------------------------------------------------------------------------------------------//
-/*int ChannelMap::LoadASICsPulserAlignment_Quadratic (const char* ASICsPulserFilename) {
+// Description: Quadratic pulser alignment, Pulser = a*Raw*Raw + b*Raw + c, for the channels
+// listed in the file (MBID CBID Chan a b c q0, q0 is not used). It replaces the linear
+// alignment of those channels; load it after Init.
+int ChannelMap::LoadASICsPulserAlignment_Quadratic (const char* ASICsPulserFilename) {
   ifstream alignchan;
   string line;
 
   alignchan.open(ASICsPulserFilename);
   if (alignchan.is_open()) {
-    cout << "The channel allignment file " << ASICsPulserFilename << " opened successfully." << endl;
-    //getline (alignchan,line);//Skips the first line in ASICsPulserFilename.
+    cout << "The quadratic channel allignment file " << ASICsPulserFilename << " opened successfully." << endl;
+    getline (alignchan,line);//Skips the first line in ASICsPulserFilename.
     if(doprint) cout<<"line = "<<line<<endl;
-    /*    Int_t j=0;
-	  while (!alignchan.eof()) {
-	  alignchan >>  MBID_Align[j] >> CID_Align[j] >> ASICs_Ch_Align[j] >> a[j] >> b[j] >> c[j] >> q0[j];
-	  j++;
-	  }
-	  TotalAlignedASICsChannels = j-1;
-	  }
-	  else LoadFail(TotalAlignedASICsChannels);
-  	  return 1;
-	  }*/
+    Int_t j=0;
+    while (!alignchan.eof()) {
+      alignchan >>  MBID_Quad[j] >> CID_Quad[j] >> ASICs_Ch_Quad[j] >> a[j] >> b[j] >> c[j] >> q0[j];
+      j++;
+    }
+    TotalQuadraticASICsChannels = j-1;
+  }
+  else LoadFail(ASICsPulserFilename);
+  BuildSiCalibration();
+  return 1;
+}
 
 //------------------------------------------------------------------------------------------------//
 int ChannelMap::LoadSiGains(const char* SiGainsFilename) {
@@ -300,6 +364,7 @@ int ChannelMap::LoadSiGains(const char* SiGainsFilename) {
   }
   else LoadFail(SiGainsFilename);
   SiGainsFile.close();
+  BuildSiCalibration();
   return 1;
 }
 
@@ -330,6 +395,7 @@ int ChannelMap::LoadSX3RelativeSlopes(const char* SX3RelativeSlopeFilename) {
   }
   else LoadFail(SX3RelativeSlopeFilename);
   SX3RelativeSlopeFile.close();
+  BuildSiCalibration();
   return 1;
 }
 
@@ -360,6 +426,7 @@ int ChannelMap::LoadQ3RelativeSlopes(const char* Q3RelativeSlopeFilename) {
   }
   else LoadFail(Q3RelativeSlopeFilename);
   Q3RelativeSlopeFile.close();
+  BuildSiCalibration();
   return 1;
 }
 
@@ -374,6 +441,7 @@ int ChannelMap::Init(const char* ASICsChannelMapFilename,
   if(status == 1) {
     status = LoadASICsPulserAlignment(ASICsPulserFilename);
     //status = LoadASICsPulserAlignment_Quadratic(ASICsPulserFilename);
+    BuildASICsLookup(kTRUE); //checks the channel map against the alignment file
   }
   else LoadFail(ASICsChannelMapFilename);
   
@@ -453,6 +521,7 @@ int ChannelMap::FinalInit(const char* FinalFixFilename, const char* SX3GeoFilena
   //---------------------------------------------------------------
   finalfix.close();
   x3geo.close();
+  BuildSiCalibration();
   return 1;
 }
 
@@ -483,6 +552,7 @@ int ChannelMap::LoadQ3FinalFix(const char* Q3FinalFixFilename) {
     }
   }
   else LoadFail(Q3FinalFixFilename);
+  BuildSiCalibration();
   return 1;  
 }
 
@@ -561,6 +631,7 @@ int ChannelMap::InitPCADC(const char* PCMapFilename) {
   }
   else LoadFail(PCMapFilename);
   pcmap.close();
+  BuildADCLookup(kTRUE);
   return 1;
 }
 
@@ -669,15 +740,28 @@ int ChannelMap::Init_PCWire_RelGain(const char* PCWire_RelGain_Filename) {
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::IdentifyADC(Int_t ADCid, Int_t CHid, Int_t& DetType) {
+void ChannelMap::IdentifyADC(Int_t ADCid, Int_t CHid, Int_t& DetType) const {
   DetType = 0;
+  if (InADCLookup(ADCid,CHid)) {
+    const ADCChannelInfo& info = ADCLookup[ADCid][CHid];
+    if (info.mapped) DetType = info.det_type;
+    return;
+  }
   for (Int_t i=0; i<NumberOfADCChannels; i++) {
     if (ADCid == ADC[i] && CHid == Channel[i])  DetType=DetTypeID[i];
   }  
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::IdentifyWire(Int_t ADCid, Int_t CHid, Int_t& WireID, Int_t& Side) {
+void ChannelMap::IdentifyWire(Int_t ADCid, Int_t CHid, Int_t& WireID, Int_t& Side) const {
+  if (InADCLookup(ADCid,CHid)) {
+    const ADCChannelInfo& info = ADCLookup[ADCid][CHid];
+    if (info.mapped) {
+      WireID = info.wire;
+      Side   = info.side;
+    }
+    return;
+  }
   for (Int_t i=0; i<NumberOfADCChannels; i++) {
     if (ADCid == ADC[i] && CHid == Channel[i]) {
       WireID = Parameter1[i];
@@ -687,7 +771,67 @@ void ChannelMap::IdentifyWire(Int_t ADCid, Int_t CHid, Int_t& WireID, Int_t& Sid
 }
 
 //------------------------------------------------------------------------------------------------//
-Bool_t ChannelMap::ConvertToVoltage(Int_t ADCid, Int_t CHid, Int_t PCData, Double_t& Vcal) {  
+//Description: IdentifyADC and IdentifyWire in one lookup. WireID and Side are only set for
+//             channels in the PC map.
+void ChannelMap::IdentifyADCChannel(Int_t ADCid, Int_t CHid, Int_t& DetType, Int_t& WireID, Int_t& Side) const {
+  if (!InADCLookup(ADCid,CHid)) {
+    IdentifyADC(ADCid,CHid,DetType);
+    IdentifyWire(ADCid,CHid,WireID,Side);
+    return;
+  }
+  const ADCChannelInfo& info = ADCLookup[ADCid][CHid];
+  DetType = 0;
+  if (info.mapped) {
+    DetType = info.det_type;
+    WireID  = info.wire;
+    Side    = info.side;
+  }
+}
+
+//------------------------------------------------------------------------------------------------//
+//Description: Fills ADCLookup from the PC map. With report, prints the entries that are
+//             outside the table, listed twice (the last one is used) or that point to
+//             a wire or side that does not exist.
+void ChannelMap::BuildADCLookup(Bool_t report) {
+  for (Int_t k=0; k<MaxADC; k++) {
+    for (Int_t c=0; c<MaxADCCh; c++) {
+      ADCLookup[k][c].det_type = 0;
+      ADCLookup[k][c].wire = -1;
+      ADCLookup[k][c].side = 0;
+      ADCLookup[k][c].mapped = kFALSE;
+    }
+  }
+  Int_t outside=0, duplicates=0, bad_wire=0;
+  for (Int_t i=0; i<NumberOfADCChannels; i++) {
+    if (!InADCLookup(ADC[i],Channel[i])) {
+      if(report) printf("  * PC map: ADC %d channel %d is outside the lookup table (%d ADCs x %d channels)\n",
+			ADC[i],Channel[i],MaxADC,MaxADCCh);
+      outside++;
+      continue;
+    }
+    ADCChannelInfo& info = ADCLookup[ADC[i]][Channel[i]];
+    if (info.mapped) {
+      if(report) printf("  * PC map: ADC %d channel %d is listed twice, the last entry (wire %d side %d) is used\n",
+			ADC[i],Channel[i],Parameter1[i],Parameter2[i]);
+      duplicates++;
+    }
+    info.det_type = DetTypeID[i];
+    info.wire = Parameter1[i];
+    info.side = Parameter2[i];
+    info.mapped = kTRUE;
+    if (Parameter1[i]<0 || Parameter1[i]>=WireNum || (Parameter2[i]!=1 && Parameter2[i]!=2)) {
+      if(report) printf("  * PC map: ADC %d channel %d points to wire %d side %d\n",
+			ADC[i],Channel[i],Parameter1[i],Parameter2[i]);
+      bad_wire++;
+    }
+  }
+  if (report && (outside || duplicates || bad_wire))
+    cout << "  * PC map: " << outside << " channels outside the lookup table, " << duplicates
+	 << " listed twice, " << bad_wire << " with a wrong wire or side" << endl;
+}
+
+//------------------------------------------------------------------------------------------------//
+Bool_t ChannelMap::ConvertToVoltage(Int_t ADCid, Int_t CHid, Int_t PCData, Double_t& Vcal) const {  
   Vcal = sqrt(-1);
   if (PCData > 0) {
     Vcal = PCData*PCPulser_Slope[ADCid][CHid] + PCPulser_YOffset[ADCid][CHid];  
@@ -698,17 +842,18 @@ Bool_t ChannelMap::ConvertToVoltage(Int_t ADCid, Int_t CHid, Int_t PCData, Doubl
 }
 
 //-------------------------------------------------------------------------------------------------//
-void ChannelMap::Get_PCWire_RelGain(Int_t WireID,Double_t& PCRelGain) {
+void ChannelMap::Get_PCWire_RelGain(Int_t WireID,Double_t& PCRelGain) const {
 
   PCRelGain = PCWire_RelGain[WireID];
 
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::GetPCWorldCoordinates(Int_t wireid, Double_t zpos, Double_t& xw, Double_t& yw, Double_t& zw, Double_t& rw, Double_t& phiw) {
-  Randomm->SetSeed();
+//Description: rndm, uniform in (0,1), spreads the angle over the width of the wire
+//             (CounterRNG::kPCWire in Main).
+void ChannelMap::GetPCWorldCoordinates(Int_t wireid, Double_t zpos, Double_t rndm, Double_t& xw, Double_t& yw, Double_t& zw, Double_t& rw, Double_t& phiw) const {
   Double_t Radius = 3.8463;
-  Double_t Angle = (24-(Double_t)wireid+Randomm->Rndm()-0.5)*TMath::TwoPi()/24.0 + TMath::Pi()/2;
+  Double_t Angle = (24-(Double_t)wireid+rndm-0.5)*TMath::TwoPi()/24.0 + TMath::Pi()/2;
   //changed angle on Feb27 to correspond to reality
   xw = Radius*TMath::Cos(Angle);
   yw = Radius*TMath::Sin(Angle);
@@ -736,7 +881,15 @@ void ChannelMap::GetPCWorldCoordinates(Int_t wireid, Double_t zpos, Double_t& xw
 //             detector number and detector channel number for a given mother board, chip and
 //             chip channel.
 
-void ChannelMap::IdentifyDetChan(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Int_t& det, Int_t& det_ch) {
+void ChannelMap::IdentifyDetChan(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Int_t& det, Int_t& det_ch) const {
+  if (InASICsLookup(mb_id,chip_id,asic_ch)) {
+    const ASICsChannelInfo& info = ASICsLookup[mb_id][chip_id][asic_ch];
+    if (info.mapped) {
+      det = info.det;
+      det_ch = info.det_ch;
+    }
+    return;
+  }
   for (Int_t i = 0; i<TotalNumberOfChannels; i++) {
     if (MBID[i] == mb_id && CID[i] == chip_id && ASICs_Ch[i] == asic_ch) {
       det = Detector[i];
@@ -747,7 +900,15 @@ void ChannelMap::IdentifyDetChan(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Int_
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::AlignASICsChannels(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Double_t& zero, Double_t& gain) {
+void ChannelMap::AlignASICsChannels(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Double_t& zero, Double_t& gain) const {
+  if (InASICsLookup(mb_id,chip_id,asic_ch)) {
+    const ASICsChannelInfo& info = ASICsLookup[mb_id][chip_id][asic_ch];
+    if (info.aligned) {
+      zero = info.zero;
+      gain = info.gain;
+    }
+    return;
+  }
   for (Int_t i = 0; i<TotalAlignedASICsChannels; i++) {
     if (MBID_Align[i] == mb_id && CID_Align[i] == chip_id && ASICs_Ch_Align[i] == asic_ch) {
       zero = zerosh[i];
@@ -756,6 +917,183 @@ void ChannelMap::AlignASICsChannels(Int_t mb_id, Int_t chip_id, Int_t asic_ch, D
   }
 }
 
+//------------------------------------------------------------------------------------------------//
+//Description: IdentifyDetChan and AlignASICsChannels in one lookup. det and det_ch are only set
+//             for channels in the channel map, zero and gain for channels in the alignment file.
+void ChannelMap::IdentifySiChannel(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Int_t& det, Int_t& det_ch,
+				   Double_t& zero, Double_t& gain) const {
+  if (!InASICsLookup(mb_id,chip_id,asic_ch)) {
+    IdentifyDetChan(mb_id,chip_id,asic_ch,det,det_ch);
+    AlignASICsChannels(mb_id,chip_id,asic_ch,zero,gain);
+    return;
+  }
+  const ASICsChannelInfo& info = ASICsLookup[mb_id][chip_id][asic_ch];
+  if (info.mapped) {
+    det = info.det;
+    det_ch = info.det_ch;
+  }
+  if (info.aligned) {
+    zero = info.zero;
+    gain = info.gain;
+  }
+}
+
+//------------------------------------------------------------------------------------------------//
+//Description: Calibration of a Si hit, or NULL for channels that are outside the lookup table,
+//             not in the channel map or mapped to a detector channel that does not exist.
+const SiCalibration* ChannelMap::GetSiCalibration(Int_t mb_id, Int_t chip_id, Int_t asic_ch) const {
+  if (!InASICsLookup(mb_id,chip_id,asic_ch)) return NULL;
+  const ASICsChannelInfo& info = ASICsLookup[mb_id][chip_id][asic_ch];
+  return info.calibrated ? &info.cal : NULL;
+}
+
+//------------------------------------------------------------------------------------------------//
+//Description: Collects the coefficients of all the calibration steps of each mapped channel
+//             (pulser alignment, relative gain, final zero shift and alpha gain of its detector
+//             channel) and folds them into Cal = c2*Raw*Raw + c1*Raw + c0. Called again each
+//             time a calibration file is loaded.
+void ChannelMap::BuildSiCalibration() {
+  for (Int_t m=0; m<MaxMBID; m++) {
+    for (Int_t c=0; c<MaxCBID; c++) {
+      for (Int_t ch=0; ch<MaxASICsCh; ch++) {
+	ASICsChannelInfo& info = ASICsLookup[m][c][ch];
+	info.calibrated = kFALSE;
+	if (!info.mapped || info.det<0 || info.det>=NumDet || info.det_ch<0
+	    || info.det_ch>=(info.det<NumQ3 ? MaxQ3Ch : MaxSX3Ch)) continue;
+	SiCalibration& cal = info.cal;
+	//channels without alignment keep zero=0, gain=1
+	cal.p0 = info.aligned ? info.zero/info.gain : 0;
+	cal.p1 = 1;
+	cal.p2 = 0;
+	if (info.det>=NumQ3) {
+	  GetSX3MeVPerChannel1(info.det,info.det_ch,cal.rel);
+	  GetSX3MeVPerChannel2(info.det,info.det_ch,cal.alpha);
+	  GetSX3FinalEnergyOffsetInMeV(info.det,info.det_ch,cal.shift);
+	}
+	else {
+	  GetQ3MeVPerChannel1(info.det,info.det_ch,cal.rel);
+	  GetQ3MeVPerChannel2(info.det,info.det_ch,cal.alpha);
+	  GetQ3FinalEnergyOffsetInMeV(info.det,info.det_ch,cal.shift);
+	}
+	info.calibrated = kTRUE;
+      }
+    }
+  }
+  for (Int_t j=0; j<TotalQuadraticASICsChannels; j++) { //the last entry of a channel is used
+    if (!InASICsLookup(MBID_Quad[j],CID_Quad[j],ASICs_Ch_Quad[j])) continue;
+    SiCalibration& cal = ASICsLookup[MBID_Quad[j]][CID_Quad[j]][ASICs_Ch_Quad[j]].cal;
+    cal.p2 = a[j];
+    cal.p1 = b[j];
+    cal.p0 = c[j];
+  }
+  for (Int_t m=0; m<MaxMBID; m++) {
+    for (Int_t c=0; c<MaxCBID; c++) {
+      for (Int_t ch=0; ch<MaxASICsCh; ch++) {
+	SiCalibration& cal = ASICsLookup[m][c][ch].cal;
+	if (!ASICsLookup[m][c][ch].calibrated) continue;
+	cal.c2 = cal.p2*cal.rel*cal.alpha;
+	cal.c1 = cal.p1*cal.rel*cal.alpha;
+	cal.c0 = (cal.p0*cal.rel + cal.shift)*cal.alpha;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------------------------//
+//Description: Fills ASICsLookup from the channel map and the alignment file. With report,
+//             prints the entries that are outside the table, listed twice, that point to
+//             a detector channel that does not exist or that another channel already uses,
+//             and the number of channels found only in one of the two files.
+void ChannelMap::BuildASICsLookup(Bool_t report) {
+  for (Int_t m=0; m<MaxMBID; m++) {
+    for (Int_t c=0; c<MaxCBID; c++) {
+      for (Int_t ch=0; ch<MaxASICsCh; ch++) {
+	ASICsChannelInfo& info = ASICsLookup[m][c][ch];
+	info.det = -1;
+	info.det_ch = -1;
+	info.zero = 0;
+	info.gain = 1;
+	info.mapped = kFALSE;
+	info.aligned = kFALSE;
+	info.calibrated = kFALSE;
+      }
+    }
+  }
+  Bool_t used[NumDet][MaxQ3Ch];
+  for (Int_t d=0; d<NumDet; d++)
+    for (Int_t c=0; c<MaxQ3Ch; c++) used[d][c] = kFALSE;
+
+  Int_t outside=0, duplicates=0, bad_det=0, shared=0;
+  for (Int_t i=0; i<TotalNumberOfChannels; i++) {
+    if (!InASICsLookup(MBID[i],CID[i],ASICs_Ch[i])) {
+      if(report) printf("  * Channel map: MB %d chip %d channel %d is outside the lookup table\n",MBID[i],CID[i],ASICs_Ch[i]);
+      outside++;
+      continue;
+    }
+    ASICsChannelInfo& info = ASICsLookup[MBID[i]][CID[i]][ASICs_Ch[i]];
+    if (info.mapped) {
+      if(report) printf("  * Channel map: MB %d chip %d channel %d is listed twice, the first entry (det %d ch %d) is used\n",
+			MBID[i],CID[i],ASICs_Ch[i],info.det,info.det_ch);
+      duplicates++;
+      continue;
+    }
+    info.det = Detector[i];
+    info.det_ch = Det_Ch[i];
+    info.mapped = kTRUE;
+    if (Detector[i]<0 || Detector[i]>=NumDet || Det_Ch[i]<0 || Det_Ch[i]>=(Detector[i]<NumQ3 ? MaxQ3Ch : MaxSX3Ch)) {
+      if(report) printf("  * Channel map: MB %d chip %d channel %d points to det %d ch %d\n",
+			MBID[i],CID[i],ASICs_Ch[i],Detector[i],Det_Ch[i]);
+      bad_det++;
+    }
+    else if (used[Detector[i]][Det_Ch[i]]) {
+      if(report) printf("  * Channel map: det %d ch %d is read by more than one ASICs channel (MB %d chip %d channel %d)\n",
+			Detector[i],Det_Ch[i],MBID[i],CID[i],ASICs_Ch[i]);
+      shared++;
+    }
+    else used[Detector[i]][Det_Ch[i]] = kTRUE;
+  }
+
+  Int_t align_outside=0, align_duplicates=0;
+  for (Int_t j=0; j<TotalAlignedASICsChannels; j++) {
+    if (!InASICsLookup(MBID_Align[j],CID_Align[j],ASICs_Ch_Align[j])) {
+      align_outside++;
+      continue;
+    }
+    ASICsChannelInfo& info = ASICsLookup[MBID_Align[j]][CID_Align[j]][ASICs_Ch_Align[j]];
+    if (info.aligned) align_duplicates++; //the last entry is used
+    info.zero = zerosh[j];
+    info.gain = vperch[j];
+    info.aligned = kTRUE;
+  }
+
+  Int_t not_aligned=0, not_mapped=0, zero_gain=0;
+  for (Int_t m=0; m<MaxMBID; m++) {
+    for (Int_t c=0; c<MaxCBID; c++) {
+      for (Int_t ch=0; ch<MaxASICsCh; ch++) {
+	const ASICsChannelInfo& info = ASICsLookup[m][c][ch];
+	if (info.mapped && !info.aligned) not_aligned++;
+	if (info.aligned && !info.mapped) not_mapped++;
+	if (info.aligned && info.gain==0) {
+	  if(report) printf("  * Alignment: MB %d chip %d channel %d has zero volts/channel\n",m,c,ch);
+	  zero_gain++;
+	}
+      }
+    }
+  }
+  BuildSiCalibration();
+  if (!report) return;
+  cout << " Channel map: " << TotalNumberOfChannels << " ASICs channels, " << TotalAlignedASICsChannels
+       << " aligned";
+  if (outside || duplicates || bad_det || shared)
+    cout << "; " << outside << " outside the lookup table, " << duplicates << " listed twice, "
+	 << bad_det << " without a detector channel, " << shared << " sharing a detector channel";
+  if (align_outside || align_duplicates || not_aligned || not_mapped || zero_gain)
+    cout << "; alignment: " << align_outside << " outside the lookup table, " << align_duplicates
+	 << " listed twice (the last is used), " << not_aligned << " mapped channels not aligned, "
+	 << not_mapped << " aligned channels not mapped, " << zero_gain << " with zero volts/channel";
+  cout << endl;
+}
+
 //------------------------------------------------------------------------------------------------//
 /*void ChannelMap::AlignASICsChannels_Quadratic(Int_t mb_id, Int_t chip_id, Int_t asic_ch, Double_t& alpha, Double_t& beta, Double_t& gamma, Double_t& X_shift) {
   for (Int_t i = 0; i<TotalAlignedASICsChannels; i++)
@@ -771,37 +1109,37 @@ void ChannelMap::AlignASICsChannels(Int_t mb_id, Int_t chip_id, Int_t asic_ch, D
   }*/
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::GetSX3MeVPerChannel1(Int_t DN, Int_t DetCh, Double_t& slope) {
+void ChannelMap::GetSX3MeVPerChannel1(Int_t DN, Int_t DetCh, Double_t& slope) const {
   slope = SX3RelativeSlope[DN-4][DetCh];
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::GetSX3MeVPerChannel2(Int_t DN, Int_t DetCh, Double_t& slope) {
+void ChannelMap::GetSX3MeVPerChannel2(Int_t DN, Int_t DetCh, Double_t& slope) const {
   slope = SiGains[DN];
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::GetSX3FinalEnergyOffsetInMeV(Int_t DNum, Int_t ChNum, Double_t& zshift) {
+void ChannelMap::GetSX3FinalEnergyOffsetInMeV(Int_t DNum, Int_t ChNum, Double_t& zshift) const {
   zshift = SX3FinalFix[DNum-4][ChNum];
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::GetQ3MeVPerChannel1(Int_t DN, Int_t DetCh, Double_t& slope) {
+void ChannelMap::GetQ3MeVPerChannel1(Int_t DN, Int_t DetCh, Double_t& slope) const {
   slope = Q3RelativeSlope[DN][DetCh];
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::GetQ3MeVPerChannel2(Int_t DN, Int_t DetCh, Double_t& slope) {
+void ChannelMap::GetQ3MeVPerChannel2(Int_t DN, Int_t DetCh, Double_t& slope) const {
   slope = SiGains[DN];
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::GetQ3FinalEnergyOffsetInMeV(Int_t DNum, Int_t ChNum, Double_t& zshift) {
+void ChannelMap::GetQ3FinalEnergyOffsetInMeV(Int_t DNum, Int_t ChNum, Double_t& zshift) const {
   zshift = Q3FinalFix[DNum][ChNum];
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::GetQ3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiY, Double_t& WSiX, Double_t& WSiY, Double_t& WSiR, Double_t& WSiPhi) {
+void ChannelMap::GetQ3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiY, Double_t& WSiX, Double_t& WSiY, Double_t& WSiR, Double_t& WSiPhi) const {
   //Double_t Theta = TMath::Pi()*(DID+1)/2; //Rotate detectors CCW by an angle Theta
  
   Double_t Theta = 0;
@@ -839,7 +1177,7 @@ void ChannelMap::GetQ3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiY, Do
 
 //------------------------------------------------------------------------------------------------//
 void ChannelMap::GetSX3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiZ, Double_t& WSiX,
-					Double_t& WSiY, Double_t& WSiZ, Double_t& WSiR, Double_t& WSiPhi) {
+					Double_t& WSiY, Double_t& WSiZ, Double_t& WSiR, Double_t& WSiPhi) const {
   if (ZOffset[DID-4]>-0.1 && YAt0[DID-4]<50. && YAt0[DID-4]<50.) {
    
     //WSiZ = ZOffset[DID-4] + 7.5 - SiZ;
@@ -869,7 +1207,7 @@ void ChannelMap::GetSX3WorldCoordinates(Int_t DID, Double_t SiX, Double_t SiZ, D
 }
 
 //------------------------------------------------------------------------------------------------//
-void ChannelMap::PosCal(Int_t DNum, Int_t StripNum, Int_t BChNum, Double_t FinalZPos, Double_t& FinalZPosCal) {
+void ChannelMap::PosCal(Int_t DNum, Int_t StripNum, Int_t BChNum, Double_t FinalZPos, Double_t& FinalZPosCal) const {
   Double_t EdgeDCal=sqrt(-1);
   Double_t EdgeUCal=sqrt(-1);
   
@@ -921,7 +1259,7 @@ void ChannelMap::PosCal(Int_t DNum, Int_t StripNum, Int_t BChNum, Double_t Final
 //             are a and b in the equation volts = a*signal + b.  So the get the zero-shift
 //             we do z = -b/a (usually b<0 and a>0, thus z>0).  After this, one subtracts 'z'
 //             from the measured signal to get the aligned signal.
-void ChannelMap::GetZeroShift (Int_t det, Int_t det_ch, Double_t& zero, Double_t& slope) {
+void ChannelMap::GetZeroShift (Int_t det, Int_t det_ch, Double_t& zero, Double_t& slope) const {
   Int_t detector, channel;
   Double_t b,a, ZS=0;
   for (Int_t i = 0; i<TotalAlignedASICsChannels; i++) {
@@ -939,7 +1277,7 @@ void ChannelMap::GetZeroShift (Int_t det, Int_t det_ch, Double_t& zero, Double_t
 //Description: From the channel map provided in the Init method this function get returns the
 //             motherboard ID, chip number, and chip channel for a detector number and detector
 //             channel number.
-void ChannelMap::IdentifyMbChipChan(Int_t det, Int_t det_ch,Int_t &mb_id,Int_t &chip_id,Int_t &asic_ch) {
+void ChannelMap::IdentifyMbChipChan(Int_t det, Int_t det_ch,Int_t &mb_id,Int_t &chip_id,Int_t &asic_ch) const {
   for (Int_t i = 0; i<TotalNumberOfChannels; i++) {
     if(Detector[i] == det && Det_Ch[i] == det_ch) {
       mb_id = MBID[i];
@@ -982,7 +1320,7 @@ int ChannelMap::Init_PC_UD_RelCal(const char* PC_UD_RelCal_Filename) {
 }
 
 //------------------------PC Relative Gains---------------------added 05/05/2017------------------//
-void ChannelMap::Get_PC_UD_RelCal(Int_t WireID,Double_t& SlopeUD,Double_t& OffsetUD) {
+void ChannelMap::Get_PC_UD_RelCal(Int_t WireID,Double_t& SlopeUD,Double_t& OffsetUD) const {
   SlopeUD = PC_UD_Slope[WireID];
   OffsetUD = PC_UD_Offset[WireID];
 }
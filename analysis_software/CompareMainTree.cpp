@@ -0,0 +1,131 @@
+/////////////////////////////////////////////////////////////////////////////////////
+// Program: CompareMainTree.cpp
+// Compares the MainTree of two files made by Main entry by entry, e.g. the outputs
+// of Main and Main_mt for the same input, which must be the same.
+// See readme.md for general instructions.
+//
+// usage: ./CompareMainTree first.root second.root
+//
+// The single-number branches (RFTime, MCPTime, TOFTime, TOFcTime, TOFwTime, IC.dE,
+// IC.E, ...) are compared through their leaves, whatever their type, and the Si
+// and PC hits through MainTreeReader, so either layout may be given. Prints the
+// first entries that differ and how many of the entries compared have no RF or no
+// MCP time: the TOF of those must not depend on the event before them, which is
+// what changes with the number of threads.
+/////////////////////////////////////////////////////////////////////////////////////
+//C and C++ libraries
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+//ROOT libraries
+#include <TROOT.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TBranchElement.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
+
+#include "../include/tree_structure.h"
+#include "../include/FlatMainTree.h"
+
+#define MaxPrinted 10 //entries that differ printed
+
+using namespace std;
+
+Bool_t Same(Double_t a, Double_t b) {
+  return (a == b) || (std::isnan(a) && std::isnan(b));
+}
+
+//the leaves of the single-number branches of tree; the hits are compared through MainTreeReader
+vector<TLeaf*> NumberLeaves(TTree* tree) {
+  vector<TLeaf*> leaves;
+  TObjArray* branches = tree->GetListOfBranches();
+  for (Int_t i=0; i<branches->GetEntries(); i++) {
+    TBranch* b = (TBranch*)branches->At(i);
+    if (b->InheritsFrom(TBranchElement::Class()) || b->GetListOfLeaves()->GetEntries() != 1) continue;
+    TLeaf* leaf = (TLeaf*)b->GetListOfLeaves()->At(0);
+    if (!leaf->GetLeafCount() && leaf->GetLenStatic() == 1) leaves.push_back(leaf);
+  }
+  return leaves;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    cout << " Usage: ./CompareMainTree first.root second.root\n";
+    exit(EXIT_FAILURE);
+  }
+
+  TFile file1(argv[1]), file2(argv[2]);
+  TTree* tree1 = file1.IsOpen() ? (TTree*)file1.Get("MainTree") : 0;
+  TTree* tree2 = file2.IsOpen() ? (TTree*)file2.Get("MainTree") : 0;
+  if (!tree1 || !tree2) {
+    cout << " No MainTree in " << (tree1 ? argv[2] : argv[1]) << ".\n";
+    exit(EXIT_FAILURE);
+  }
+  Long64_t nentries = tree1->GetEntries();
+  if (tree2->GetEntries() != nentries) {
+    cout << " " << argv[1] << " has " << nentries << " entries, " << argv[2] << " " << tree2->GetEntries() << ".\n";
+    exit(EXIT_FAILURE);
+  }
+
+  SiHit Si1, Si2;
+  PCHit PC1, PC2;
+  MainTreeReader reader1(tree1,Si1,PC1), reader2(tree2,Si2,PC2);
+
+  //the same single-number branches in both trees
+  vector<TLeaf*> found = NumberLeaves(tree1), leaves1, leaves2;
+  TLeaf *rf = 0, *mcp = 0;
+  for (size_t l=0; l<found.size(); l++) {
+    string name = found[l]->GetBranch()->GetName();
+    TBranch* b = tree2->GetBranch(name.c_str());
+    TLeaf* leaf = b ? (TLeaf*)b->GetListOfLeaves()->At(0) : 0; //e.g. IC_dE of IC.dE
+    if (!leaf) {
+      cout << " Branch " << name << " is not in " << argv[2] << ", not compared.\n";
+      continue;
+    }
+    leaves1.push_back(found[l]);
+    leaves2.push_back(leaf);
+    if (name == "RFTime") rf = found[l];
+    if (name == "MCPTime") mcp = found[l];
+  }
+
+  Long64_t differ = 0, no_tof = 0;
+  for (Long64_t i=0; i<nentries; i++) {
+    reader1.GetEntry(i);
+    reader2.GetEntry(i);
+    string what;
+    for (size_t l=0; l<leaves1.size(); l++)
+      if (!Same(leaves1[l]->GetValue(),leaves2[l]->GetValue())) what += string(" ") + leaves1[l]->GetBranch()->GetName();
+    if ((rf && rf->GetValue() <= 0) || (mcp && mcp->GetValue() <= 0)) no_tof++;
+
+    Bool_t same = Si1.ReadDet->size() == Si2.ReadDet->size();
+    for (size_t d=0; same && d<Si1.ReadDet->size(); d++)
+      same = Si1.ReadDet->at(d).DetID == Si2.ReadDet->at(d).DetID && Si1.ReadDet->at(d).HitType == Si2.ReadDet->at(d).HitType &&
+	Si1.ReadDet->at(d).FrontChNum == Si2.ReadDet->at(d).FrontChNum && Si1.ReadDet->at(d).BackChNum == Si2.ReadDet->at(d).BackChNum &&
+	Si1.ReadDet->at(d).EFront_Cal == Si2.ReadDet->at(d).EFront_Cal && Si1.ReadDet->at(d).EBack_Cal == Si2.ReadDet->at(d).EBack_Cal;
+    if (!same) what += " Si.Detector";
+    same = Si1.ReadHit->size() == Si2.ReadHit->size();
+    for (size_t h=0; same && h<Si1.ReadHit->size(); h++)
+      same = Si1.ReadHit->at(h).DetID == Si2.ReadHit->at(h).DetID && Si1.ReadHit->at(h).HitType == Si2.ReadHit->at(h).HitType &&
+	Same(Si1.ReadHit->at(h).Energy,Si2.ReadHit->at(h).Energy) && Same(Si1.ReadHit->at(h).Time,Si2.ReadHit->at(h).Time) &&
+	Same(Si1.ReadHit->at(h).ZW,Si2.ReadHit->at(h).ZW) && Same(Si1.ReadHit->at(h).PhiW,Si2.ReadHit->at(h).PhiW);
+    if (!same) what += " Si.Hit";
+    same = PC1.ReadHit->size() == PC2.ReadHit->size();
+    for (size_t h=0; same && h<PC1.ReadHit->size(); h++)
+      same = PC1.ReadHit->at(h).WireID == PC2.ReadHit->at(h).WireID && Same(PC1.ReadHit->at(h).Energy,PC2.ReadHit->at(h).Energy) &&
+	Same(PC1.ReadHit->at(h).Down,PC2.ReadHit->at(h).Down) && Same(PC1.ReadHit->at(h).Up,PC2.ReadHit->at(h).Up) &&
+	Same(PC1.ReadHit->at(h).ZW,PC2.ReadHit->at(h).ZW) && Same(PC1.ReadHit->at(h).PhiW,PC2.ReadHit->at(h).PhiW);
+    if (!same) what += " PC.Hit";
+
+    if (!what.empty()) {
+      if (differ < MaxPrinted) cout << " Entry " << i << " differs:" << what << endl;
+      differ++;
+    }
+  }
+  cout << " " << nentries << " entries compared, " << no_tof << " without RF or MCP, " << differ << " differ" << endl;
+  return differ == 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,196 @@
+/////////////////////////////////////////////////////////////////////////////////////
+// Program: FlattenMainTree.cpp
+// Writes the MainTree of a file made by Main with the flat layout of the Si and
+// PC hits (../include/FlatMainTree.h), as Main does with FlatOutput.
+// See readme.md for general instructions.
+//
+// usage: ./FlattenMainTree input.root output.root
+//
+// Si.Detector, Si.Hit and PC.Hit are written as flat arrays; the other branches
+// (Si.NSiHits, PC.NPCHits, RFTime, ...) are copied as they are. Only MainTree is
+// written to output.root. The program then reads both trees through
+// MainTreeReader, checks that every entry has the same hits and copied branches
+// (RFTime, MCPTime, the TOF, the IC), and prints the
+// size of the hit branches and the read time of both layouts.
+/////////////////////////////////////////////////////////////////////////////////////
+//C and C++ libraries
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+//ROOT libraries
+#include <TROOT.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
+#include <TStopwatch.h>
+
+#include "../include/tree_structure.h"
+#include "../include/FlatMainTree.h"
+#include "../include/TreeOutputConfig.h"
+
+// Compression, basket sizes and auto-flush of the output tree, as in Main (see ../include/TreeOutputConfig.h)
+#define OutputConfig "../include/tree_output.dat"
+
+using namespace std;
+
+//the branches of the hits, written by FlatMainTree
+Bool_t IsHitBranch(const string& name) {
+  return name == "Si.NSiHits" || name == "PC.NPCHits" || name.compare(0,11,"Si.Detector") == 0 ||
+    name.compare(0,6,"Si.Hit") == 0 || name.compare(0,6,"PC.Hit") == 0 ||
+    name.compare(0,6,"Si.Det") == 0 || name.compare(0,8,"Si.Strip") == 0 ||
+    name == "Si.NHit" || name == "Si.NDet" || name == "Si.NStrip" || name == "PC.NHit";
+}
+
+//compressed size of the hit branches of tree
+Long64_t HitBytes(TTree* tree) {
+  Long64_t bytes = 0;
+  TObjArray* branches = tree->GetListOfBranches();
+  for (Int_t i=0; i<branches->GetEntries(); i++) {
+    TBranch* b = (TBranch*)branches->At(i);
+    if (IsHitBranch(b->GetName())) bytes += b->GetZipBytes("*");
+  }
+  return bytes;
+}
+
+//reads all the entries of filename through MainTreeReader; the time in s
+Double_t ReadTime(const char* filename) {
+  TFile file(filename);
+  TTree* tree = (TTree*)file.Get("MainTree");
+  SiHit Si;
+  PCHit PC;
+  MainTreeReader reader(tree,Si,PC);
+  TStopwatch time;
+  for (Long64_t i=0; i<tree->GetEntries(); i++) reader.GetEntry(i);
+  return time.RealTime();
+}
+
+Bool_t Same(Double_t a, Double_t b) {
+  Float_t f = a;
+  return (f == b) || (std::isnan(f) && std::isnan(b));
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    cout << " Usage: ./FlattenMainTree input.root output.root\n";
+    exit(EXIT_FAILURE);
+  }
+
+  TFile* inputFile = new TFile(argv[1]);
+  if (!inputFile->IsOpen()) {
+    cout << "Root file: " << argv[1] << " could not be opened.\n";
+    exit(EXIT_FAILURE);
+  }
+  TTree* input_tree = (TTree*)inputFile->Get("MainTree");
+  if (!input_tree) {
+    cout << "Root file: " << argv[1] << " has no MainTree.\n";
+    exit(EXIT_FAILURE);
+  }
+  SiHit Si;
+  PCHit PC;
+  MainTreeReader reader(input_tree,Si,PC);
+  if (reader.IsFlat()) {
+    cout << " MainTree of " << argv[1] << " is already flat.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  //the energy steps are written if the input has them
+  Bool_t esteps = kFALSE;
+  for (Long64_t i=0; i<input_tree->GetEntries() && i<1000 && !esteps; i++) {
+    reader.GetEntry(i);
+    for (size_t d=0; d<Si.ReadDet->size(); d++) {
+      const SiHit::SortByDetector& det = Si.ReadDet->at(d);
+      if (!det.EUp_Raw.empty() || !det.EDown_Raw.empty() || !det.EFront_Raw.empty() || !det.EBack_Raw.empty()) esteps = kTRUE;
+    }
+  }
+
+  TFile* outputFile = new TFile(argv[2],"RECREATE");
+  TTree* MainTree = new TTree("MainTree","MainTree");
+  MainTree->Branch("Si.NSiHits",&Si.NSiHits,"NSiHits/I");
+  MainTree->Branch("PC.NPCHits",&PC.NPCHits,"NPCHits/I");
+  FlatMainTree Flat(esteps);
+  Flat.Branch(MainTree);
+
+  //the other branches, single numbers (RFTime/I, TOFTime/F, ...), are copied through a buffer each,
+  //given as void* so that they are read and written with the type of their leaf
+  TObjArray* branches = input_tree->GetListOfBranches();
+  vector<Long64_t> buffers(branches->GetEntries()); //8 bytes, room for a number of any type
+  vector<string> copied;
+  for (Int_t i=0; i<branches->GetEntries(); i++) {
+    TBranch* b = (TBranch*)branches->At(i);
+    if (IsHitBranch(b->GetName())) continue;
+    TLeaf* leaf = (TLeaf*)b->GetListOfLeaves()->At(0);
+    if (b->GetListOfLeaves()->GetEntries() != 1 || !leaf || leaf->GetLeafCount() || leaf->GetLenStatic() != 1 ||
+	leaf->GetLenType() > (Int_t)sizeof(Long64_t)) {
+      cout << " Branch " << b->GetName() << " is not a single number, not copied.\n";
+      continue;
+    }
+    input_tree->SetBranchAddress(b->GetName(),(void*)&buffers[i]);
+    MainTree->Branch(b->GetName(),(void*)&buffers[i],b->GetTitle()); //the leaflist, e.g. RFTime/I
+    copied.push_back(b->GetName());
+  }
+
+  DefaultTreeOutputConfig().Load(OutputConfig);
+  DefaultTreeOutputConfig().Apply(MainTree);
+
+  Long64_t nentries = input_tree->GetEntries();
+  cout << " Flattening " << nentries << " entries of " << argv[1] << (esteps ? " (with the energy steps)" : "") << endl;
+  for (Long64_t i=0; i<nentries; i++) {
+    reader.GetEntry(i);
+    Flat.Set(*Si.ReadDet,*Si.ReadHit,*PC.ReadHit);
+    MainTree->Fill();
+  }
+  outputFile->cd();
+  MainTree->Write();
+  Long64_t flat_bytes = HitBytes(MainTree);
+  Long64_t nested_bytes = HitBytes(input_tree);
+  outputFile->Close();
+  inputFile->Close();
+
+  //check: the same hits in every entry, up to the Float_t precision
+  TFile nestedFile(argv[1]), flatFile(argv[2]);
+  TTree* nested_tree = (TTree*)nestedFile.Get("MainTree");
+  TTree* flat_tree = (TTree*)flatFile.Get("MainTree");
+  SiHit Si2;
+  PCHit PC2;
+  MainTreeReader nested(nested_tree,Si,PC), flat(flat_tree,Si2,PC2);
+  vector<TLeaf*> nested_leaves, flat_leaves; //the copied single numbers
+  for (size_t c=0; c<copied.size(); c++) { //the leaf of branch IC.dE is IC_dE
+    nested_leaves.push_back((TLeaf*)nested_tree->GetBranch(copied[c].c_str())->GetListOfLeaves()->At(0));
+    flat_leaves.push_back((TLeaf*)flat_tree->GetBranch(copied[c].c_str())->GetListOfLeaves()->At(0));
+  }
+  Long64_t differ = 0;
+  for (Long64_t i=0; i<nentries; i++) {
+    nested.GetEntry(i);
+    flat.GetEntry(i);
+    Bool_t same = Si.NSiHits == Si2.NSiHits && PC.NPCHits == PC2.NPCHits &&
+      Si.ReadDet->size() == Si2.ReadDet->size() && Si.ReadHit->size() == Si2.ReadHit->size() && PC.ReadHit->size() == PC2.ReadHit->size();
+    for (size_t d=0; same && d<Si.ReadDet->size(); d++)
+      same = Si.ReadDet->at(d).DetID == Si2.ReadDet->at(d).DetID && Si.ReadDet->at(d).HitType == Si2.ReadDet->at(d).HitType &&
+	Si.ReadDet->at(d).BackChNum == Si2.ReadDet->at(d).BackChNum && Si.ReadDet->at(d).EBack_Cal.size() == Si2.ReadDet->at(d).EBack_Cal.size();
+    for (size_t h=0; same && h<Si.ReadHit->size(); h++)
+      same = Si.ReadHit->at(h).DetID == Si2.ReadHit->at(h).DetID && Same(Si.ReadHit->at(h).Energy,Si2.ReadHit->at(h).Energy) &&
+	Same(Si.ReadHit->at(h).ZW,Si2.ReadHit->at(h).ZW) && Same(Si.ReadHit->at(h).PhiW,Si2.ReadHit->at(h).PhiW);
+    for (size_t h=0; same && h<PC.ReadHit->size(); h++)
+      same = PC.ReadHit->at(h).WireID == PC2.ReadHit->at(h).WireID && Same(PC.ReadHit->at(h).Energy,PC2.ReadHit->at(h).Energy) &&
+	Same(PC.ReadHit->at(h).ZW,PC2.ReadHit->at(h).ZW);
+    for (size_t c=0; same && c<copied.size(); c++) {
+      Double_t a = nested_leaves[c]->GetValue(), b = flat_leaves[c]->GetValue();
+      same = (a == b) || (std::isnan(a) && std::isnan(b));
+    }
+    if (!same) differ++;
+  }
+  nestedFile.Close();
+  flatFile.Close();
+  cout << " " << differ << " entries differ" << endl;
+
+  Double_t nested_time = ReadTime(argv[1]);
+  Double_t flat_time = ReadTime(argv[2]);
+  cout << " Hit branches: nested " << nested_bytes/1e6 << " MB, flat " << flat_bytes/1e6 << " MB" << endl;
+  cout << " Read back: nested " << nentries/nested_time << " events/s, flat " << nentries/flat_time << " events/s" << endl;
+  return differ == 0 ? 0 : EXIT_FAILURE;
+}
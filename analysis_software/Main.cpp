@@ -4,9 +4,12 @@
 //
 // Author: Nabin Rijal, John Parker, Ingo Wiedenhover -- 2016 September.
 // Edited by : Jon Lighthall, 2016.12
+//
+// Input is either the DataTree written by evt2root, or (-evt) the .evt files of a run,
+// decoded in memory by evt2root/EvtRunReader.h; the DataTree is then optional.
+// The entries processed are chosen on the command line (-first, -last, -every, -random,
+// -stratified; see ../include/EntrySelection.h).
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#define MaxEntries (Long64_t) 1e9
-#define bfirst (Bool_t) kTRUE
 #define MaxADCHits  64
 #define MaxTDCHits  500
 
@@ -32,6 +35,12 @@
 // Check pulser calibration?
 //#define Pulser_ReRun
 #define Re_zero
+// Quadratic pulser alignment of the ASICs channels listed in this file, replacing the linear one
+//#define Quadratic_Pulser "Param/17F_cals/Sipulser_quadratic.dat"
+
+// The smearing within Si strips and PC wires depends only on (run, entry, detector, hit)
+// (see ../include/CounterRNG.h); change the seed to draw other numbers
+#define RandomSeed 0
 
 // Select the histograms for performing calibration or to check calibration
 #define Hist_for_Si_Cal
@@ -39,6 +48,38 @@
 //#define ZPosCal
 //#define Hist_after_Cal
 
+// Fill MainTree on a background thread (see ../include/TreeFillThread.h)
+#define FillThread (Bool_t) kTRUE
+// Compress the baskets of MainTree in parallel (ROOT implicit multi-threading)
+#define FillIMT (Bool_t) kFALSE
+// Threads of the event loop: each thread reads and processes its own chunks of ChunkSize entries
+// and fills its own histograms, which are merged at the end (see ../include/ParallelEntryLoop.h).
+// MainTree gets the same events in the same order as with one thread. The histograms take
+// NThreads times the memory. -evt always runs on one thread.
+#ifndef NThreads
+#define NThreads 1
+#endif
+#define ChunkSize 10000
+// Compression, basket sizes and auto-flush of the output trees (see ../include/TreeOutputConfig.h)
+#define OutputConfig "../include/tree_output.dat"
+// CAEN channels kept when -evt decodes the .evt files, as in evt2root (see ../evt2root/CAENAcceptance.h).
+// Without the file the default selection (PC, IC, RF/MCP) is used, with a warning
+#define CAENConfig "../evt2root/caen_channels.dat"
+// Bytes of TTreeCache for the DataTree read, and whether ROOT reads the next cache blocks on a
+// thread of its own, for input files on a network file system (see ../include/TreeInput.h)
+#define InputCache (Long64_t) 30000000
+#define AsyncPrefetch (Bool_t) kFALSE
+// Write the Si and PC hits of MainTree as flat arrays, one branch per member, instead of
+// Si.Detector, Si.Hit and PC.Hit (see ../include/FlatMainTree.h)
+#ifndef FlatOutput
+#define FlatOutput (Bool_t) kFALSE
+#endif
+// Look the histograms up by name on every fill, as the old MyFill did, to compare the event rates
+// (see ../include/HistRegistry.h; make Main_byname builds Main with it set)
+#ifndef HistByName
+#define HistByName (Bool_t) kFALSE
+#endif
+
 ///////////////////////////////////////////////////// include Libraries ///////////////////////////////////////////////////////
 //C/C++
 #include <stdexcept>
@@ -46,6 +87,7 @@
 #include <fstream>
 #include <string>
 #include <iomanip>
+#include <cctype>
 
 //ROOT
 #include <TH2.h>
@@ -58,21 +100,26 @@
 #include <TApplication.h>
 #include <TROOT.h>
 #include <TCutG.h>
+#include <TStopwatch.h>
 
 //Associated header files/methods
 #include "ChannelMap.h"
 #include "../include/2016_detclass.h"
 #include "Silicon_Cluster.h"
+#include "../evt2root/EvtRunReader.h"
+#include "../include/TreeFillThread.h"
+#include "../include/TreeOutputConfig.h"
+#include "../include/HistRegistry.h"
+#include "../include/ParallelEntryLoop.h"
+#include "../include/CutRegistry.h"
+#include "../include/CounterRNG.h"
+#include "../include/FiredChannels.h"
+#include "../include/FlatMainTree.h"
+#include "../include/TreeInput.h"
+#include "../include/EntrySelection.h"
 
 using namespace std;
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-//Methods that fills 1D && 2D Histograms
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY);
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX);
-
 //Methods to sort Silicon energy in descending orders
 bool Track::Tr_Sisort_method(struct TrackEvent a,struct TrackEvent b){
   if(a.SiEnergy > b.SiEnergy)
@@ -87,867 +134,1131 @@ bool Track::Tr_PCsort_method(struct TrackEvent a,struct TrackEvent b){
   return 0;
 };
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-TList* fhlist;
-std::map<string,TH1*> fhmap;
+//The histograms of fhlist, filled through the handles below (../include/HistRegistry.h). Each event
+//loop fills its own copy of fh.
+HistRegistry fh;
+HistFamily hPC_Down_vs_Up_BeforeCal_WireN = fh.Book("PC_Down_vs_Up_BeforeCal_Wire%i",NPCWires);
+HistFamily hPC_Offset_vs_Down_BeforeCal_WireN = fh.Book("PC_Offset_vs_Down_BeforeCal_Wire%i",NPCWires);
+HistFamily hPC_sum_vs_diffN = fh.Book("PC_sum_vs_diff%i",NPCWires);
+HistFamily hPC_Down_vs_Up_AfterCal_WireN = fh.Book("PC_Down_vs_Up_AfterCal_Wire%i",NPCWires);
+HistFamily hPC_Offset_vs_Down_AfterCal_WireN = fh.Book("PC_Offset_vs_Down_AfterCal_Wire%i",NPCWires);
+HistFamily hPC_sum_vs_ZN = fh.Book("PC_sum_vs_Z%i",NPCWires);
+HistFamily hPCZN = fh.Book("PCZ%i",NPCWires);
+HistFamily hTime_RF = fh.Book("Time_RF");
+HistFamily hTime_MCP = fh.Book("Time_MCP");
+HistFamily hTime_MCP_vs_RF = fh.Book("Time_MCP_vs_RF");
+HistFamily hTOF_vs_RF = fh.Book("TOF_vs_RF");
+HistFamily hTOFc_vs_RF = fh.Book("TOFc_vs_RF");
+HistFamily hTOFc = fh.Book("TOFc");
+HistFamily hTOFw = fh.Book("TOFw");
+HistFamily hTOFw2 = fh.Book("TOFw2");
+HistFamily hTOF_wrapped_in = fh.Book("TOF_wrapped_in");
+HistFamily hTOF_wrapped_out = fh.Book("TOF_wrapped_out");
+HistFamily hIC_dE = fh.Book("IC_dE");
+HistFamily hIC_E = fh.Book("IC_E");
+HistFamily hIC_TOF_vs_ESi = fh.Book("IC_TOF_vs_ESi");
+HistFamily hIC_TOFc_vs_ESi = fh.Book("IC_TOFc_vs_ESi");
+HistFamily hIC_EdE = fh.Book("IC_EdE");
+HistFamily hback_vs_front_CalN = fh.Book("back_vs_front_Cal%i",NumDet);
+HistFamily hsx3offset_back_vs_front_CalN = fh.Book("sx3offset_back_vs_front_Cal%i",NumDet);
+HistFamily hdown_vs_upN_N_N = fh.Book("down_vs_up%i_%i_%i",NumDet,4,4);
+HistFamily hdown_vs_up_divBN_N_N = fh.Book("down_vs_up_divB%i_%i_%i",NumDet,4,4);
+HistFamily hdown_vs_upN_fN = fh.Book("down_vs_up%i_f%i",NumDet,4);
+HistFamily hdown_vs_up_divBN_fN = fh.Book("down_vs_up_divB%i_f%i",NumDet,4);
+HistFamily hback_vs_frontN_N_N = fh.Book("back_vs_front%i_%i_%i",NumDet,4,4);
+HistFamily hback_vs_frontN_bN = fh.Book("back_vs_front%i_b%i",NumDet,4);
+HistFamily hback_vs_frontN = fh.Book("back_vs_front%i",NumDet);
+HistFamily hdown_vs_upN = fh.Book("down_vs_up%i",NumDet);
+HistFamily hback_vs_offset_divBN = fh.Book("back_vs_offset_divB%i",NumDet);
+HistFamily hback_vs_offsetN_N_N = fh.Book("back_vs_offset%i_%i_%i",NumDet,4,4);
+HistFamily hback_vs_offsetN = fh.Book("back_vs_offset%i",NumDet);
+HistFamily hback_vs_posN = fh.Book("back_vs_pos%i",NumDet);
+HistFamily hSX3Zpos_N_N_N = fh.Book("SX3Zpos_%i_%i_%i",NumDet,4,4);
+HistFamily hSX3Zpos_N_fN = fh.Book("SX3Zpos_%i_f%i",NumDet,4);
+HistFamily hSX3Zpos_N = fh.Book("SX3Zpos_%i",NumDet);
+HistFamily hSX3ZposCal_N_N_N = fh.Book("SX3ZposCal_%i_%i_%i",NumDet,4,4);
+HistFamily hSX3ZposCal_N_fN = fh.Book("SX3ZposCal_%i_f%i",NumDet,4);
+HistFamily hSX3ZposCal_N = fh.Book("SX3ZposCal_%i",NumDet);
+HistFamily hPCPhi_vs_SiPhi_SX3 = fh.Book("PCPhi_vs_SiPhi_SX3");
+HistFamily hQ3_offset_back_vs_front_CalN = fh.Book("Q3_offset_back_vs_front_Cal%i",NumDet);
+HistFamily hQ3_back_vs_frontN_N_N = fh.Book("Q3_back_vs_front%i_%i_%i",NumDet,16,16);
+HistFamily hQ3_back_vs_frontN_bN = fh.Book("Q3_back_vs_front%i_b%i",NumDet,16);
+HistFamily hQ3_back_vs_frontN = fh.Book("Q3_back_vs_front%i",NumDet);
+HistFamily hQ3_back_vs_offsetN = fh.Book("Q3_back_vs_offset%i",NumDet);
+HistFamily hPCPhi_vs_SiPhi_Q3 = fh.Book("PCPhi_vs_SiPhi_Q3");
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-int main(int argc, char* argv[]) {
-
-  if (argc<3) {
-    cout << " Error: Wrong number of arguments\n";
-    exit(EXIT_FAILURE);
-  }
-  
+//Branch variables of MainTree
+struct MainEvent {
   SiHit Si;
-  PCHit PC;  
-  
-  Silicon_Cluster SiSort;
-  SiSort.Initialize();
-
-  //read in command line arguments
-  char* filename_histout = new char [200];//output root file
-  char* filename_callist = new char [200];//input file list
-  
-  strcpy( filename_callist, argv[1] );
-  strcpy( filename_histout, argv[2] );
-
-  TFile *outputFile = new TFile(filename_histout,"RECREATE");
-  TTree *MainTree = new TTree("MainTree","MainTree");
-  
-  MainTree->Branch("Si.NSiHits",&Si.NSiHits,"NSiHits/I");
-  MainTree->Branch("Si.Detector",&Si.Detector);
-  MainTree->Branch("Si.Hit",&Si.Hit);
-  MainTree->Branch("PC.NPCHits",&PC.NPCHits,"NPCHits/I");
-  MainTree->Branch("PC.Hit",&PC.Hit); 
-
+  PCHit PC;
   Int_t RFTime,MCPTime;
-  MainTree->Branch("RFTime",&RFTime,"RFTime/I");
-  MainTree->Branch("MCPTime",&MCPTime,"MCPTime/I");
   Float_t TOFTime,TOFcTime,TOFwTime;
-  MainTree->Branch("TOFTime",&TOFTime,"TOFTime/F");
-  MainTree->Branch("TOFcTime",&TOFcTime,"TOFcTime/F");
-  MainTree->Branch("TOFwTime",&TOFwTime,"TOFwTime/F");
-
-#ifdef IC_hists 
+#ifdef IC_hists
   Int_t IC_dE,IC_E;
-  MainTree->Branch("IC.dE",&IC_dE,"IC_dE/I");
-  MainTree->Branch("IC.E",&IC_E,"IC_E/I");
 #endif
 
-  TObjArray *RootObjects = new TObjArray();
-  RootObjects->Add(MainTree);
-
-  fhlist = new TList;
-  RootObjects->Add(fhlist);
-
-  ChannelMap *CMAP;
-  CMAP = new ChannelMap();
-  cout<<" ============================================================================================"<<endl; 
-  //Initialization of the main channel map  
-  ////////////////////////////////////////////////////////////////////////////
-  
-  //initialize 17F
-  if(1) {//load calibration files
-    CMAP->Init("Param/24Mg_cals/initialize/ASICS_cmap_022716",
-	       "Param/17F_cals/Sipulser_2016.07.20offsets_centroid.dat",
-	       "Param/17F_cals/AlphaCal_170515.edit.dat",
-	       "Param/17F_cals/X3RelativeGains_Step3_170525.dat",
-	       "Param/17F_cals/QQQRelativeGains_Step2_170428.dat");
-    CMAP->FinalInit("Param/17F_cals/X3FinalFix_Step3_170525.dat",
-		    "Param/17F_cals/X3geometry_180201_600bins_2.875.dat");
-    CMAP->LoadQ3FinalFix("Param/17F_cals/QQQFinalFix_Step2_170428.dat");
-    CMAP->InitPCCalibration("Param/17F_cals/PCpulserCal_zero_2017-11-06.dat");
-    CMAP->Init_PC_UD_RelCal("Param/17F_cals/PC_UD_RelCal_180205.dat");
-    CMAP->Init_PCWire_RelGain("Param/17F_cals/PCWire_RelGain_init.dat");
-    CMAP->InitPCWireCal("Param/17F_cals/PCWireCal_180206_average.dat");
-  }
-  else {//load trivial calibration, before any cal where all slopes are one and offsets zero
-    CMAP->Init("Param/24Mg_cals/initialize/ASICS_cmap_022716",
-	       "Param/initialize/Sipulser_init.dat",
-	       "Param/initialize/AlphaCalibration_init.dat",
-	       "Param/initialize/X3RelativeGains_Slope1.dat",
-	       "Param/initialize/QQQRelativeGains_Slope1.dat");
-    CMAP->FinalInit("Param/initialize/X3FinalFix_init.dat",
-		    "Param/initialize/X3geometry_init.dat");
-    CMAP->LoadQ3FinalFix("Param/initialize/QQQFinalFix_init.dat");
-    CMAP->InitPCCalibration("Param/initialize/PCpulser_init.dat");
-    CMAP->InitPCWireCal("Param/initialize/PCWireCal_init.dat");
-    CMAP->Init_PC_UD_RelCal("Param/initialize/PC_UD_RelCal_init.dat");
-    CMAP->Init_PCWire_RelGain("Param/initialize/PCWire_RelGain_init.dat");
-  }
-    
-  CMAP->InitWorldCoordinates("Param/17F_cals/WorldCoord_170223.dat");  
-  CMAP->InitPCADC("Param/initialize/NewPCMap");  
-  cout<<" ============================================================================================"<<endl;
-  //------------------------------------------------------------------------------------------
-  TFile *inputFile = new TFile(filename_callist);//open root file and make sure it exists---------------------
-  if (!inputFile->IsOpen()) {
-    cout << "Root file: " << filename_callist << " could not be opened.\n";
-    exit(EXIT_FAILURE);
+  MainEvent() : RFTime(0), MCPTime(0), TOFTime(0), TOFcTime(0), TOFwTime(0) {
+#ifdef IC_hists
+    IC_dE = IC_E = 0;
+#endif
   }
-  
-  //Create Objects of the Detector Classes
-  ASICHit Si_Old;
-  CAENHit ADC;
-  CAENHit TDC;
-  
-  //Set Branch Addresses so that they can be accessed ------------------------
-  TTree *input_tree = (TTree*) inputFile->Get("DataTree");
-  input_tree->SetBranchAddress("Si.Nhits",&Si_Old.Nhits);
-  input_tree->SetBranchAddress("Si.MBID",Si_Old.MBID);
-  input_tree->SetBranchAddress("Si.CBID",Si_Old.CBID);
-  input_tree->SetBranchAddress("Si.ChNum",Si_Old.ChNum);
-  input_tree->SetBranchAddress("Si.Energy",Si_Old.Energy);
-  input_tree->SetBranchAddress("Si.Time",Si_Old.Time);
-  
-  input_tree->SetBranchAddress("ADC.Nhits",&ADC.Nhits);
-  input_tree->SetBranchAddress("ADC.ID",ADC.ID);
-  input_tree->SetBranchAddress("ADC.ChNum",ADC.ChNum);
-  input_tree->SetBranchAddress("ADC.Data",ADC.Data);
-
-  input_tree->SetBranchAddress("TDC.Nhits",&TDC.Nhits);
-  input_tree->SetBranchAddress("TDC.ID",TDC.ID);
-  input_tree->SetBranchAddress("TDC.ChNum",TDC.ChNum);
-  input_tree->SetBranchAddress("TDC.Data",TDC.Data);
-  //--------------------------------------------------------------------------
+};
 
-  //Initialize Detector Numbers && Channels
-  Int_t DN = -1;
-  Int_t DetCh=-1;
-  
-  Double_t ZeroShift=0,VperCh=0;
-  //Double_t p0_coeff = 0,p1_coeff = 0, p2_coeff = 0, x0_offset = 0;
-  Double_t Gain_Rel=0,Gain_Alpha=0;
-  Double_t FinalShift=0;
-  
+//Everything that changes from event to event: the input event, the branch variables, the sorting of the
+//Si hits, the random numbers and the histograms. The event loop has one of these per thread; the
+//ChannelMap is shared and only read.
+class MainProcessor : public MainEvent {
+ public:
+  PhysicsEvent Raw;
+  ASICHit& Si_Old;
+  CAENHit& ADC;
+  CAENHit& TDC;
+  TreeInput *input; //the DataTree
+
+  const ChannelMap *CMAP;
+  Silicon_Cluster SiSort;
+  CounterRNG PCRandom; //smearing of the PC angle within the wire
+  HistRegistry fh;     //copy of the global fh
+#ifdef IC_cut
+  const FastCut *ICCut; //E-dE cut of the ion chamber (../include/CutRegistry.h)
+#endif
+
+  //Per-event arrays, written only where the event has hits; the Fired masks tell which cells
+  //were written in the current event (../include/FiredChannels.h)
   Double_t SX3Energy[NumSX3][MaxSX3Ch];
   Double_t SX3Time[NumSX3][MaxSX3Ch];
   Double_t SX3Energy_Pulser[NumSX3][MaxSX3Ch];
   Double_t SX3Energy_Rel[NumSX3][MaxSX3Ch];
   Double_t SX3Energy_Cal[NumSX3][MaxSX3Ch];
+  FiredChannels<NumSX3,MaxSX3Ch> SX3Fired;
 
   Double_t Q3Energy[NumQ3][MaxQ3Ch];
   Double_t Q3Time[NumQ3][MaxQ3Ch];
   Double_t Q3Energy_Pulser[NumQ3][MaxQ3Ch];
   Double_t Q3Energy_Rel[NumQ3][MaxQ3Ch];
   Double_t Q3Energy_Cal[NumQ3][MaxQ3Ch];
-  
-  //PC Variables
-  Int_t Side,WireID;
+  FiredChannels<NumQ3,MaxQ3Ch> Q3Fired;
+
   Double_t PCDown[NPCWires];
   Double_t PCUp[NPCWires];
   Double_t PCDownVoltage[NPCWires];
   Double_t PCUpVoltage[NPCWires];
-  Bool_t ConvTest=kFALSE;
-  Double_t Vcal=sqrt(-1);
+  FiredChannels<NPCWires,1> PCFired;
 
-  Int_t status = 0;
-  Long64_t nentries = input_tree->GetEntries();
-  cout << " nentries = " << nentries<<"  in  "<< filename_callist <<endl;
+  TreeFillThread *MainFill;      //MainTree is filled with the events that are kept,
+  std::vector<MainEvent> *Buffer; //or, if set, they are copied here to be filled later
 
-  //Entry counting variables
-  Bool_t btrunc=kFALSE; //truncate data set?
-  Long64_t nstep=1;
-  Long64_t ncount=0; 
-  Long64_t nsum=0; 
-  Long64_t ntot=nentries;
-#ifdef MaxEntries
-  nstep=nentries/MaxEntries;
-  ntot=nentries/nstep;
-  if(nentries>MaxEntries) {
-    btrunc=kTRUE;
-    cout << " Max entries exceeded! Truncating data set from " << nentries << " to ";
-
-    if(bfirst) {
-    //set first
-    nentries=MaxEntries;
-    ntot=nentries;
-    nstep=1;
+  MainProcessor(const ChannelMap *cmap, const HistRegistry& hists, UInt_t run)
+    : Si_Old(Raw.Si), ADC(Raw.ADC), TDC(Raw.TDC), input(NULL),
+      CMAP(cmap), fh(hists), MainFill(NULL), Buffer(NULL) {
+    SiSort.Initialize(run,RandomSeed);
+    PCRandom.SetRun(run);
+    PCRandom.SetSeed(RandomSeed);
+  }
+
+  //Reads the events from the DataTree of filename
+  void OpenDataTree(const char* filename) {
+    TFile *inputFile = new TFile(filename);//open root file and make sure it exists---------------------
+    if (!inputFile->IsOpen()) {
+      cout << "Root file: " << filename << " could not be opened.\n";
+      exit(EXIT_FAILURE);
     }
+  
+    //Set Branch Addresses so that they can be accessed; only these branches are read -----
+    input = new TreeInput((TTree*) inputFile->Get("DataTree"),InputCache);
+    input->Read("Si.Nhits",&Si_Old.Nhits);
+    input->Read("Si.MBID",Si_Old.MBID);
+    input->Read("Si.CBID",Si_Old.CBID);
+    input->Read("Si.ChNum",Si_Old.ChNum);
+    input->Read("Si.Energy",Si_Old.Energy);
+    input->Read("Si.Time",Si_Old.Time);
+  
+    input->Read("ADC.Nhits",&ADC.Nhits);
+    input->Read("ADC.ID",ADC.ID);
+    input->Read("ADC.ChNum",ADC.ChNum);
+    input->Read("ADC.Data",ADC.Data);
+
+    input->Read("TDC.Nhits",&TDC.Nhits);
+    input->Read("TDC.ID",TDC.ID);
+    input->Read("TDC.ChNum",TDC.ChNum);
+    input->Read("TDC.Data",TDC.Data);
+  }
+  Long64_t GetEntries() { return input->GetTree()->GetEntries(); }
+  Int_t GetEntry(Long64_t entry) { return input->GetEntry(entry); }
+
+  //Processes the event in Raw, entry global_evt of the run. kFALSE if the event is rejected.
+  Bool_t Process(Long64_t global_evt);
 
-    cout << ntot <<endl;
-    if(bfirst)
-      cout << " Processing first " << ntot << " entries" <<endl;
+  void FillMainTree() {
+    if (Buffer)
+      Buffer->push_back(*this);
     else
-    cout << " Processing 1 out of every " << nstep << " entries" <<endl;
-  }
-  else {
-    ntot=nentries;
-    cout << " Processing  " << ntot << " entries" <<endl;
+      MainFill->Fill();
   }
-#endif
-  Float_t print_step=0.1;
-  if(ntot>5e5)
-    print_step/=10;
-  cout << " Each \".\" represents " << (print_step/10)*ntot << " events or " << print_step/10*100 <<"% of total" <<endl;
+};
+
+Bool_t MainProcessor::Process(Long64_t global_evt) {
+  SiSort.SetEntry(global_evt);
+  PCRandom.SetEntry(global_evt);
+  fh.SetEntry(global_evt);
+
+  //Initialize Detector Numbers && Channels
+  Int_t DN = -1;
+  Int_t DetCh=-1;
   
-  for (Long64_t global_evt=0; global_evt<nentries; global_evt++) {//loop over all entries in tree------
-    if(btrunc && global_evt%nstep>0) continue;
-    status = input_tree->GetEvent(global_evt);
-    
-    if(btrunc) 
-      nsum=ncount;
-    else 
-      nsum=global_evt;
-
-    if(nsum%TMath::Nint(ntot*print_step)==0) { cout << endl << "  Done: "
-						      << right << fixed << setw(3)
-						      << TMath::Nint(nsum*100./ntot) << "%" << std::flush;
-      //cout << " global_evt = " << global_evt << ", ncount = " <<ncount<<endl;//total vs passed
-      //cout << "   sum is "<< nsum << " total is " << ntot;
-      //cout << " " << nsum*100./ntot << "%          ";
-    }
-    if(nsum%TMath::Nint(ntot*print_step/10)==0 && ntot>0) cout << "." << std::flush;
-    //std::cout << "\rDone: " << nsum*100./ntot << "%" << std::flush;
-    
-    /////////////////////////////////  CAEN section (PC, IC, CsI,..etc) ////////////////////////////////
-
-    //======================= PC variables are initialized and Filled here.=============================
-
-    PC.zeroPCHit();  
-
-    Int_t Identifier=-1;  
-    //************************************************************************************************
-    // Identifier provides information on the detector type recorded by ADC.
-    // 0 - no identification was possible, this channel is not described in the ADCChannels.xxxx file
-    // 1 - Gas Proportional counter data
-    // 2 - CsI(Tl) scintillator   
-    //*************************************************************************************************
-    // Initialize variables named above.
-    for (Int_t i=0; i<NPCWires; i++) {
-      PCDown[i]  = sqrt(-1);
-      PCUp[i]    = sqrt(-1);
-      PCDownVoltage[i] = sqrt(-1);
-      PCUpVoltage[i]   = sqrt(-1);
-    }
-    // Make sure your ADC.Nhits is within bounds.
-    if (ADC.Nhits>MaxADCHits) {
-      printf("MaxADCHits exceeded! %d > %d\n",ADC.Nhits,MaxADCHits);
-      ADC.Nhits=MaxADCHits;
-    }
-    
-    for (Int_t n=0; n<ADC.Nhits; n++) {
-      // Identify which detector type we have a hit in.
-      CMAP->IdentifyADC(ADC.ID[n],ADC.ChNum[n],Identifier);
-      switch (Identifier) {
-      case 0:
-	break;
-      case 1:
-	CMAP->IdentifyWire(ADC.ID[n],ADC.ChNum[n],WireID,Side);
-	ConvTest =  CMAP->ConvertToVoltage(ADC.ID[n],ADC.ChNum[n],ADC.Data[n],Vcal);
-	if (Side==1) {
-	  PCDown[WireID] = (Double_t)ADC.Data[n];
-	  if (ConvTest) PCDownVoltage[WireID] = Vcal;
-	}
-	if (Side==2) {
-	  PCUp[WireID]   = (Double_t)ADC.Data[n];
-	  if (ConvTest) PCUpVoltage[WireID]  = Vcal;
-	}
-	ConvTest = kFALSE;
-	break;
-      default:
-	break;
-      }// End switch
-    }// End loop over ADC.Nhits
+  Double_t ZeroShift=0,VperCh=0;
+  Double_t Gain_Rel=0,Gain_Alpha=0;
+  Double_t FinalShift=0;
   
-    //=================================
-    Double_t XWPC,YWPC,ZWPC,RWPC,PhiWPC,PCRelGain, SlopeUD, OffsetUD;
-   
-    for ( Int_t i=0; i<NPCWires; i++ ) {
-
-      PC.ZeroPC_obj();
-
-      if((PCDown[i] > PC_Min_threshold || PCUp[i] > PC_Min_threshold) && (PCDown[i] < PC_Max_threshold && PCUp[i] < PC_Max_threshold)) { 
-	
-	PC.pc_obj.WireID = i;
-	PC.pc_obj.Down = PCDown[i];
-	PC.pc_obj.Up = PCUp[i];
-	PC.pc_obj.Sum=PC.pc_obj.Down+PC.pc_obj.Up;
-	PC.pc_obj.DownVoltage = PCDownVoltage[i];
-	PC.pc_obj.UpVoltage = PCUpVoltage[i];
+  //PC Variables
+  Int_t Side,WireID;
+  Bool_t ConvTest=kFALSE;
+  Double_t Vcal=sqrt(-1);
+
+  /////////////////////////////////  CAEN section (PC, IC, CsI,..etc) ////////////////////////////////
+
+  //======================= PC variables are initialized and Filled here.=============================
+
+  PC.zeroPCHit();  
+
+  Int_t Identifier=-1;  
+  //************************************************************************************************
+  // Identifier provides information on the detector type recorded by ADC.
+  // 0 - no identification was possible, this channel is not described in the ADCChannels.xxxx file
+  // 1 - Gas Proportional counter data
+  // 2 - CsI(Tl) scintillator   
+  //*************************************************************************************************
+  // Only the wires with a hit are initialized, when they get their first hit.
+  PCFired.Clear();
+  // Make sure your ADC.Nhits is within bounds.
+  if (ADC.Nhits>MaxADCHits) {
+    printf("MaxADCHits exceeded! %d > %d\n",ADC.Nhits,MaxADCHits);
+    ADC.Nhits=MaxADCHits;
+  }
+
+  for (Int_t n=0; n<ADC.Nhits; n++) {
+    // Identify which detector type we have a hit in (and for PC channels, the wire and side).
+    CMAP->IdentifyADCChannel(ADC.ID[n],ADC.ChNum[n],Identifier,WireID,Side);
+    switch (Identifier) {
+    case 0:
+      break;
+    case 1:
+      ConvTest =  CMAP->ConvertToVoltage(ADC.ID[n],ADC.ChNum[n],ADC.Data[n],Vcal);
+      if ((Side==1 || Side==2) && PCFired.Set(WireID,0)) {
+	PCDown[WireID]  = sqrt(-1);
+	PCUp[WireID]    = sqrt(-1);
+	PCDownVoltage[WireID] = sqrt(-1);
+	PCUpVoltage[WireID]   = sqrt(-1);
+      }
+      if (Side==1) {
+	PCDown[WireID] = (Double_t)ADC.Data[n];
+	if (ConvTest) PCDownVoltage[WireID] = Vcal;
+      }
+      if (Side==2) {
+	PCUp[WireID]   = (Double_t)ADC.Data[n];
+	if (ConvTest) PCUpVoltage[WireID]  = Vcal;
+      }
+      ConvTest = kFALSE;
+      break;
+    default:
+      break;
+    }// End switch
+  }// End loop over ADC.Nhits
+
+  //=================================
+  Double_t XWPC,YWPC,ZWPC,RWPC,PhiWPC,PCRelGain, SlopeUD, OffsetUD;
+
+  //Wires with a hit, in ascending order
+  for ( UInt_t wires=PCFired.Detectors(); wires; wires &= wires-1 ) {
+    Int_t i = PCFired.Lowest(wires);
+
+    PC.ZeroPC_obj();
+
+    if((PCDown[i] > PC_Min_threshold || PCUp[i] > PC_Min_threshold) && (PCDown[i] < PC_Max_threshold && PCUp[i] < PC_Max_threshold)) { 
+
+      PC.pc_obj.WireID = i;
+      PC.pc_obj.Down = PCDown[i];
+      PC.pc_obj.Up = PCUp[i];
+      PC.pc_obj.Sum=PC.pc_obj.Down+PC.pc_obj.Up;
+      PC.pc_obj.DownVoltage = PCDownVoltage[i];
+      PC.pc_obj.UpVoltage = PCUpVoltage[i];
 
 #ifdef Re_zero
-	Float_t rezero=1.53324544243191307e-02;
-	PC.pc_obj.DownVoltage += rezero/2; 
-	PC.pc_obj.UpVoltage += rezero/2;
-#endif
-	
-	PC.pc_obj.SumVoltage=PC.pc_obj.DownVoltage+PC.pc_obj.UpVoltage;
-
-	Int_t bins=512;
-	Float_t vmin=-0.1;
-	Float_t vmax=0.2;
-	Float_t orange=0.008;
-	
+      Float_t rezero=1.53324544243191307e-02;
+      PC.pc_obj.DownVoltage += rezero/2; 
+      PC.pc_obj.UpVoltage += rezero/2;
+#endif
+
+      PC.pc_obj.SumVoltage=PC.pc_obj.DownVoltage+PC.pc_obj.UpVoltage;
+
+      Int_t bins=512;
+      Float_t vmin=-0.1;
+      Float_t vmax=0.2;
+      Float_t orange=0.008;
+
 #ifdef Hist_for_PC_Cal	
-	MyFill(Form("PC_Down_vs_Up_BeforeCal_Wire%i",i),
-	       bins,vmin,vmax,PC.pc_obj.UpVoltage,bins,vmin,vmax,PC.pc_obj.DownVoltage);
-	MyFill(Form("PC_Offset_vs_Down_BeforeCal_Wire%i",i),
-	       bins,vmin,vmax,PC.pc_obj.DownVoltage,
-	       bins,-orange,orange,(PC.pc_obj.DownVoltage-PC.pc_obj.UpVoltage));
-	MyFill(Form("PC_sum_vs_diff%i",i),
-	       bins,-orange,orange,(PC.pc_obj.DownVoltage-PC.pc_obj.UpVoltage),
-	       bins,vmin,2*vmax,PC.pc_obj.SumVoltage);
-#endif
-
-	CMAP->Get_PC_UD_RelCal(i, SlopeUD, OffsetUD);
-	PC.pc_obj.DownRel = (PC.pc_obj.DownVoltage/SlopeUD) - OffsetUD;
-	PC.pc_obj.UpRel = PC.pc_obj.UpVoltage;
-	PC.pc_obj.SumRel=PC.pc_obj.DownRel+PC.pc_obj.UpRel;
-	
+      fh.Fill(hPC_Down_vs_Up_BeforeCal_WireN(i),
+	     bins,vmin,vmax,PC.pc_obj.UpVoltage,bins,vmin,vmax,PC.pc_obj.DownVoltage);
+      fh.Fill(hPC_Offset_vs_Down_BeforeCal_WireN(i),
+	     bins,vmin,vmax,PC.pc_obj.DownVoltage,
+	     bins,-orange,orange,(PC.pc_obj.DownVoltage-PC.pc_obj.UpVoltage));
+      fh.Fill(hPC_sum_vs_diffN(i),
+	     bins,-orange,orange,(PC.pc_obj.DownVoltage-PC.pc_obj.UpVoltage),
+	     bins,vmin,2*vmax,PC.pc_obj.SumVoltage);
+#endif
+
+      CMAP->Get_PC_UD_RelCal(i, SlopeUD, OffsetUD);
+      PC.pc_obj.DownRel = (PC.pc_obj.DownVoltage/SlopeUD) - OffsetUD;
+      PC.pc_obj.UpRel = PC.pc_obj.UpVoltage;
+      PC.pc_obj.SumRel=PC.pc_obj.DownRel+PC.pc_obj.UpRel;
+
 #ifdef Hist_for_PC_Cal
-	MyFill(Form("PC_Down_vs_Up_AfterCal_Wire%i",i),
-	       bins,vmin,vmax,PC.pc_obj.UpRel,bins,vmin,vmax,PC.pc_obj.DownRel);
-	MyFill(Form("PC_Offset_vs_Down_AfterCal_Wire%i",i),
-	       bins,vmin,vmax,PC.pc_obj.DownVoltage,
-	       bins,-orange,orange,(PC.pc_obj.DownRel-PC.pc_obj.UpRel));
-#endif
-	
-	if (PC.pc_obj.DownRel>0 && PC.pc_obj.UpRel>0) {
-	  PC.pc_obj.Energy = PC.pc_obj.DownRel + PC.pc_obj.UpRel;
-	  PC.pc_obj.Z = (PC.pc_obj.UpRel - PC.pc_obj.DownRel)/PC.pc_obj.Energy;	 
-	    
-	  CMAP->Get_PCWire_RelGain(PC.pc_obj.WireID, PCRelGain);
-	  //cout<<"  PCRelGain == "<<PCRelGain<<endl;
-	  if(PCRelGain==0)
-	    PC.pc_obj.Energy = sqrt(-1);
-	  else
-	    PC.pc_obj.Energy *= PCRelGain;
-
-	  Float_t zrange=1.2;
+      fh.Fill(hPC_Down_vs_Up_AfterCal_WireN(i),
+	     bins,vmin,vmax,PC.pc_obj.UpRel,bins,vmin,vmax,PC.pc_obj.DownRel);
+      fh.Fill(hPC_Offset_vs_Down_AfterCal_WireN(i),
+	     bins,vmin,vmax,PC.pc_obj.DownVoltage,
+	     bins,-orange,orange,(PC.pc_obj.DownRel-PC.pc_obj.UpRel));
+#endif
+
+      if (PC.pc_obj.DownRel>0 && PC.pc_obj.UpRel>0) {
+	PC.pc_obj.Energy = PC.pc_obj.DownRel + PC.pc_obj.UpRel;
+	PC.pc_obj.Z = (PC.pc_obj.UpRel - PC.pc_obj.DownRel)/PC.pc_obj.Energy;	 
+
+	CMAP->Get_PCWire_RelGain(PC.pc_obj.WireID, PCRelGain);
+	//cout<<"  PCRelGain == "<<PCRelGain<<endl;
+	if(PCRelGain==0)
+	  PC.pc_obj.Energy = sqrt(-1);
+	else
+	  PC.pc_obj.Energy *= PCRelGain;
+
+	Float_t zrange=1.2;
 
 #ifdef Hist_for_PC_Cal		  
-	  MyFill(Form("PC_sum_vs_Z%i",PC.pc_obj.WireID),
-		 bins,-zrange,zrange,PC.pc_obj.Z,
-		 bins,vmin,2*vmax,PC.pc_obj.Energy);
-	  MyFill(Form("PCZ%i",PC.pc_obj.WireID),
-		 bins,-zrange,zrange,PC.pc_obj.Z);
+	fh.Fill(hPC_sum_vs_ZN(PC.pc_obj.WireID),
+	       bins,-zrange,zrange,PC.pc_obj.Z,
+	       bins,vmin,2*vmax,PC.pc_obj.Energy);
+	fh.Fill(hPCZN(PC.pc_obj.WireID),
+	       bins,-zrange,zrange,PC.pc_obj.Z);
 #endif	
 
-	  // calculate world coordinates
-	  CMAP->GetPCWorldCoordinates(PC.pc_obj.WireID,PC.pc_obj.Z,XWPC,YWPC,ZWPC,RWPC,PhiWPC);
-	  PC.pc_obj.XW = XWPC;
-	  PC.pc_obj.YW = YWPC;
-	  PC.pc_obj.ZW = ZWPC;
-	  PC.pc_obj.RW = RWPC;
-	  PC.pc_obj.PhiW = PhiWPC;
-	}
-	PC.Hit.push_back(PC.pc_obj);
-	PC.NPCHits++;
+	// calculate world coordinates
+	CMAP->GetPCWorldCoordinates(PC.pc_obj.WireID,PC.pc_obj.Z,PCRandom.Rndm(CounterRNG::kPCWire,PC.pc_obj.WireID,0),
+				    XWPC,YWPC,ZWPC,RWPC,PhiWPC);
+	PC.pc_obj.XW = XWPC;
+	PC.pc_obj.YW = YWPC;
+	PC.pc_obj.ZW = ZWPC;
+	PC.pc_obj.RW = RWPC;
+	PC.pc_obj.PhiW = PhiWPC;
       }
-    }//end NPCWires loops
-    ////=============================== MCP && RF =====================================================
-    if (TDC.Nhits>MaxTDCHits) {
-      printf("MaxTDCHits exceeded! %d > %d\n",TDC.Nhits,MaxTDCHits);
-      TDC.Nhits=MaxTDCHits;
+      PC.Hit.push_back(PC.pc_obj);
+      PC.NPCHits++;
     }
+  }//end loop over the wires with a hit
+  ////=============================== MCP && RF =====================================================
+  if (TDC.Nhits>MaxTDCHits) {
+    printf("MaxTDCHits exceeded! %d > %d\n",TDC.Nhits,MaxTDCHits);
+    TDC.Nhits=MaxTDCHits;
+  }
 
-    RFTime = 0;
-    MCPTime = 0;
- 
-    Double_t slope=0.9861; //slope of MCP vs RF
-    Double_t offset=271.56; //peak-to-peak spacing
-    Double_t wrap=offset*2;
-    Double_t TOF,TOFc,TOFw;
-    Int_t tbins=600;
-
-    for (Int_t n=0; n<TDC.Nhits; n++) {     
-      if(TDC.ID[n] == 12 && TDC.ChNum[n]==0) {
-	RFTime = (Int_t)TDC.Data[n];
-	if(RFTime > 0) {
+  RFTime = 0;
+  MCPTime = 0;
+  //no TOF without both RF and MCP; otherwise the TOF of the previous event of this thread would be kept
+  TOFTime = TOFcTime = TOFwTime = 0;
+
+  Double_t slope=0.9861; //slope of MCP vs RF
+  Double_t offset=271.56; //peak-to-peak spacing
+  Double_t wrap=offset*2;
+  Double_t TOF,TOFc,TOFw;
+  Int_t tbins=600;
+
+  for (Int_t n=0; n<TDC.Nhits; n++) {     
+    if(TDC.ID[n] == 12 && TDC.ChNum[n]==0) {
+      RFTime = (Int_t)TDC.Data[n];
+      if(RFTime > 0) {
 #ifdef Time_hists	  
-	  MyFill("Time_RF",1028,0,4096,RFTime);
+	fh.Fill(hTime_RF(),1028,0,4096,RFTime);
 #endif
-	}
       }
-      if(TDC.ID[n] == 12 && TDC.ChNum[n]==7) {
-	MCPTime = (Int_t)TDC.Data[n];
-	if(MCPTime >0) {
+    }
+    if(TDC.ID[n] == 12 && TDC.ChNum[n]==7) {
+      MCPTime = (Int_t)TDC.Data[n];
+      if(MCPTime >0) {
 #ifdef Time_hists
-	  MyFill("Time_MCP",1028,0,4096,MCPTime);
+	fh.Fill(hTime_MCP(),1028,0,4096,MCPTime);
 #endif
-	}
       }
     }
-    if(RFTime >0 && MCPTime >0) {
-      TOF=MCPTime-RFTime;//Time-of-flight
-      TOFTime=TOF;
-      TOFc=MCPTime-slope*RFTime;//corrected TOF
-      TOFcTime=TOFc;
-      TOFw=fmod(TOFc+4*offset,offset);//wrapped TOF
-      TOFwTime=TOFw;
+  }
+  if(RFTime >0 && MCPTime >0) {
+    TOF=MCPTime-RFTime;//Time-of-flight
+    TOFTime=TOF;
+    TOFc=MCPTime-slope*RFTime;//corrected TOF
+    TOFcTime=TOFc;
+    TOFw=fmod(TOFc+4*offset,offset);//wrapped TOF
+    TOFwTime=TOFw;
 #ifdef Time_hists
-      MyFill("Time_MCP_vs_RF",512,0,4096,RFTime,512,0,4096,MCPTime);
-      MyFill("TOF_vs_RF",512,0,4096,RFTime,512,-4096,4096,TOF);
-      MyFill("TOFc_vs_RF",512,0,4096,RFTime,512,-4096,4096,TOFc);      
-      MyFill("TOFc",tbins*2,-4096,4096,TOFc);
-      MyFill("TOFw",tbins,0,300,TOFw);
-      MyFill("TOFw2",tbins,0,600,fmod(TOFc+4*offset,wrap));//wrapped TOF
-#endif
-	//=========================== MCP - RF Gate =================================================
+    fh.Fill(hTime_MCP_vs_RF(),512,0,4096,RFTime,512,0,4096,MCPTime);
+    fh.Fill(hTOF_vs_RF(),512,0,4096,RFTime,512,-4096,4096,TOF);
+    fh.Fill(hTOFc_vs_RF(),512,0,4096,RFTime,512,-4096,4096,TOFc);      
+    fh.Fill(hTOFc(),tbins*2,-4096,4096,TOFc);
+    fh.Fill(hTOFw(),tbins,0,300,TOFw);
+    fh.Fill(hTOFw2(),tbins,0,600,fmod(TOFc+4*offset,wrap));//wrapped TOF
+#endif
+      //=========================== MCP - RF Gate =================================================
 #ifdef MCP_RF_Cut    
-      if(TOFw>100 && TOFw<offset) {//inside gate; keep
+    if(TOFw>100 && TOFw<offset) {//inside gate; keep
 #ifdef Time_hists
-	MyFill("TOF_wrapped_in",tbins,0,300,TOFw);
+      fh.Fill(hTOF_wrapped_in(),tbins,0,300,TOFw);
 #endif
-      }
-      else {//outside gate; exclude
+    }
+    else {//outside gate; exclude
 #ifdef Time_hists
-	MyFill("TOF_wrapped_out",tbins,0,300,TOFw);
+      fh.Fill(hTOF_wrapped_out(),tbins,0,300,TOFw);
 #endif
-	continue;
-      }
+      return kFALSE;
     }
-    else {//bad time; exclude
-      continue;
+  }
+  else {//bad time; exclude
+    return kFALSE;
 #endif
-    }
-    
+  }
+
 #ifdef IC_hists       
-    //------------Ion Chamber----------------------
-    IC_dE = 0; IC_E = 0;
-    for(Int_t n=0; n<ADC.Nhits; n++) {
-      if(ADC.ID[n]==3 && ADC.ChNum[n]==24) {
-	IC_dE = ADC.Data[n];
-	if(IC_dE >0)
-	  MyFill("IC_dE",1028,0,4096,IC_dE);
-      }
-      if(ADC.ID[n]==3 && ADC.ChNum[n]==28) {
-	IC_E = (Int_t)ADC.Data[n];
-	if(IC_E >0) {
-	  MyFill("IC_E",1028,0,4096,IC_E);
-	  if(RFTime >0 && MCPTime >0) {
-	    MyFill("IC_TOF_vs_ESi",512,0,4096,IC_E,512,0,4096,TOF);
-	    MyFill("IC_TOFc_vs_ESi",512,0,4096,IC_E,512,0,4096,TOFc);
-	  }
+  //------------Ion Chamber----------------------
+  IC_dE = 0; IC_E = 0;
+  for(Int_t n=0; n<ADC.Nhits; n++) {
+    if(ADC.ID[n]==3 && ADC.ChNum[n]==24) {
+      IC_dE = ADC.Data[n];
+      if(IC_dE >0)
+	fh.Fill(hIC_dE(),1028,0,4096,IC_dE);
+    }
+    if(ADC.ID[n]==3 && ADC.ChNum[n]==28) {
+      IC_E = (Int_t)ADC.Data[n];
+      if(IC_E >0) {
+	fh.Fill(hIC_E(),1028,0,4096,IC_E);
+	if(RFTime >0 && MCPTime >0) {
+	  fh.Fill(hIC_TOF_vs_ESi(),512,0,4096,IC_E,512,0,4096,TOF);
+	  fh.Fill(hIC_TOFc_vs_ESi(),512,0,4096,IC_E,512,0,4096,TOFc);
 	}
       }
     }
-    if(IC_dE >0 && IC_E >0)
-      MyFill("IC_EdE",512,0,4096,IC_E,512,0,4096,IC_dE);
-    
+  }
+  if(IC_dE >0 && IC_E >0)
+    fh.Fill(hIC_EdE(),512,0,4096,IC_E,512,0,4096,IC_dE);
+
 #ifdef IC_cut
-    char* file_cut1 = "/home/lighthall/anasen/root/main/17F_cut.root";
-    TFile *cut_file1 = new TFile(file_cut1);
-    if (!cut_file1->IsOpen()){
-      cout << "Cut file1: " << file_cut1 << " could not be opened.\n";
-      exit(EXIT_FAILURE);
-    }
-    TCutG *cut1 = NULL;
-    cut1 = (TCutG*)cut_file1->Get("CUTG");
-    
-    if (cut1 == NULL){
-      cout << "cut1 does not exist\n";
-      exit(EXIT_FAILURE);
-    }
+  //ICCut: the E-dE cut of the ion chamber, read once in main()
 #endif
 #endif     
-    
-    /////////////////////////////////////////////  ASICS Section //////////////////////////////////////////////////////
-    // ==========================  ASICS  variables are initialized here ====================
-
-    Si.zeroSiHit();  
-
-    for (int i=0; i<NumQ3; i++){
-      for (int j=0; j<MaxQ3Ch; j++){
-	Q3Energy[i][j] = 0;
-	Q3Energy_Pulser[i][j] = 0;
-	Q3Energy_Rel[i][j] = 0;
-	Q3Energy_Cal[i][j] = 0;
-	Q3Time[i][j] = 0;
-      }
-    }
-    for (int i=0; i<NumSX3; i++){
-      for (int j=0; j<MaxSX3Ch; j++){
-	SX3Energy[i][j] = 0;
-	SX3Energy_Pulser[i][j] = 0;
-	SX3Energy_Rel[i][j] = 0;
-	SX3Energy_Cal[i][j] = 0;
-	SX3Time[i][j] = 0;
-      }
-    }
-    //////////////////////////////////////////////  Fill ASICS  ///////////////////////////////////////////////////////
 
-    // Make sure there are not too many hits.
-    if (Si_Old.Nhits>MaxSiHits) Si_Old.Nhits=MaxSiHits;
+  /////////////////////////////////////////////  ASICS Section //////////////////////////////////////////////////////
+  // ==========================  ASICS  variables are initialized here ====================
 
-    for (Int_t n=0; n<Si_Old.Nhits; n++){//loop over all Si hits--very similar to Main.C from Jeff
-      ZeroShift  = 0;
-      VperCh     = 1;
-      //p0_coeff = 0;
-      //p1_coeff = 0;
-      //p2_coeff = 1;
-      //x0_offset = 0;
+  Si.zeroSiHit();  
 
-      Gain_Rel  = 1;
-      Gain_Alpha = 1;
-      FinalShift = 0;    
+  //The Q3 and SX3 arrays are not reset: only the channels set in Q3Fired and SX3Fired, all
+  //written by this event, are read below.
+  Q3Fired.Clear();
+  SX3Fired.Clear();
+  //////////////////////////////////////////////  Fill ASICS  ///////////////////////////////////////////////////////
 
-      CMAP->IdentifyDetChan(Si_Old.MBID[n],Si_Old.CBID[n],Si_Old.ChNum[n], DN, DetCh);
-      CMAP->AlignASICsChannels(Si_Old.MBID[n],Si_Old.CBID[n],Si_Old.ChNum[n], ZeroShift, VperCh);
-      
-      //added by M.Anastasiou
-      //CMAP->AlignASICsChannels_Quadratic(Si_Old.MBID[n],Si_Old.CBID[n],Si_Old.ChNum[n], p2_coeff, p1_coeff, p0_coeff, x0_offset);
+  // Make sure there are not too many hits.
+  if (Si_Old.Nhits>MaxSiHits) Si_Old.Nhits=MaxSiHits;
 
-      //Check the Detector Numbers
-      if(DN<0 || DN>27){continue;}
+  for (Int_t n=0; n<Si_Old.Nhits; n++){//loop over all Si hits--very similar to Main.C from Jeff
+    ZeroShift  = 0;
+    VperCh     = 1;
 
-     
+    Gain_Rel  = 1;
+    Gain_Alpha = 1;
+    FinalShift = 0;    
+
+    //IdentifyDetChan and AlignASICsChannels in one lookup
+    CMAP->IdentifySiChannel(Si_Old.MBID[n],Si_Old.CBID[n],Si_Old.ChNum[n], DN, DetCh, ZeroShift, VperCh);
+
+    //Check the Detector Numbers
+    if(DN<0 || DN>27){continue;}
+
+    //All the calibration steps of the channel, collected by ChannelMap (pulser alignment,
+    //linear or quadratic, relative gain, final shift, alpha gain). NULL for channels that
+    //are not in the channel map, which keep the detector channel of the previous hit in the event.
+    const SiCalibration* SiCal = CMAP->GetSiCalibration(Si_Old.MBID[n],Si_Old.CBID[n],Si_Old.ChNum[n]);
+    Double_t ERaw = (Double_t)Si_Old.Energy[n];
+    Double_t EPulser = 0, ERel = 0, ECal = 0;
+    if (SiCal) {
+#if defined(FillTree_Esteps) || defined(Hist_for_Si_Cal)
+      SiCal->Steps(ERaw,EPulser,ERel,ECal);
+#else
+      ECal = SiCal->Energy(ERaw);
+#endif
+    }
+    else {
       if(DN>3){ //For SX3's
 	CMAP->GetSX3MeVPerChannel1(DN,DetCh,Gain_Rel);  
 	CMAP->GetSX3MeVPerChannel2(DN,DetCh,Gain_Alpha);  
 	CMAP->GetSX3FinalEnergyOffsetInMeV(DN,DetCh,FinalShift);
-
-	SX3Energy[DN-4][DetCh] = (Double_t)Si_Old.Energy[n];
-	SX3Energy_Pulser[DN-4][DetCh] = SX3Energy[DN-4][DetCh]+ZeroShift/VperCh;
-	//SX3Energy_Pulser[DN-4][DetCh] = SX3Energy[DN-4][DetCh]*VperCh+ZeroShift;   //pulser CHECK
-
-	//in case of quadratic fit
-	//SX3Energy_Pulser[DN-4][DetCh] = p2_coeff*(pow(SX3Energy[DN-4][DetCh],2)) + p1_coeff*SX3Energy[DN-4][DetCh] + p0_coeff;
-	
-	SX3Energy_Rel[DN-4][DetCh] = SX3Energy_Pulser[DN-4][DetCh]*Gain_Rel;
-	SX3Energy_Rel[DN-4][DetCh] += FinalShift;
-	SX3Energy_Cal[DN-4][DetCh] = SX3Energy_Rel[DN-4][DetCh]*Gain_Alpha;
-
-	SX3Time[DN-4][DetCh]   = (Double_t)Si_Old.Time[n];
-
       }else{ //For Q3's
 	CMAP->GetQ3MeVPerChannel1(DN,DetCh,Gain_Rel);
 	CMAP->GetQ3MeVPerChannel2(DN,DetCh,Gain_Alpha);
 	CMAP->GetQ3FinalEnergyOffsetInMeV(DN,DetCh,FinalShift);
+      }
+      EPulser = ERaw+ZeroShift/VperCh;
+      ERel = EPulser*Gain_Rel;
+      ERel += FinalShift;
+      ECal = ERel*Gain_Alpha;
+    }
 
-	Q3Energy[DN][DetCh] = (Double_t)Si_Old.Energy[n];
-	Q3Energy_Pulser[DN][DetCh] = Q3Energy[DN][DetCh] + ZeroShift/VperCh;
-	//Q3Energy_Pulser[DN][DetCh] = Q3Energy[DN][DetCh]*VperCh + ZeroShift;
-
-	//in case of quadratic fit
-	//Q3Energy_Pulser[DN][DetCh] = p2_coeff*(pow(Q3Energy[DN][DetCh],2)) + p1_coeff*Q3Energy[DN][DetCh] + p0_coeff;
+    if(DN>3){ //For SX3's
+      SX3Energy[DN-4][DetCh] = ERaw;
+      SX3Energy_Pulser[DN-4][DetCh] = EPulser;
+      SX3Energy_Rel[DN-4][DetCh] = ERel;
+      SX3Energy_Cal[DN-4][DetCh] = ECal;
+
+      SX3Time[DN-4][DetCh]   = (Double_t)Si_Old.Time[n];
+      SX3Fired.Set(DN-4,DetCh);
+
+    }else{ //For Q3's
+      Q3Energy[DN][DetCh] = ERaw;
+      Q3Energy_Pulser[DN][DetCh] = EPulser;
+      Q3Energy_Rel[DN][DetCh] = ERel;
+      Q3Energy_Cal[DN][DetCh] = ECal;
+      Q3Time[DN][DetCh] = (Double_t)Si_Old.Time[n];
+      Q3Fired.Set(DN,DetCh);
+    }
+  }// End loop over Si_Nhits-----------------------------------------------------------------------------------------------
+  //////////////////////////////////////////// Push back SX3 Detector-members///////////////////////////////////////////////
 
-	Q3Energy_Rel[DN][DetCh] = Q3Energy_Pulser[DN][DetCh]*Gain_Rel;
-	Q3Energy_Rel[DN][DetCh] += FinalShift;
-	Q3Energy_Cal[DN][DetCh] = Q3Energy_Rel[DN][DetCh]*Gain_Alpha;
-	Q3Time[DN][DetCh] = (Double_t)Si_Old.Time[n];
-      }
-    }// End loop over Si_Nhits-----------------------------------------------------------------------------------------------
-    //////////////////////////////////////////// Push back SX3 Detector-members///////////////////////////////////////////////
+  //Detectors and channels with a hit, in ascending order as for(i<NumSX3) for(j<MaxSX3Ch)
+  for (UInt_t dets=SX3Fired.Detectors(); dets; dets &= dets-1){
+    int i = SX3Fired.Lowest(dets);
 
-    for (int i=0; i<NumSX3; i++){
-     
-      Si.ZeroSi_obj();
+    Si.ZeroSi_obj();
 
-      for (int j=0; j<MaxSX3Ch; j++){
+    for (UInt_t chs=SX3Fired.Channels(i); chs; chs &= chs-1){
+      int j = SX3Fired.Lowest(chs);
 
-	if ( (SX3Energy_Cal[i][j] > Si_E_threshold)) {
+      if ( (SX3Energy_Cal[i][j] > Si_E_threshold)) {
 
-	  if (j<4){//SX3 Back
+	if (j<4){//SX3 Back
 
-	    Si.det_obj.BackChNum.push_back(j);
+	  Si.det_obj.BackChNum.push_back(j);
 #if defined(FillTree_Esteps) || defined(Hist_for_Si_Cal)
-	    Si.det_obj.EBack_Raw.push_back(SX3Energy[i][j]);
-	    Si.det_obj.EBack_Pulser.push_back(SX3Energy_Pulser[i][j]);
-	    Si.det_obj.EBack_Rel.push_back(SX3Energy_Rel[i][j]);
+	  Si.det_obj.EBack_Raw.push_back(SX3Energy[i][j]);
+	  Si.det_obj.EBack_Pulser.push_back(SX3Energy_Pulser[i][j]);
+	  Si.det_obj.EBack_Rel.push_back(SX3Energy_Rel[i][j]);
 #endif	   
-	    Si.det_obj.EBack_Cal.push_back(SX3Energy_Cal[i][j]);
-	    Si.det_obj.TBack.push_back(SX3Time[i][j]);	
+	  Si.det_obj.EBack_Cal.push_back(SX3Energy_Cal[i][j]);
+	  Si.det_obj.TBack.push_back(SX3Time[i][j]);	
 
 
-	    //Calculate && push back SX3_ZUp & SX3_ZDown
-	    /* if(SX3Energy_Cal[i][j+4]>0){
-	      Si.det_obj.SX3_ZUp.push_back(1-(2*SX3Energy_Cal[i][j+4]/SX3Energy_Cal[i][j]));
-	    }else if(SX3Energy_Cal[i][j+8]>0){	  
-	      Si.det_obj.SX3_ZDown.push_back((2*SX3Energy_Cal[i][j+8]/SX3Energy_Cal[i][j])-1);	         
-	    }else{
-	      break;
-	      }*/
+	  //Calculate && push back SX3_ZUp & SX3_ZDown
+	  /* if(SX3Energy_Cal[i][j+4]>0){
+	    Si.det_obj.SX3_ZUp.push_back(1-(2*SX3Energy_Cal[i][j+4]/SX3Energy_Cal[i][j]));
+	  }else if(SX3Energy_Cal[i][j+8]>0){	  
+	    Si.det_obj.SX3_ZDown.push_back((2*SX3Energy_Cal[i][j+8]/SX3Energy_Cal[i][j])-1);	         
+	  }else{
+	    break;
+	    }*/
 
-	  }else if(j>3 && j<8){//SX3 Front Up
-	    Si.det_obj.UpChNum.push_back(j-4);
+	}else if(j>3 && j<8){//SX3 Front Up
+	  Si.det_obj.UpChNum.push_back(j-4);
 #if defined(FillTree_Esteps) || defined(Hist_for_Si_Cal)
-	    Si.det_obj.EUp_Raw.push_back(SX3Energy[i][j]);
-	    Si.det_obj.EUp_Pulser.push_back(SX3Energy_Pulser[i][j]);
-	    Si.det_obj.EUp_Rel.push_back(SX3Energy_Rel[i][j]);
+	  Si.det_obj.EUp_Raw.push_back(SX3Energy[i][j]);
+	  Si.det_obj.EUp_Pulser.push_back(SX3Energy_Pulser[i][j]);
+	  Si.det_obj.EUp_Rel.push_back(SX3Energy_Rel[i][j]);
 #endif	  	   
-	    Si.det_obj.EUp_Cal.push_back(SX3Energy_Cal[i][j]);
-	    Si.det_obj.TUp.push_back(SX3Time[i][j]);
+	  Si.det_obj.EUp_Cal.push_back(SX3Energy_Cal[i][j]);
+	  Si.det_obj.TUp.push_back(SX3Time[i][j]);
 
-	  }else if(j>7 && j<12){//SX3 Front Down
-	    Si.det_obj.DownChNum.push_back(j-8);
+	}else if(j>7 && j<12){//SX3 Front Down
+	  Si.det_obj.DownChNum.push_back(j-8);
 #if defined(FillTree_Esteps) || defined(Hist_for_Si_Cal)
-	    Si.det_obj.EDown_Raw.push_back(SX3Energy[i][j]);
-	    Si.det_obj.EDown_Pulser.push_back(SX3Energy_Pulser[i][j]);
-	    Si.det_obj.EDown_Rel.push_back(SX3Energy_Rel[i][j]);
-#endif
-	    Si.det_obj.EDown_Cal.push_back(SX3Energy_Cal[i][j]);
-	    Si.det_obj.TDown.push_back(SX3Time[i][j]);
-	  }
-	}	
-	//===========================================
-      }//end of for (int j=0; j<MaxSX3Ch; j++){
-      //=========================================== 
+	  Si.det_obj.EDown_Raw.push_back(SX3Energy[i][j]);
+	  Si.det_obj.EDown_Pulser.push_back(SX3Energy_Pulser[i][j]);
+	  Si.det_obj.EDown_Rel.push_back(SX3Energy_Rel[i][j]);
+#endif
+	  Si.det_obj.EDown_Cal.push_back(SX3Energy_Cal[i][j]);
+	  Si.det_obj.TDown.push_back(SX3Time[i][j]);
+	}
+      }	
+      //===========================================
+    }//end of loop over the SX3 channels with a hit
+    //=========================================== 
 
-      /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-      if ( (Si.det_obj.EDown_Cal.size()!=0 || Si.det_obj.EUp_Cal.size()!=0) && Si.det_obj.EBack_Cal.size()!=0 ) {
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    if ( (Si.det_obj.EDown_Cal.size()!=0 || Si.det_obj.EUp_Cal.size()!=0) && Si.det_obj.EBack_Cal.size()!=0 ) {
+
+      Si.det_obj.UpMult = Si.det_obj.EUp_Cal.size();
+      Si.det_obj.DownMult = Si.det_obj.EDown_Cal.size();
+      Si.det_obj.BackMult = Si.det_obj.EBack_Cal.size();
+      Si.det_obj.DetID = i+4;
+
+      Si.det_obj.HitType = Si.det_obj.BackMult*100 + Si.det_obj.UpMult*10 + Si.det_obj.DownMult;
 
-	Si.det_obj.UpMult = Si.det_obj.EUp_Cal.size();
-	Si.det_obj.DownMult = Si.det_obj.EDown_Cal.size();
-	Si.det_obj.BackMult = Si.det_obj.EBack_Cal.size();
-	Si.det_obj.DetID = i+4;
+      SiSort.SortSX3(&Si,CMAP);
+      Si.Detector.push_back(Si.det_obj);
 
-	Si.det_obj.HitType = Si.det_obj.BackMult*100 + Si.det_obj.UpMult*10 + Si.det_obj.DownMult;
-		
-	SiSort.SortSX3(&Si,CMAP);
-	Si.Detector.push_back(Si.det_obj);
-	
 
-	//////////////////////////////////////////// Fill SX3 Histograms after Calibration////////////////////////////////////////////
+      //////////////////////////////////////////// Fill SX3 Histograms after Calibration////////////////////////////////////////////
 #ifdef Hist_after_Cal
-	MyFill(Form("back_vs_front_Cal%i",Si.hit_obj.DetID),500,0,30,Si.hit_obj.EnergyFront,500,0,30,Si.hit_obj.EnergyBack);
-	//MyFill(Form("back_vs_front_Cal%i_f%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
-	//MyFill(Form("back_vs_front_Cal%i_b%i",Si.hit_obj.DetID,Si.hit_obj.BackChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
-	//MyFill(Form("back_vs_front_Cal%i_%i_%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
-	if(Si.det_obj.HitType ==111){//Requires both Up and Down signal	
-	  MyFill(Form("sx3offset_back_vs_front_Cal%i",Si.hit_obj.DetID),960,0,30,Si.hit_obj.EnergyBack,640,-10,10,(Si.hit_obj.EnergyBack-Si.hit_obj.EnergyFront));
-	  //MyFill(Form("down_vs_up_Cal%i",Si.det_obj.DetID),100,0,30,Si.det_obj.EUp_Cal[0],100,0,30,Si.det_obj.EDown_Cal[0]);
-	  //MyFill(Form("down_vs_up_Cal%i_f%i",Si.det_obj.DetID,Si.det_obj.UpChNum[0]),100,0,30,Si.det_obj.EUp_Cal[0],100,0,30,Si.det_obj.EDown_Cal[0]);
-	}
+      fh.Fill(hback_vs_front_CalN(Si.hit_obj.DetID),500,0,30,Si.hit_obj.EnergyFront,500,0,30,Si.hit_obj.EnergyBack);
+      //MyFill(Form("back_vs_front_Cal%i_f%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
+      //MyFill(Form("back_vs_front_Cal%i_b%i",Si.hit_obj.DetID,Si.hit_obj.BackChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
+      //MyFill(Form("back_vs_front_Cal%i_%i_%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
+      if(Si.det_obj.HitType ==111){//Requires both Up and Down signal	
+	fh.Fill(hsx3offset_back_vs_front_CalN(Si.hit_obj.DetID),960,0,30,Si.hit_obj.EnergyBack,640,-10,10,(Si.hit_obj.EnergyBack-Si.hit_obj.EnergyFront));
+	//MyFill(Form("down_vs_up_Cal%i",Si.det_obj.DetID),100,0,30,Si.det_obj.EUp_Cal[0],100,0,30,Si.det_obj.EDown_Cal[0]);
+	//MyFill(Form("down_vs_up_Cal%i_f%i",Si.det_obj.DetID,Si.det_obj.UpChNum[0]),100,0,30,Si.det_obj.EUp_Cal[0],100,0,30,Si.det_obj.EDown_Cal[0]);
+      }
 #endif
-	//////////////////////////////////////////// Fill SX3 Histograms for Calibration////////////////////////////////////////////
+      //////////////////////////////////////////// Fill SX3 Histograms for Calibration////////////////////////////////////////////
 #ifdef Hist_for_Si_Cal
-	Int_t udmax=4*4096/3;
-	Int_t fbmax=4*4096/3;
-	Int_t bins=512;
-	if(Si.det_obj.HitType ==111) {//Requires both Up and Down signal	----- Down vs Up histo needs it //Back vs front will be simpler
-
-	  // Step 1 RelCal/U-D, all energies changed to E_Rel
-	  MyFill(Form("down_vs_up%i_%i_%i",Si.det_obj.DetID,Si.det_obj.UpChNum[0],Si.det_obj.BackChNum[0]),
-		 bins,0,udmax, Si.det_obj.EUp_Rel[0],bins,0,udmax,Si.det_obj.EDown_Rel[0]);
-	  MyFill(Form("down_vs_up_divB%i_%i_%i",Si.det_obj.DetID,Si.det_obj.UpChNum[0],Si.det_obj.BackChNum[0]),
-		 bins,0,1.3, Si.det_obj.EUp_Rel[0]/Si.det_obj.EBack_Rel[0],
-		 bins,0,1.3,Si.det_obj.EDown_Rel[0]/Si.det_obj.EBack_Rel[0]);
-	  MyFill(Form("down_vs_up%i_f%i",Si.det_obj.DetID,Si.det_obj.UpChNum[0]),
-		 bins,0,udmax, Si.det_obj.EUp_Rel[0],bins,0,udmax,Si.det_obj.EDown_Rel[0]);
-	  MyFill(Form("down_vs_up_divB%i_f%i",Si.det_obj.DetID,Si.det_obj.UpChNum[0]),
-		 bins,0,1.3,(Si.det_obj.EUp_Rel[0]/Si.det_obj.EBack_Rel[0]),
-		 bins,0,1.3,(Si.det_obj.EDown_Rel[0]/Si.det_obj.EBack_Rel[0]));
-
-	  // Step 2 RelCal//F-B //Condition: RelGain Cal from Up-Down is applied
-	  MyFill(Form("back_vs_front%i_%i_%i",Si.det_obj.DetID,Si.det_obj.UpChNum[0],Si.det_obj.BackChNum[0]),
-		 bins,0,fbmax,Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0],
-		 bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
-
-	  // Step 3 RelCal//F-B //RelGain Cal from Step 2 is applied
-	  MyFill(Form("back_vs_front%i_b%i",Si.det_obj.DetID,Si.det_obj.BackChNum[0]),bins,0,fbmax,Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
-	  
-	  //// just for checking histograms per detector
-	  MyFill(Form("back_vs_front%i",Si.det_obj.DetID),bins,0,fbmax,Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
-	  MyFill(Form("down_vs_up%i",Si.det_obj.DetID),600,0,6000,Si.det_obj.EUp_Rel[0],600,0,6000,Si.det_obj.EDown_Rel[0]);
-	  Int_t obins=300;
-	  Int_t omax=400;
-	  
-	  // check offset
-  	  //MyFill(Form("front_vs_offset%i",Si.det_obj.DetID),
-	  // 	 obins,-omax,omax,(Si.det_obj.EBack_Rel[0]-(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0])),
-	  // 	 bins,0,fbmax,Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0]
-	  // 	 );
-	  
-	  MyFill(Form("back_vs_offset_divB%i",Si.det_obj.DetID),
-		 obins,-0.2,0.2,((Si.det_obj.EBack_Rel[0]-(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0]))/Si.det_obj.EBack_Rel[0]),
-		 bins,0,fbmax,Si.det_obj.EBack_Rel[0]
-		 );
-
-	  MyFill(Form("back_vs_offset%i_%i_%i",Si.det_obj.DetID,Si.det_obj.UpChNum[0],Si.det_obj.BackChNum[0]),
-		 obins,-omax,omax,(Si.det_obj.EBack_Rel[0]-(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0])),
-		 bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
-	  
-	  MyFill(Form("back_vs_offset%i" ,Si.det_obj.DetID),
-		 obins,-omax,omax,(Si.det_obj.EBack_Rel[0]-(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0])),
-		 bins,0,fbmax,Si.det_obj.EBack_Rel[0]
-		 );
-
-	  // position
-	  //MyFill(Form("back_vs_pos2%i",Si.det_obj.DetID),//position over [-1,1]
-	  // 	 obins,-1,1,(Si.det_obj.EDown_Rel[0]-Si.det_obj.EUp_Rel[0])/Si.det_obj.EBack_Rel[0],
-	  // 	 //obins,-1,1,(Si.det_obj.EDown_Rel[0]-Si.det_obj.EUp_Rel[0])/(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0])
-	  // 	 bins,0,fbmax,Si.det_obj.EBack_Rel[0]
-	  // 	 );
-
-	  MyFill(Form("back_vs_pos%i",Si.det_obj.DetID),//position over [0,1]
-		 obins,-0.1,1.1,(1./2)*(1+(Si.det_obj.EDown_Rel[0]-Si.det_obj.EUp_Rel[0])/Si.det_obj.EBack_Rel[0]),
-		 bins,0,fbmax,Si.det_obj.EBack_Rel[0]
-		 );
-	}  
+      Int_t udmax=4*4096/3;
+      Int_t fbmax=4*4096/3;
+      Int_t bins=512;
+      if(Si.det_obj.HitType ==111) {//Requires both Up and Down signal	----- Down vs Up histo needs it //Back vs front will be simpler
+
+	// Step 1 RelCal/U-D, all energies changed to E_Rel
+	fh.Fill(hdown_vs_upN_N_N(Si.det_obj.DetID,Si.det_obj.UpChNum[0],Si.det_obj.BackChNum[0]),
+	       bins,0,udmax, Si.det_obj.EUp_Rel[0],bins,0,udmax,Si.det_obj.EDown_Rel[0]);
+	fh.Fill(hdown_vs_up_divBN_N_N(Si.det_obj.DetID,Si.det_obj.UpChNum[0],Si.det_obj.BackChNum[0]),
+	       bins,0,1.3, Si.det_obj.EUp_Rel[0]/Si.det_obj.EBack_Rel[0],
+	       bins,0,1.3,Si.det_obj.EDown_Rel[0]/Si.det_obj.EBack_Rel[0]);
+	fh.Fill(hdown_vs_upN_fN(Si.det_obj.DetID,Si.det_obj.UpChNum[0]),
+	       bins,0,udmax, Si.det_obj.EUp_Rel[0],bins,0,udmax,Si.det_obj.EDown_Rel[0]);
+	fh.Fill(hdown_vs_up_divBN_fN(Si.det_obj.DetID,Si.det_obj.UpChNum[0]),
+	       bins,0,1.3,(Si.det_obj.EUp_Rel[0]/Si.det_obj.EBack_Rel[0]),
+	       bins,0,1.3,(Si.det_obj.EDown_Rel[0]/Si.det_obj.EBack_Rel[0]));
+
+	// Step 2 RelCal//F-B //Condition: RelGain Cal from Up-Down is applied
+	fh.Fill(hback_vs_frontN_N_N(Si.det_obj.DetID,Si.det_obj.UpChNum[0],Si.det_obj.BackChNum[0]),
+	       bins,0,fbmax,Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0],
+	       bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
+
+	// Step 3 RelCal//F-B //RelGain Cal from Step 2 is applied
+	fh.Fill(hback_vs_frontN_bN(Si.det_obj.DetID,Si.det_obj.BackChNum[0]),bins,0,fbmax,Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
+
+	//// just for checking histograms per detector
+	fh.Fill(hback_vs_frontN(Si.det_obj.DetID),bins,0,fbmax,Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
+	fh.Fill(hdown_vs_upN(Si.det_obj.DetID),600,0,6000,Si.det_obj.EUp_Rel[0],600,0,6000,Si.det_obj.EDown_Rel[0]);
+	Int_t obins=300;
+	Int_t omax=400;
+
+	// check offset
+	//MyFill(Form("front_vs_offset%i",Si.det_obj.DetID),
+	// 	 obins,-omax,omax,(Si.det_obj.EBack_Rel[0]-(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0])),
+	// 	 bins,0,fbmax,Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0]
+	// 	 );
+
+	fh.Fill(hback_vs_offset_divBN(Si.det_obj.DetID),
+	       obins,-0.2,0.2,((Si.det_obj.EBack_Rel[0]-(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0]))/Si.det_obj.EBack_Rel[0]),
+	       bins,0,fbmax,Si.det_obj.EBack_Rel[0]
+	       );
+
+	fh.Fill(hback_vs_offsetN_N_N(Si.det_obj.DetID,Si.det_obj.UpChNum[0],Si.det_obj.BackChNum[0]),
+	       obins,-omax,omax,(Si.det_obj.EBack_Rel[0]-(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0])),
+	       bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
+
+	fh.Fill(hback_vs_offsetN(Si.det_obj.DetID),
+	       obins,-omax,omax,(Si.det_obj.EBack_Rel[0]-(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0])),
+	       bins,0,fbmax,Si.det_obj.EBack_Rel[0]
+	       );
+
+	// position
+	//MyFill(Form("back_vs_pos2%i",Si.det_obj.DetID),//position over [-1,1]
+	// 	 obins,-1,1,(Si.det_obj.EDown_Rel[0]-Si.det_obj.EUp_Rel[0])/Si.det_obj.EBack_Rel[0],
+	// 	 //obins,-1,1,(Si.det_obj.EDown_Rel[0]-Si.det_obj.EUp_Rel[0])/(Si.det_obj.EUp_Rel[0]+Si.det_obj.EDown_Rel[0])
+	// 	 bins,0,fbmax,Si.det_obj.EBack_Rel[0]
+	// 	 );
+
+	fh.Fill(hback_vs_posN(Si.det_obj.DetID),//position over [0,1]
+	       obins,-0.1,1.1,(1./2)*(1+(Si.det_obj.EDown_Rel[0]-Si.det_obj.EUp_Rel[0])/Si.det_obj.EBack_Rel[0]),
+	       bins,0,fbmax,Si.det_obj.EBack_Rel[0]
+	       );
+      }  
 #endif	 	  
-	//////////////////////////////////////////// Fill SX3 Histograms for Z-Position Calibration//////////////////////////////////
+      //////////////////////////////////////////// Fill SX3 Histograms for Z-Position Calibration//////////////////////////////////
 #ifdef ZPosCal
-	///////////////////  ZPos from the raw data from the Detector  ///////////////////
-	// if(Si.det_obj.HitType == 111 && Si.det_obj.EUp_Cal[0] > 0) {//Requires both Up and Down signal 
-		if(Si.hit_obj.ZUp <= 1.0 && Si.hit_obj.ZUp >= -1.0 ) {
-	  MyFill(Form("SX3Zpos_%i_%i_%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),600,-1,1,Si.hit_obj.ZUp);
-	  MyFill(Form("SX3Zpos_%i_f%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel),600,-1,1,Si.hit_obj.ZUp);	 
-	  MyFill(Form("SX3Zpos_%i",Si.hit_obj.DetID),600,-1,1,Si.hit_obj.ZUp);
-	}
-	if(Si.hit_obj.ZDown <= 1.0 && Si.hit_obj.ZDown >= -1.0 ) {
-	  MyFill(Form("SX3Zpos_%i_%i_%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),600,-1,1,Si.hit_obj.ZDown);
-	  MyFill(Form("SX3Zpos_%i_f%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel),600,-1,1,Si.hit_obj.ZDown);
-	  MyFill(Form("SX3Zpos_%i",Si.hit_obj.DetID),600,-1,1,Si.hit_obj.ZDown);
-	}
-	// }	
-
-	/////////////////// ZPosCal from the Processed data from the Hit  ///////////////////
-	//if(Si.det_obj.HitType ==111 && Si.det_obj.EUp_Cal[0] > 0) {
-	if(Si.hit_obj.ZUpCal <= 7.5 && Si.hit_obj.ZUpCal >= 0 ) {
-	  MyFill(Form("SX3ZposCal_%i_%i_%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),600,-1,1,Si.hit_obj.ZUpCal);
-	  MyFill(Form("SX3ZposCal_%i_f%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel),600,-1,1,Si.hit_obj.ZUpCal);
-	  MyFill(Form("SX3ZposCal_%i",Si.hit_obj.DetID),600,-1,1,Si.hit_obj.ZUpCal);
-	}
-	if(Si.hit_obj.ZDownCal <= 7.5 && Si.hit_obj.ZDownCal >= 0 ) {
-	  MyFill(Form("SX3ZposCal_%i_%i_%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),600,-1,1,Si.hit_obj.ZDownCal);
-	  MyFill(Form("SX3ZposCal_%i_f%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel),600,-1,1,Si.hit_obj.ZDownCal);
-      	  MyFill(Form("SX3ZposCal_%i",Si.hit_obj.DetID),600,-1,1,Si.hit_obj.ZDownCal);
-	}
-	//}
+      ///////////////////  ZPos from the raw data from the Detector  ///////////////////
+      // if(Si.det_obj.HitType == 111 && Si.det_obj.EUp_Cal[0] > 0) {//Requires both Up and Down signal 
+	      if(Si.hit_obj.ZUp <= 1.0 && Si.hit_obj.ZUp >= -1.0 ) {
+	fh.Fill(hSX3Zpos_N_N_N(Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),600,-1,1,Si.hit_obj.ZUp);
+	fh.Fill(hSX3Zpos_N_fN(Si.hit_obj.DetID,Si.hit_obj.FrontChannel),600,-1,1,Si.hit_obj.ZUp);	 
+	fh.Fill(hSX3Zpos_N(Si.hit_obj.DetID),600,-1,1,Si.hit_obj.ZUp);
+      }
+      if(Si.hit_obj.ZDown <= 1.0 && Si.hit_obj.ZDown >= -1.0 ) {
+	fh.Fill(hSX3Zpos_N_N_N(Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),600,-1,1,Si.hit_obj.ZDown);
+	fh.Fill(hSX3Zpos_N_fN(Si.hit_obj.DetID,Si.hit_obj.FrontChannel),600,-1,1,Si.hit_obj.ZDown);
+	fh.Fill(hSX3Zpos_N(Si.hit_obj.DetID),600,-1,1,Si.hit_obj.ZDown);
+      }
+      // }	
+
+      /////////////////// ZPosCal from the Processed data from the Hit  ///////////////////
+      //if(Si.det_obj.HitType ==111 && Si.det_obj.EUp_Cal[0] > 0) {
+      if(Si.hit_obj.ZUpCal <= 7.5 && Si.hit_obj.ZUpCal >= 0 ) {
+	fh.Fill(hSX3ZposCal_N_N_N(Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),600,-1,1,Si.hit_obj.ZUpCal);
+	fh.Fill(hSX3ZposCal_N_fN(Si.hit_obj.DetID,Si.hit_obj.FrontChannel),600,-1,1,Si.hit_obj.ZUpCal);
+	fh.Fill(hSX3ZposCal_N(Si.hit_obj.DetID),600,-1,1,Si.hit_obj.ZUpCal);
+      }
+      if(Si.hit_obj.ZDownCal <= 7.5 && Si.hit_obj.ZDownCal >= 0 ) {
+	fh.Fill(hSX3ZposCal_N_N_N(Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),600,-1,1,Si.hit_obj.ZDownCal);
+	fh.Fill(hSX3ZposCal_N_fN(Si.hit_obj.DetID,Si.hit_obj.FrontChannel),600,-1,1,Si.hit_obj.ZDownCal);
+	fh.Fill(hSX3ZposCal_N(Si.hit_obj.DetID),600,-1,1,Si.hit_obj.ZDownCal);
+      }
+      //}
 #endif 		
-	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #ifdef Hist_for_PC_Cal	
-	for ( Int_t hits=0; hits<PC.NPCHits; hits++ ) {
-	  MyFill("PCPhi_vs_SiPhi_SX3",500,0,8,Si.hit_obj.PhiW,500,0,8,PC.Hit[hits].PhiW);
-	}
+      for ( Int_t hits=0; hits<PC.NPCHits; hits++ ) {
+	fh.Fill(hPCPhi_vs_SiPhi_SX3(),500,0,8,Si.hit_obj.PhiW,500,0,8,PC.Hit[hits].PhiW);
+      }
 #endif
-	
-      }//end ((down||up)&&back)
-      else if ( Si.det_obj.EUp_Cal.size()!=0 || Si.det_obj.EDown_Cal.size()!=0 || Si.det_obj.EBack_Cal.size()!=0 ) {
+
+    }//end ((down||up)&&back)
+    else if ( Si.det_obj.EUp_Cal.size()!=0 || Si.det_obj.EDown_Cal.size()!=0 || Si.det_obj.EBack_Cal.size()!=0 ) {
 #ifdef Pulser_ReRun
-	//if only either of Up, Down or Back is fired in SX3, continue, unless it is a pulser check
-	Si.det_obj.UpMult = Si.det_obj.EUp_Cal.size();
-	Si.det_obj.DownMult = Si.det_obj.EDown_Cal.size();
-	Si.det_obj.BackMult = Si.det_obj.EBack_Cal.size();
-	  
-	Si.det_obj.DetID = i+4;
-	Si.det_obj.HitType = Si.det_obj.BackMult*100 + Si.det_obj.UpMult*10 + Si.det_obj.DownMult;
-
-	Si.Detector.push_back(Si.det_obj);
-	Si.NSiHits++;
+      //if only either of Up, Down or Back is fired in SX3, continue, unless it is a pulser check
+      Si.det_obj.UpMult = Si.det_obj.EUp_Cal.size();
+      Si.det_obj.DownMult = Si.det_obj.EDown_Cal.size();
+      Si.det_obj.BackMult = Si.det_obj.EBack_Cal.size();
+
+      Si.det_obj.DetID = i+4;
+      Si.det_obj.HitType = Si.det_obj.BackMult*100 + Si.det_obj.UpMult*10 + Si.det_obj.DownMult;
+
+      Si.Detector.push_back(Si.det_obj);
+      Si.NSiHits++;
 #else
-	continue;
+      continue;
 #endif
-      }
+    }
 
-      //============================================================ 
-    }//end of for(int i=0; i<NumSX3; i++){
-    ////////////////////////////////////// Push back Q3 Detector-members ////////////////////////////////////////////////////
-    for (int i=0; i<NumQ3; i++){
+    //============================================================ 
+  }//end of loop over the SX3 detectors with a hit
+  ////////////////////////////////////// Push back Q3 Detector-members ////////////////////////////////////////////////////
+  for (UInt_t dets=Q3Fired.Detectors(); dets; dets &= dets-1){
+    int i = Q3Fired.Lowest(dets);
 
-      Si.ZeroSi_obj();
+    Si.ZeroSi_obj();
 
-      for (int j=0; j<MaxQ3Ch; j++){
+    for (UInt_t chs=Q3Fired.Channels(i); chs; chs &= chs-1){
+      int j = Q3Fired.Lowest(chs);
 
-	if ( (Q3Energy_Cal[i][j] > Si_E_threshold)){
+      if ( (Q3Energy_Cal[i][j] > Si_E_threshold)){
 
-	  if (j<16){//Back Channels of Q3
+	if (j<16){//Back Channels of Q3
 
-	    Si.det_obj.BackChNum.push_back(j);
+	  Si.det_obj.BackChNum.push_back(j);
 
 #if defined(FillTree_Esteps) || defined(Hist_for_Si_Cal)
-	    Si.det_obj.EBack_Raw.push_back(Q3Energy[i][j]);
-	    Si.det_obj.EBack_Pulser.push_back(Q3Energy_Pulser[i][j]);
-	    Si.det_obj.EBack_Rel.push_back(Q3Energy_Rel[i][j]);
+	  Si.det_obj.EBack_Raw.push_back(Q3Energy[i][j]);
+	  Si.det_obj.EBack_Pulser.push_back(Q3Energy_Pulser[i][j]);
+	  Si.det_obj.EBack_Rel.push_back(Q3Energy_Rel[i][j]);
 #endif
-	    Si.det_obj.EBack_Cal.push_back(Q3Energy_Cal[i][j]);
-	    Si.det_obj.TBack.push_back(Q3Time[i][j]);
+	  Si.det_obj.EBack_Cal.push_back(Q3Energy_Cal[i][j]);
+	  Si.det_obj.TBack.push_back(Q3Time[i][j]);
 
-	  }
+	}
 
-	  else if(j>15){//Front Channels of Q3 ,
+	else if(j>15){//Front Channels of Q3 ,
 
-	    Si.det_obj.FrontChNum.push_back(j-16); 
+	  Si.det_obj.FrontChNum.push_back(j-16); 
 
 #if defined(FillTree_Esteps) || defined(Hist_for_Si_Cal)
-	    Si.det_obj.EFront_Raw.push_back(Q3Energy[i][j]);
-	    Si.det_obj.EFront_Pulser.push_back(Q3Energy_Pulser[i][j]);
-	    Si.det_obj.EFront_Rel.push_back(Q3Energy_Rel[i][j]);
+	  Si.det_obj.EFront_Raw.push_back(Q3Energy[i][j]);
+	  Si.det_obj.EFront_Pulser.push_back(Q3Energy_Pulser[i][j]);
+	  Si.det_obj.EFront_Rel.push_back(Q3Energy_Rel[i][j]);
 #endif
-	    Si.det_obj.EFront_Cal.push_back(Q3Energy_Cal[i][j]);
-	    Si.det_obj.TFront.push_back(Q3Time[i][j]);
-	  }
+	  Si.det_obj.EFront_Cal.push_back(Q3Energy_Cal[i][j]);
+	  Si.det_obj.TFront.push_back(Q3Time[i][j]);
 	}
-	//===========================================
-      }//end of for(int j=0; j<MaxQ3Ch; j++){
+      }
       //===========================================
-      Si.det_obj.FrontMult = Si.det_obj.EFront_Cal.size();
-      Si.det_obj.BackMult = Si.det_obj.EBack_Cal.size();
+    }//end of for(int j=0; j<MaxQ3Ch; j++){
+    //===========================================
+    Si.det_obj.FrontMult = Si.det_obj.EFront_Cal.size();
+    Si.det_obj.BackMult = Si.det_obj.EBack_Cal.size();
+
 
+    Si.det_obj.DetID = i;
+    Si.det_obj.HitType = Si.det_obj.BackMult*10 + Si.det_obj.FrontMult;
 
-      Si.det_obj.DetID = i;
-      Si.det_obj.HitType = Si.det_obj.BackMult*10 + Si.det_obj.FrontMult;
+    if ( Si.det_obj.EFront_Cal.size()!=0 && Si.det_obj.EBack_Cal.size()!=0 ){	
 
-      if ( Si.det_obj.EFront_Cal.size()!=0 && Si.det_obj.EBack_Cal.size()!=0 ){	
+      SiSort.SortQ3(&Si,CMAP);
+      Si.Detector.push_back(Si.det_obj);
 
-	SiSort.SortQ3(&Si,CMAP);
-	Si.Detector.push_back(Si.det_obj);
-	
-	/////////////////////////////////////////  Fill Q3 Histograms after Calibration  ///////////////////////////////////////
+      /////////////////////////////////////////  Fill Q3 Histograms after Calibration  ///////////////////////////////////////
 #ifdef Hist_after_Cal
-	if(Si.hit_obj.HitType ==11){
-	  MyFill(Form("back_vs_front_Cal%i",Si.hit_obj.DetID),500,0,30,Si.hit_obj.EnergyFront,500,0,30,Si.hit_obj.EnergyBack);
-	  MyFill(Form("Q3_offset_back_vs_front_Cal%i",Si.hit_obj.DetID),960,0,30,Si.hit_obj.EnergyBack,340,-10,10,(Si.hit_obj.EnergyBack-Si.hit_obj.EnergyFront));
-	  //MyFill(Form("back_vs_front_Cal%i_f%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
-	  //MyFill(Form("back_vs_front_Cal%i_b%i",Si.hit_obj.DetID,Si.hit_obj.BackChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
-	  //MyFill(Form("back_vs_front_Cal%i_%i_%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
-	}
+      if(Si.hit_obj.HitType ==11){
+	fh.Fill(hback_vs_front_CalN(Si.hit_obj.DetID),500,0,30,Si.hit_obj.EnergyFront,500,0,30,Si.hit_obj.EnergyBack);
+	fh.Fill(hQ3_offset_back_vs_front_CalN(Si.hit_obj.DetID),960,0,30,Si.hit_obj.EnergyBack,340,-10,10,(Si.hit_obj.EnergyBack-Si.hit_obj.EnergyFront));
+	//MyFill(Form("back_vs_front_Cal%i_f%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
+	//MyFill(Form("back_vs_front_Cal%i_b%i",Si.hit_obj.DetID,Si.hit_obj.BackChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
+	//MyFill(Form("back_vs_front_Cal%i_%i_%i",Si.hit_obj.DetID,Si.hit_obj.FrontChannel,Si.hit_obj.BackChannel),100,0,30,Si.hit_obj.EnergyFront,100,0,30,Si.hit_obj.EnergyBack);
+      }
 #endif
-	////////////////////////////////////////  Fill Q3 Histograms for Calibration  ///////////////////////////////////////////
+      ////////////////////////////////////////  Fill Q3 Histograms for Calibration  ///////////////////////////////////////////
 #ifdef Hist_for_Si_Cal
-	Int_t fbmax=4*4096/3;
-	Int_t bins=512;
-	if(Si.det_obj.HitType ==11){//Just to make it simple.
-	  //Step 1 RelCal//F-B	 //No need to give it a name Q3_ as we have DetID but since we are Calibration Differently for Q3 && SX3. 
-	  MyFill(Form("Q3_back_vs_front%i_%i_%i",Si.det_obj.DetID,Si.det_obj.FrontChNum[0],Si.det_obj.BackChNum[0]),bins,0,fbmax,Si.det_obj.EFront_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
-	  
-	  //Step 2 RelCal//F-B //RelGain Cal from Step 1 is applied
-	  MyFill(Form("Q3_back_vs_front%i_b%i",Si.det_obj.DetID,Si.det_obj.BackChNum[0]),bins,0,fbmax,Si.det_obj.EFront_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
-	  //Just for check
-	  MyFill(Form("Q3_back_vs_front%i",Si.det_obj.DetID),bins,0,fbmax,Si.det_obj.EFront_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
-
-	  //check offset
-  	  MyFill(Form("Q3_back_vs_offset%i",Si.det_obj.DetID),
-		 200,-400,400,(Si.det_obj.EBack_Rel[0]-Si.det_obj.EFront_Rel[0]),
-		 bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
-	}
+      Int_t fbmax=4*4096/3;
+      Int_t bins=512;
+      if(Si.det_obj.HitType ==11){//Just to make it simple.
+	//Step 1 RelCal//F-B	 //No need to give it a name Q3_ as we have DetID but since we are Calibration Differently for Q3 && SX3. 
+	fh.Fill(hQ3_back_vs_frontN_N_N(Si.det_obj.DetID,Si.det_obj.FrontChNum[0],Si.det_obj.BackChNum[0]),bins,0,fbmax,Si.det_obj.EFront_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
+
+	//Step 2 RelCal//F-B //RelGain Cal from Step 1 is applied
+	fh.Fill(hQ3_back_vs_frontN_bN(Si.det_obj.DetID,Si.det_obj.BackChNum[0]),bins,0,fbmax,Si.det_obj.EFront_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
+	//Just for check
+	fh.Fill(hQ3_back_vs_frontN(Si.det_obj.DetID),bins,0,fbmax,Si.det_obj.EFront_Rel[0],bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
+
+	//check offset
+	fh.Fill(hQ3_back_vs_offsetN(Si.det_obj.DetID),
+	       200,-400,400,(Si.det_obj.EBack_Rel[0]-Si.det_obj.EFront_Rel[0]),
+	       bins,0,fbmax,Si.det_obj.EBack_Rel[0]);
+      }
 #endif
-	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #ifdef Hist_for_PC_Cal
-	for ( Int_t hits=0; hits<PC.NPCHits; hits++ ) {
-	  MyFill("PCPhi_vs_SiPhi_Q3",500,0,8,Si.hit_obj.PhiW,500,0,8,PC.Hit[hits].PhiW);
-	}
+      for ( Int_t hits=0; hits<PC.NPCHits; hits++ ) {
+	fh.Fill(hPCPhi_vs_SiPhi_Q3(),500,0,8,Si.hit_obj.PhiW,500,0,8,PC.Hit[hits].PhiW);
+      }
 #endif	
-	
-      }else if ( Si.det_obj.EFront_Cal.size()!=0 || Si.det_obj.EBack_Cal.size()!=0 ){
-	//if only either of Front or Back is fired in Q3, continue, unless it is a pulser check
+
+    }else if ( Si.det_obj.EFront_Cal.size()!=0 || Si.det_obj.EBack_Cal.size()!=0 ){
+      //if only either of Front or Back is fired in Q3, continue, unless it is a pulser check
 #ifdef Pulser_ReRun
-	Si.Detector.push_back(Si.det_obj);
-	Si.NSiHits++;
+      Si.Detector.push_back(Si.det_obj);
+      Si.NSiHits++;
 #else
-	continue;
+      continue;
 #endif
-      }
-      //============================================================ 
-    }//end of for(int i=0; i<NumQ3; i++){
+    }
     //============================================================ 
+  }//end of loop over the Q3 detectors with a hit
+  //============================================================ 
 #ifdef IC_hists
-    if(IC_E > 0) {
-      MainTree->Fill();
-    }
+  if(IC_E > 0) {
+    FillMainTree();
+  }
 #else
-    if (Si.NSiHits > 0) {
-    //if (PC.NPCHits > 0) {    
-      MainTree->Fill();
+  if (Si.NSiHits > 0) {
+  //if (PC.NPCHits > 0) {    
+    FillMainTree();
+  }
+#endif
+  //============================================================
+  return kTRUE;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+int main(int argc, char* argv[]) {
+
+  //the entries processed: -first, -last, -every, -random, -stratified, -seed
+  EntrySelection Entries;
+  if (!Entries.ParseArgs(argc,argv)) exit(EXIT_FAILURE);
+
+  //-evt <data_dir> <run>: read the .evt files directly instead of a DataTree
+  Bool_t fromEvt = (argc>1 && strcmp(argv[1],"-evt")==0);
+  if (argc<3 || (fromEvt && argc<5)) {
+    cout << " Error: Wrong number of arguments\n";
+    cout << " Usage: ./Main input.root output.root " << EntrySelection::Usage() << "\n";
+    cout << "        ./Main -evt <data_dir>/ <run> output.root [raw.root] " << EntrySelection::Usage() << "\n";
+    exit(EXIT_FAILURE);
+  }
+  
+  //read in command line arguments
+  char* filename_histout = new char [200];//output root file
+  char* filename_callist = new char [200];//input file list
+  
+  if (fromEvt) {
+    strcpy( filename_callist, argv[2] );
+    strcpy( filename_histout, argv[4] );
+  }
+  else {
+    strcpy( filename_callist, argv[1] );
+    strcpy( filename_histout, argv[2] );
+  }
+
+  if(FillIMT) ROOT::EnableImplicitMT();
+
+  TFile *outputFile = new TFile(filename_histout,"RECREATE");
+  TList *fhlist = new TList;
+
+  ChannelMap *CMAP;
+  CMAP = new ChannelMap();
+  cout<<" ============================================================================================"<<endl; 
+  //Initialization of the main channel map  
+  ////////////////////////////////////////////////////////////////////////////
+  
+  //initialize 17F
+  if(1) {//load calibration files
+    CMAP->Init("Param/24Mg_cals/initialize/ASICS_cmap_022716",
+	       "Param/17F_cals/Sipulser_2016.07.20offsets_centroid.dat",
+	       "Param/17F_cals/AlphaCal_170515.edit.dat",
+	       "Param/17F_cals/X3RelativeGains_Step3_170525.dat",
+	       "Param/17F_cals/QQQRelativeGains_Step2_170428.dat");
+    CMAP->FinalInit("Param/17F_cals/X3FinalFix_Step3_170525.dat",
+		    "Param/17F_cals/X3geometry_180201_600bins_2.875.dat");
+    CMAP->LoadQ3FinalFix("Param/17F_cals/QQQFinalFix_Step2_170428.dat");
+    CMAP->InitPCCalibration("Param/17F_cals/PCpulserCal_zero_2017-11-06.dat");
+    CMAP->Init_PC_UD_RelCal("Param/17F_cals/PC_UD_RelCal_180205.dat");
+    CMAP->Init_PCWire_RelGain("Param/17F_cals/PCWire_RelGain_init.dat");
+    CMAP->InitPCWireCal("Param/17F_cals/PCWireCal_180206_average.dat");
+  }
+  else {//load trivial calibration, before any cal where all slopes are one and offsets zero
+    CMAP->Init("Param/24Mg_cals/initialize/ASICS_cmap_022716",
+	       "Param/initialize/Sipulser_init.dat",
+	       "Param/initialize/AlphaCalibration_init.dat",
+	       "Param/initialize/X3RelativeGains_Slope1.dat",
+	       "Param/initialize/QQQRelativeGains_Slope1.dat");
+    CMAP->FinalInit("Param/initialize/X3FinalFix_init.dat",
+		    "Param/initialize/X3geometry_init.dat");
+    CMAP->LoadQ3FinalFix("Param/initialize/QQQFinalFix_init.dat");
+    CMAP->InitPCCalibration("Param/initialize/PCpulser_init.dat");
+    CMAP->InitPCWireCal("Param/initialize/PCWireCal_init.dat");
+    CMAP->Init_PC_UD_RelCal("Param/initialize/PC_UD_RelCal_init.dat");
+    CMAP->Init_PCWire_RelGain("Param/initialize/PCWire_RelGain_init.dat");
+  }
+    
+  CMAP->InitWorldCoordinates("Param/17F_cals/WorldCoord_170223.dat");  
+  CMAP->InitPCADC("Param/initialize/NewPCMap");  
+#ifdef Quadratic_Pulser
+  CMAP->LoadASICsPulserAlignment_Quadratic(Quadratic_Pulser);
+#endif
+  cout<<" ============================================================================================"<<endl;
+  //run number of the random numbers: the -evt argument, or the number in the input file name
+  UInt_t RunNumber = 0;
+  if (fromEvt)
+    RunNumber = atoi(argv[3]);
+  else {
+    const char* name = strrchr(filename_callist,'/') ? strrchr(filename_callist,'/')+1 : filename_callist;
+    while (*name && !isdigit(*name)) name++;
+    RunNumber = atoi(name);
+  }
+#ifdef IC_cut
+  //the cut is read once; FastCut::IsInside() can be called from all the threads
+  CutRegistry Cuts;
+  const char* file_cut1 = "/home/lighthall/anasen/root/main/17F_cut.root";
+  if (!Cuts.LoadFile(file_cut1)){
+    cout << "Cut file1: " << file_cut1 << " could not be opened.\n";
+    exit(EXIT_FAILURE);
+  }
+  const FastCut *cut1 = Cuts.Get(file_cut1,"CUTG");
+  
+  if (cut1 == NULL){
+    cout << "cut1 does not exist\n";
+    exit(EXIT_FAILURE);
+  }
+#endif
+  //------------------------------------------------------------------------------------------
+  //Create Objects of the Detector Classes, one set per thread
+  Int_t nthreads = NThreads;
+  if (fromEvt && nthreads>1) {
+    cout << " -evt: the events are decoded in sequence, running on one thread" << endl;
+    nthreads = 1;
+  }
+  vector<MainProcessor*> Workers;
+  for (Int_t t=0; t<nthreads; t++) {
+    Workers.push_back(new MainProcessor(CMAP,fh,RunNumber));
+#ifdef IC_cut
+    Workers[t]->ICCut = cut1;
+#endif
+  }
+  MainProcessor& Event = *Workers[0];
+
+  //read before RawTree (-evt) and MainTree are created, and applied to both
+  if (DefaultTreeOutputConfig().Load(OutputConfig)) {
+    cout << " Tree output settings read from " << OutputConfig << endl;
+    DefaultTreeOutputConfig().Print();
+  }
+
+  EvtRunReader evtRun;
+  TFile *rawFile = NULL; //optional copy of the decoded events (-evt mode)
+  TTree *RawTree = NULL;
+  Long64_t nentries = 0;
+
+  if (fromEvt) {
+    Int_t run = atoi(argv[3]);
+    CAENAcceptance& caen = DefaultCAENAcceptance();
+    if (caen.Load(CAENConfig))
+      cout << " CAEN channels read from " << CAENConfig << endl;
+    else
+      cout << " *** Warning: " << CAENConfig << " not found, using the default CAEN channels (PC, IC, RF/MCP)" << endl;
+    caen.Print();
+    if (!evtRun.Open(filename_callist,run)) {
+      cout << "Run " << run << " in " << filename_callist << " could not be read.\n";
+      exit(EXIT_FAILURE);
+    }
+    nentries = evtRun.GetNumPhysics();
+    if (argc>5) {
+      rawFile = new TFile(argv[5],"RECREATE");
+      RawTree = new TTree("DataTree","DataTree");
+      BranchPhysicsEvent(RawTree,Event.Raw);
+      DefaultTreeOutputConfig().Apply(RawTree);
+      outputFile->cd(); //histograms are created in the output file
     }
+  }
+  else {
+    TreeInput::SetAsyncPrefetch(AsyncPrefetch);
+    for (Int_t t=0; t<nthreads; t++)
+      Workers[t]->OpenDataTree(filename_callist);
+    nentries = Event.GetEntries();
+  }
+  //--------------------------------------------------------------------------
+
+  outputFile->cd();
+  TTree *MainTree = new TTree("MainTree","MainTree");
+  TreeFillThread MainFill(MainTree,FillThread);
+  //with one thread the branches are the variables of its MainProcessor
+  MainEvent Out;
+  MainEvent& Branches = (nthreads>1) ? Out : (MainEvent&)Event;
+  
+  if (FlatOutput) {
+    MainTree->Branch("Si.NSiHits",MainFill.Copy(Branches.Si.NSiHits),"NSiHits/I");
+    MainTree->Branch("PC.NPCHits",MainFill.Copy(Branches.PC.NPCHits),"NPCHits/I");
+#if defined(FillTree_Esteps) || defined(Hist_for_Si_Cal)
+    FlatMainTree *Flat = new FlatMainTree(kTRUE);
+#else
+    FlatMainTree *Flat = new FlatMainTree(kFALSE);
 #endif
-    //============================================================
-    ncount++;
-  }//end of for (global_evt=0; global_evt<nentries; global_evt++){
+    MainFill.Convert(Branches,Flat,[](const MainEvent& e, FlatMainTree& f){ f.Set(e.Si,e.PC); });
+    Flat->Branch(MainTree);
+  }
+  else {
+    MainTree->Branch("Si.NSiHits",MainFill.Copy(Branches.Si.NSiHits),"NSiHits/I");
+    MainTree->Branch("Si.Detector",MainFill.Copy(Branches.Si.Detector));
+    MainTree->Branch("Si.Hit",MainFill.Copy(Branches.Si.Hit));
+    MainTree->Branch("PC.NPCHits",MainFill.Copy(Branches.PC.NPCHits),"NPCHits/I");
+    MainTree->Branch("PC.Hit",MainFill.Copy(Branches.PC.Hit)); 
+  }
+
+  MainTree->Branch("RFTime",MainFill.Copy(Branches.RFTime),"RFTime/I");
+  MainTree->Branch("MCPTime",MainFill.Copy(Branches.MCPTime),"MCPTime/I");
+  MainTree->Branch("TOFTime",MainFill.Copy(Branches.TOFTime),"TOFTime/F");
+  MainTree->Branch("TOFcTime",MainFill.Copy(Branches.TOFcTime),"TOFcTime/F");
+  MainTree->Branch("TOFwTime",MainFill.Copy(Branches.TOFwTime),"TOFwTime/F");
+
+#ifdef IC_hists 
+  MainTree->Branch("IC.dE",MainFill.Copy(Branches.IC_dE),"IC_dE/I");
+  MainTree->Branch("IC.E",MainFill.Copy(Branches.IC_E),"IC_E/I");
+#endif
+
+  DefaultTreeOutputConfig().Apply(MainTree);
+
+  TObjArray *RootObjects = new TObjArray();
+  RootObjects->Add(MainTree);
+
+  RootObjects->Add(fhlist);
+
+  for (Int_t t=0; t<nthreads; t++) {
+    Workers[t]->MainFill = &MainFill;
+    Workers[t]->fh.SetLookupByName(HistByName);
+    if (nthreads==1)
+      Workers[t]->fh.SetList(fhlist);
+  }
+  if (nthreads>1 || FillThread) {
+    //the histograms are made in the event loop, by several threads or while the fill thread writes MainTree
+    //to the output file: they are kept in fhlist (written with RootObjects), not in the current directory
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory(kFALSE);
+  }
+
+  cout << " nentries = " << nentries<<"  in  "<< filename_callist <<endl;
+
+  //Entry counting variables
+  Long64_t ncount=0; 
+  Long64_t ntot=Entries.Select(nentries);
+  Entries.Print();
+  if (!fromEvt)
+    for (Int_t t=0; t<nthreads; t++)
+      Entries.Apply(*Workers[t]->input);
+  Float_t print_step=0.1;
+  if(ntot>5e5)
+    print_step/=10;
+  cout << " Each \".\" represents " << (print_step/10)*ntot << " events or " << print_step/10*100 <<"% of total" <<endl;
+  
+  //prints the progress, nsum out of ntot entries
+  auto Progress = [&](Long64_t nsum) {
+    if(nsum%TMath::Max(TMath::Nint(ntot*print_step),1)==0) { cout << endl << "  Done: "
+						    << right << fixed << setw(3)
+						    << TMath::Nint(nsum*100./ntot) << "%" << std::flush;
+      //cout << " global_evt = " << global_evt << ", ncount = " <<ncount<<endl;//total vs passed
+      //cout << "   sum is "<< nsum << " total is " << ntot;
+      //cout << " " << nsum*100./ntot << "%          ";
+    }
+    if(nsum%TMath::Max(TMath::Nint(ntot*print_step/10),1)==0) cout << "." << std::flush;
+    //std::cout << "\rDone: " << nsum*100./ntot << "%" << std::flush;
+  };
+  
+  TStopwatch loop_time;
+  if (nthreads==1) {
+    Long64_t nevt = 0; //-evt: physics events read so far
+    for (Long64_t nsum=0; nsum<ntot; nsum++) {//loop over the entries selected------
+      Long64_t global_evt = Entries.GetEntry(nsum);
+      if(fromEvt) {
+	//the events are read in sequence, the skipped ones as well
+	unsigned short* body = NULL;
+	while (nevt <= global_evt && (body = evtRun.NextPhysics())) nevt++;
+	if(!body) break;
+	DecodePhysicsEvent(body,Event.Raw);
+	if(RawTree) RawTree->Fill();
+      }
+      else
+	Event.GetEntry(global_evt);
+
+      Progress(nsum);
+
+      if(!Event.Process(global_evt)) continue;
+      ncount++;
+    }//end of for (nsum=0; nsum<ntot; nsum++){
+  }
+  else {
+    //the threads process chunks of entries, each with its own MainProcessor, and keep the events to be
+    //written; MainTree is filled here, chunk after chunk in entry order
+    struct ChunkOutput {
+      vector<MainEvent> events;
+      Long64_t ncount;
+      ChunkOutput() : ncount(0) {}
+    };
+    //the chunks are of entries selected, k is the index in Entries
+    ParallelEntryLoop<ChunkOutput> loop(0,ntot,nthreads,ChunkSize);
+    loop.Run([&](Int_t t, Long64_t first, Long64_t last, ChunkOutput& chunk) {
+	MainProcessor& W = *Workers[t];
+	W.Buffer = &chunk.events;
+	for (Long64_t k=first; k<last; k++) {
+	  Long64_t global_evt = Entries.GetEntry(k);
+	  W.GetEntry(global_evt);
+	  if(W.Process(global_evt)) chunk.ncount++;
+	}
+      },
+      [&](Long64_t first, Long64_t last, ChunkOutput& chunk) {
+	for (Long64_t k=first; k<last; k++)
+	  Progress(k);
+	for (size_t i=0; i<chunk.events.size(); i++) {
+	  Out = std::move(chunk.events[i]);
+	  MainFill.Fill();
+	}
+	ncount += chunk.ncount;
+      });
+    vector<HistRegistry*> parts;
+    for (Int_t t=0; t<nthreads; t++)
+      parts.push_back(&Workers[t]->fh);
+    HistRegistry::Merge(parts,fhlist);
+  }
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   
+  MainFill.Finish();
+  loop_time.Stop();
+  cout << endl << " " << ncount << " events in " << loop_time.RealTime() << " s: "
+       << ncount/loop_time.RealTime() << " events/s" << (HistByName ? " (histograms by name)" : "");
+  if (nthreads>1) cout << " on " << nthreads << " threads";
+  cout << endl;
+  if (!fromEvt) {
+    TreeReadStats read_stats;
+    for (Int_t t=0; t<nthreads; t++)
+      read_stats += Workers[t]->input->GetStats();
+    read_stats.Print("DataTree");
+  }
   cout << endl << " Changing to output file... ";
   outputFile->cd();
   cout << filename_histout  << endl;
@@ -956,38 +1267,20 @@ int main(int argc, char* argv[]) {
   cout << "RootObjects are Written" << endl;
   outputFile->Close();
   cout << " Outputfile Closed\n";
+  if(rawFile) {
+    rawFile->cd();
+    RawTree->Write();
+    rawFile->Close();
+    cout << " DataTree written to " << argv[5] << endl;
+  }
+  evtRun.Close();
+  if (evtRun.Failed())
+    cout << " *** Error: run " << argv[3] << " could not be read to the end, the output is incomplete" << endl;
   for(int i=0;i<1;i++) {//print beeps at end of program
     printf(" beep!\a\n");
     sleep(1);
   }
-  return 0;
+  return evtRun.Failed() ? EXIT_FAILURE : 0;
 }
 //end of Main()
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-void MyFill(string name, int binsX, double lowX, double highX, double valueX){
-  try{
-    fhmap.at(name)->Fill(valueX);
-  } catch(out_of_range e) {
-    TH1F* newHist = new TH1F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX);
-    newHist->Fill(valueX);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;  
-  }  
-}
-//===========================================================================
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY){
-  try{
-    fhmap.at(name)->Fill(valueX,valueY);
-  } catch(out_of_range e) {
-    TH2F* newHist = new TH2F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX,
-			     binsY,lowY,highY);
-    newHist->Fill(valueX,valueY);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;  
-  }  
-}
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -12,13 +12,13 @@
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 #include <TROOT.h>
-#include <TRandom3.h>
 #include <TMath.h>
 #include <algorithm>
 #include <vector>
 
 #include "ChannelMap.h"
 #include "../include/tree_structure.h"
+#include "../include/CounterRNG.h"
 
 using namespace std;
 
@@ -32,9 +32,14 @@ class Silicon_Cluster{
 
   };
 
-  int Initialize(){
-    Random = new TRandom3();
-    Random->SetSeed();  
+  // The smearing within the strips is a function of (run, entry, detector, hit),
+  // see ../include/CounterRNG.h; SetEntry() is called for each event.
+  void Initialize(UInt_t run = 0, UInt_t seed = 0){
+    Random.SetRun(run);
+    Random.SetSeed(seed);
+  };
+  void SetEntry(Long64_t entry){
+    Random.SetEntry(entry);
   };
 
   struct data {
@@ -49,7 +54,7 @@ class Silicon_Cluster{
     Double_t Energy_Front;
   };
 
-  TRandom3 *Random;
+  CounterRNG Random;
 
   data data_obj;
   vector<data> front;
@@ -62,12 +67,10 @@ class Silicon_Cluster{
   static bool Esort_method(struct data a,struct data b);
   static bool Csort_method(struct data a,struct data b);
  
-  void SortQ3(SiHit *Si, ChannelMap *CMAP);
-  void SortSX3(SiHit *Si, ChannelMap *CMAP);
+  void SortQ3(SiHit *Si, const ChannelMap *CMAP);
+  void SortSX3(SiHit *Si, const ChannelMap *CMAP);
   
   ~Silicon_Cluster(){   
-    delete Random;
-    cout<<"========Random deleted==========="<<endl;
   };  
   
 };
@@ -85,7 +88,7 @@ bool Silicon_Cluster::Csort_method(struct data a,struct data b){
   return 0;
 };
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
-void Silicon_Cluster::SortQ3(SiHit *Si, ChannelMap *CMAP){
+void Silicon_Cluster::SortQ3(SiHit *Si, const ChannelMap *CMAP){
 
   const Double_t InnerRadius = 5.01; //cm
   const Double_t OuterRadius = 10.1; //cm 
@@ -217,8 +220,8 @@ void Silicon_Cluster::SortQ3(SiHit *Si, ChannelMap *CMAP){
   for(int r=0;r<k;r++){
   
     //determine radius and angle
-    QQQR = OuterRadius - (fChannel[r]+Random->Rndm() )*RingPitch;
-    QQQPhi = (bChannel[r] + Random->Rndm() )*StripAngle;
+    QQQR = OuterRadius - (fChannel[r]+Random.Rndm(CounterRNG::kQ3,Si->det_obj.DetID,r,0) )*RingPitch;
+    QQQPhi = (bChannel[r] + Random.Rndm(CounterRNG::kQ3,Si->det_obj.DetID,r,1) )*StripAngle;
    
     //fill tree
     Si->hit_obj.NHitsInDet = k;  
@@ -264,7 +267,7 @@ void Silicon_Cluster::SortQ3(SiHit *Si, ChannelMap *CMAP){
   } 
 };
 //////////////////////////////////////////////////////////////////////////////////////////////////
-void Silicon_Cluster::SortSX3(SiHit *Si, ChannelMap *CMAP){
+void Silicon_Cluster::SortSX3(SiHit *Si, const ChannelMap *CMAP){
 
   front.clear();
   back.clear();  
@@ -485,7 +488,7 @@ void Silicon_Cluster::SortSX3(SiHit *Si, ChannelMap *CMAP){
     //Si->hit_obj.Z = (3-bCh[s] + ZRandom->Rndm())*1.875; 
 
     //Si->hit_obj.X = XRandom->Rndm()+(3-Si->hit_obj.FrontChannel);
-    Si->hit_obj.X = Random->Rndm()+(3-fCh[s]); 
+    Si->hit_obj.X = Random.Rndm(CounterRNG::kSX3,Si->det_obj.DetID,s)+(3-fCh[s]); 
     //-------------------------------------------------------------
 
     if ((ZDownCal > -1) && (fEn_Down[s] > fEn_Up[s])) {  
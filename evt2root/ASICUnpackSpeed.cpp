@@ -0,0 +1,110 @@
+/* Program: ASICUnpackSpeed.cpp
+ * Description: Microbenchmark of the ASICs strip decoding. Compares the
+ * if-chain of the former ReadPhysicsBuffer() with the table-driven
+ * ASICUnpacker (strips/s) on random strip blocks, and checks that both
+ * give the same hits.
+ * See readme.md for general instructions.
+ *
+ * Compile: g++ -O2 ASICUnpackSpeed.cpp `root-config --cflags` -o asicspeed.out
+ * Run:     ./asicspeed.out [blocks]
+ */
+
+//C and C++ libraries
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/time.h>
+
+#include "ASICUnpacker.h"
+
+using namespace std;
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv,NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+// the MB1 strip loop of evt2root_NSCL11.C before ASICUnpacker
+unsigned short* UnpackMB1(unsigned short* fpoint, int Nstrips, ASICHit& Si) {
+  for (int istrip=0;istrip<Nstrips;istrip++) {
+    unsigned short *gpoint = fpoint;
+    unsigned short id = *gpoint;
+    unsigned short chipNum = (id&0x1FE0)>>5;
+    unsigned short chanNum = id& 0x1F;
+    gpoint++;
+    int energy = *gpoint;
+    gpoint++;
+    unsigned short time = *gpoint;
+
+    if(chanNum<16) {
+      if (chipNum == 1 || chipNum == 2 ) energy =16384-energy;
+      if (chipNum == 3 || chipNum == 4 ) energy =energy;
+      if (chipNum == 5 || chipNum == 6 ) energy =16384-energy;
+      if (chipNum == 7 || chipNum == 8 ) energy =energy;
+      if (chipNum == 9 || chipNum == 10 ) energy =16384-energy;
+      if (chipNum == 11 || chipNum == 12 ) energy =16384-energy;
+      if (chipNum == 13 || chipNum == 14 ) energy =16384-energy;
+
+      Si.MBID[Si.Nhits]=1;
+      Si.CBID[Si.Nhits]=chipNum;
+      Si.ChNum[Si.Nhits]=chanNum;
+      Si.Energy[Si.Nhits]=energy;
+      Si.Time[Si.Nhits++]=time;
+    }
+    fpoint +=3;
+  }
+  return fpoint;
+}
+
+int main(int argc, char* argv[]) {
+  int nblocks = argc > 1 ? atoi(argv[1]) : 200000;
+  const int kStrips = 128; //strips per block, as in a busy event
+
+  //random strip blocks: chips 1-14, channels 0-31, 14-bit energy and time
+  srand(1);
+  vector<unsigned short> data(3*kStrips*1024);
+  for (size_t i=0; i<data.size(); i+=3) {
+    data[i] = ((1 + rand()%14)<<5) | (rand()%32);
+    data[i+1] = rand()%16384;
+    data[i+2] = rand()%16384;
+  }
+
+  const ASICUnpacker& asics = DefaultASICUnpacker();
+  ASICHit* Si = new ASICHit;
+  ASICHit* Ref = new ASICHit;
+
+  //check
+  for (int b=0; b<1024; b++) {
+    Si->Nhits = Ref->Nhits = 0;
+    asics.Unpack(&data[3*kStrips*b],kStrips,1,*Si);
+    UnpackMB1(&data[3*kStrips*b],kStrips,*Ref);
+    bool same = Si->Nhits==Ref->Nhits;
+    for (int i=0; same && i<Si->Nhits; i++)
+      same = Si->MBID[i]==Ref->MBID[i] && Si->CBID[i]==Ref->CBID[i] && Si->ChNum[i]==Ref->ChNum[i]
+	&& Si->Energy[i]==Ref->Energy[i] && Si->Time[i]==Ref->Time[i];
+    if (!same) {
+      printf(" *** Error: block %d decoded differently\n",b);
+      return 1;
+    }
+  }
+
+  const char* label[2] = {"if-chain","ASICUnpacker"};
+  for (int mode=0; mode<2; mode++) {
+    long long sum = 0;
+    double t0 = Now();
+    for (int b=0; b<nblocks; b++) {
+      Si->Nhits = 0;
+      unsigned short* block = &data[3*kStrips*(b%1024)];
+      if (mode==0) UnpackMB1(block,kStrips,*Si);
+      else asics.Unpack(block,kStrips,1,*Si);
+      sum += Si->Nhits + Si->Energy[Si->Nhits/2];
+    }
+    double t = Now()-t0;
+    printf(" %-14s %8.1f Mstrips/s (checksum %lld)\n",label[mode],1e-6*nblocks*kStrips/t,sum);
+  }
+  delete Si;
+  delete Ref;
+  return 0;
+}
@@ -0,0 +1,117 @@
+/***************************************************************
+Class: ASICUnpacker
+Unpacks the strip block of one ASICs motherboard (0xaaaa for MB1,
+0xbbbb for MB2) into an ASICHit.
+
+Each strip is three words: id (chip in bits 5-12, channel in bits
+0-4), energy and time. Some chips are read out with the opposite
+polarity and their energy is inverted (16384-energy). Instead of
+testing the chip number for every strip, the polarity of every
+motherboard and chip is kept in a table of the form
+
+  energy = offset[MB][chip] + sign[MB][chip]*raw
+
+which is filled once (default table below, or Load()). The strip loop
+then has no data-dependent branches: every strip is written to the
+next free slot and the hit count is only advanced for channels <16.
+The slot behind the last hit is cleared again, so the arrays stay zero
+beyond Nhits (see 2016_detclass.h).
+
+Usage:
+  const ASICUnpacker& asics = DefaultASICUnpacker();
+  fpoint = asics.Unpack(fpoint,Nstrips,1,Si);
+****************************************************************/
+#ifndef ASICUNPACKER_H
+#define ASICUNPACKER_H
+
+// C includes
+#include <stdio.h>
+
+#include <TROOT.h>
+
+#include "../include/2016_detclass.h"
+
+class ASICUnpacker {
+ public:
+  static const int kMaxMB = 3;     //motherboards 1 and 2
+  static const int kMaxChip = 256; //chip numbers are 8 bits
+  static const int kFullScale = 16384;
+
+ private:
+  Int_t sign[kMaxMB][kMaxChip];
+  Int_t offset[kMaxMB][kMaxChip];
+
+ public:
+  // The default table: MB1 chips 1,2,5,6,9-14 and MB2 chips 1,2,5,6,9,10
+  // are inverted.
+  ASICUnpacker() {
+    for(int mb=0; mb<kMaxMB; mb++)
+      for(int chip=0; chip<kMaxChip; chip++)
+	SetInverted(mb,chip,false);
+
+    const int mb1[] = {1,2,5,6,9,10,11,12,13,14};
+    const int mb2[] = {1,2,5,6,9,10};
+    for(unsigned int i=0; i<sizeof(mb1)/sizeof(mb1[0]); i++) SetInverted(1,mb1[i],true);
+    for(unsigned int i=0; i<sizeof(mb2)/sizeof(mb2[0]); i++) SetInverted(2,mb2[i],true);
+  }
+
+  void SetInverted(int mb, int chip, bool inverted) {
+    if(mb<0 || mb>=kMaxMB || chip<0 || chip>=kMaxChip) return;
+    sign[mb][chip] = inverted ? -1 : 1;
+    offset[mb][chip] = inverted ? kFullScale : 0;
+  }
+  bool IsInverted(int mb, int chip) const { return sign[mb][chip] < 0; }
+
+  // Reads a polarity table with lines "MB chip inverted(0/1)". Chips not
+  // listed keep their current polarity; lines starting with # are skipped.
+  bool Load(const char* name) {
+    FILE* f = fopen(name,"r");
+    if(!f) return false;
+    char line[256];
+    while(fgets(line,sizeof(line),f)) {
+      int mb, chip, inv;
+      if(line[0]=='#') continue;
+      if(sscanf(line,"%d %d %d",&mb,&chip,&inv) == 3)
+	SetInverted(mb,chip,inv!=0);
+    }
+    fclose(f);
+    return true;
+  }
+
+  // Unpacks Nstrips strips of motherboard mb starting at strip and returns
+  // the pointer behind the last strip read. Hits beyond MaxHits are dropped.
+  unsigned short* Unpack(unsigned short* strip, int Nstrips, int mb, ASICHit& Si) const {
+    const Int_t* sgn = sign[mb];
+    const Int_t* off = offset[mb];
+    Int_t n = Si.Nhits;
+    int istrip = 0;
+    for (; istrip<Nstrips && n<MaxHits; istrip++, strip+=3) {
+      unsigned int id = strip[0];
+      unsigned int chipNum = (id&0x1FE0)>>5;
+      unsigned int chanNum = id&0x1F;
+      Si.MBID[n] = mb;
+      Si.CBID[n] = chipNum;
+      Si.ChNum[n] = chanNum;
+      Si.Energy[n] = off[chipNum] + sgn[chipNum]*strip[1];
+      Si.Time[n] = strip[2];
+      n += (chanNum<16);
+    }
+    if (n<MaxHits) { //a dropped last strip is left in slot n, keep it zero
+      Si.MBID[n] = 0;
+      Si.CBID[n] = 0;
+      Si.ChNum[n] = 0;
+      Si.Energy[n] = 0;
+      Si.Time[n] = 0;
+    }
+    Si.Nhits = n;
+    return strip + 3*(Nstrips-istrip);
+  }
+};
+
+// The table used by the converters, filled on first use.
+inline const ASICUnpacker& DefaultASICUnpacker() {
+  static const ASICUnpacker asics;
+  return asics;
+}
+
+#endif
@@ -0,0 +1,120 @@
+/***************************************************************
+Class: CAENAcceptance
+Decides for every CAEN data word (GEO address, channel) whether it is
+kept as an ADC hit, kept as a TDC hit or dropped.
+
+The configuration is read once at startup and compiled into a
+GEO x channel table, so the decoder needs a single lookup per word.
+Each configuration line has the form
+
+  <ADC|TDC> <GEO> <ID> <channels>
+
+where ID is the value stored in ADC.ID/TDC.ID and channels is a list
+of channels and ranges, e.g. "0-15 24 28". Lines starting with # are
+comments. Channels that are not listed are dropped, so removing a
+module or channel from the file removes it from the raw tree.
+
+Without a configuration file the table reproduces the selection that
+was hard-coded in evt2root_NSCL11.C (see caen_channels.dat).
+****************************************************************/
+#ifndef CAENACCEPTANCE_H
+#define CAENACCEPTANCE_H
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class CAENAcceptance {
+ public:
+  enum Route { kDrop = 0, kADC = 1, kTDC = 2 };
+  static const int kMaxGEO = 32;  //GEO addresses are 5 bits
+  static const int kMaxChan = 32; //channels are 5 bits
+
+ private:
+  unsigned char route[kMaxGEO][kMaxChan];
+  int id[kMaxGEO];
+
+ public:
+  CAENAcceptance() { SetDefault(); }
+
+  void Clear() {
+    memset(route,kDrop,sizeof(route));
+    for(int geo=0; geo<kMaxGEO; geo++) id[geo] = geo;
+  }
+
+  // PC & IC ADCs (GEO 2 and 3) and the RF/MCP TDC (GEO 12)
+  void SetDefault() {
+    Clear();
+    Set(kADC,2,2,0,31);
+    Set(kADC,3,3,0,15);
+    Set(kADC,3,3,24,24);
+    Set(kADC,3,3,28,28);
+    Set(kTDC,12,2,0,0);
+    Set(kTDC,12,2,7,7);
+  }
+
+  // Routes channels [first,last] of module geo to r with the given ID.
+  void Set(Route r, int geo, int ID, int first, int last) {
+    if(geo<0 || geo>=kMaxGEO) return;
+    id[geo] = ID;
+    for(int chn=first; chn<=last; chn++)
+      if(chn>=0 && chn<kMaxChan) route[geo][chn] = r;
+  }
+
+  // Replaces the table with the content of a configuration file. Returns
+  // false (and keeps the current table) if the file cannot be read.
+  bool Load(const char* name) {
+    FILE* f = fopen(name,"r");
+    if(!f) return false;
+    Clear();
+    char line[512];
+    while(fgets(line,sizeof(line),f)) {
+      char* hash = strchr(line,'#');
+      if(hash) *hash = 0;
+      char* tok = strtok(line," \t\r\n");
+      if(!tok) continue;
+      Route r = kDrop;
+      if(strcmp(tok,"ADC")==0) r = kADC;
+      else if(strcmp(tok,"TDC")==0) r = kTDC;
+      else {
+	printf("  * %s: unknown destination %s\n",name,tok);
+	continue;
+      }
+      char* geo = strtok(NULL," \t\r\n");
+      char* ID = strtok(NULL," \t\r\n");
+      if(!geo || !ID) continue;
+      while((tok = strtok(NULL," \t\r\n,"))) {
+	int first, last;
+	if(sscanf(tok,"%d-%d",&first,&last)==2)
+	  Set(r,atoi(geo),atoi(ID),first,last);
+	else
+	  Set(r,atoi(geo),atoi(ID),atoi(tok),atoi(tok));
+      }
+    }
+    fclose(f);
+    return true;
+  }
+
+  int GetRoute(unsigned int geo, unsigned int chn) const { return route[geo&0x1f][chn&0x1f]; }
+  int GetID(unsigned int geo) const { return id[geo&0x1f]; }
+
+  void Print() const {
+    const char* label[3] = {"","ADC","TDC"};
+    for(int geo=0; geo<kMaxGEO; geo++) {
+      for(int r=kADC; r<=kTDC; r++) {
+	int n = 0;
+	for(int chn=0; chn<kMaxChan; chn++) n += route[geo][chn]==r;
+	if(n) printf("   %s GEO %2d (ID %d): %d channels\n",label[r],geo,id[geo],n);
+      }
+    }
+  }
+};
+
+// The table used by the converters. Load() it before decoding starts.
+inline CAENAcceptance& DefaultCAENAcceptance() {
+  static CAENAcceptance caen;
+  return caen;
+}
+
+#endif
@@ -0,0 +1,235 @@
+/////////////////////////////////////////////////////////////////////////////////////
+// Decoder for the NSCLDAQ-11 physics ring items written by the ANASEN DAQ.
+// See readme.md for general instructions.
+//
+// DecodePhysicsEvent() takes a pointer to the body of one physics ring item
+// (the word count that starts the event) and unpacks the two ASICs
+// motherboards (0xaaaa, 0xbbbb, see ASICUnpacker.h) and the CAEN modules
+// (0xcccc, channels selected by CAENAcceptance.h) into a PhysicsEvent.
+// It has no global state, so several events can be decoded at the same
+// time on different threads. The sections are unpacked by
+// UnpackASICsBlock() and UnpackCAENBlocks(), which are also the Unpack()
+// of the ASICS_MB and CAEN_HITS modules of VM_Module.hpp.
+//
+// Usage: Include in evt2root_NSCL11.C, EvtRunReader.h, VM_Module.hpp
+/////////////////////////////////////////////////////////////////////////////////////
+#ifndef EvtDecode_h
+#define EvtDecode_h
+
+#include <TROOT.h>
+#include <TTree.h>
+
+#include "../include/2016_detclass.h"
+#include "ASICUnpacker.h"
+#include "CAENAcceptance.h"
+
+//////////////////////////////////////////////////////////////////////////////////////
+class PhysicsEvent {
+  // This class holds one decoded physics event
+ public:
+  PhysicsEvent(){};
+  ASICHit Si;
+  CAENHit ADC;
+  CAENHit TDC;
+
+  UInt_t ASICs;       //number of ASICs motherboards read out
+  UInt_t CAEN;        //number of CAEN blocks (0xcccc) found
+  UInt_t EOB_NEvents; //event counter from the last CAEN end-of-block, 0 if none
+
+  void Reset() {
+    Si.ResetASICHit();
+    ADC.ResetCAENHit();
+    TDC.ResetCAENHit();
+    ASICs = 0;
+    CAEN = 0;
+    EOB_NEvents = 0;
+  };
+};
+
+//////////////////////////////////////////////////////////////////////////////////////
+// Copies the hits of one event into another. Only the first Nhits entries of
+// each array are copied, which is all that the DataTree branches write out.
+inline void CopyPhysicsEvent(const PhysicsEvent& from, PhysicsEvent& to) {
+  to.Reset();
+  to.Si.Nhits = from.Si.Nhits;
+  for (Int_t i=0; i<from.Si.Nhits; i++) {
+    to.Si.MBID[i] = from.Si.MBID[i];
+    to.Si.CBID[i] = from.Si.CBID[i];
+    to.Si.ChNum[i] = from.Si.ChNum[i];
+    to.Si.Energy[i] = from.Si.Energy[i];
+    to.Si.Time[i] = from.Si.Time[i];
+  }
+  to.ADC.Nhits = from.ADC.Nhits;
+  for (Int_t i=0; i<from.ADC.Nhits; i++) {
+    to.ADC.ID[i] = from.ADC.ID[i];
+    to.ADC.ChNum[i] = from.ADC.ChNum[i];
+    to.ADC.Data[i] = from.ADC.Data[i];
+  }
+  to.TDC.Nhits = from.TDC.Nhits;
+  for (Int_t i=0; i<from.TDC.Nhits; i++) {
+    to.TDC.ID[i] = from.TDC.ID[i];
+    to.TDC.ChNum[i] = from.TDC.ChNum[i];
+    to.TDC.Data[i] = from.TDC.Data[i];
+  }
+  to.ASICs = from.ASICs;
+  to.CAEN = from.CAEN;
+  to.EOB_NEvents = from.EOB_NEvents;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// Creates the branches of the DataTree (as read by analysis_software/Main.cpp)
+// with their addresses in ev, so that tree->Fill() writes the current event.
+inline void BranchPhysicsEvent(TTree* tree, PhysicsEvent& ev) {
+  tree->Branch("Si.Nhits",&ev.Si.Nhits,"SiNhits/I");
+  tree->Branch("Si.MBID",ev.Si.MBID,"MBID[SiNhits]/I");
+  tree->Branch("Si.CBID",ev.Si.CBID,"CBID[SiNhits]/I");
+  tree->Branch("Si.ChNum",ev.Si.ChNum,"ChNum[SiNhits]/I");
+  tree->Branch("Si.Energy",ev.Si.Energy,"Energy[SiNhits]/I");
+  tree->Branch("Si.Time",ev.Si.Time,"Time[SiNhits]/I");
+
+  tree->Branch("ADC.Nhits",&ev.ADC.Nhits,"ADCNhits/I");
+  tree->Branch("ADC.ID",ev.ADC.ID,"ID[ADCNhits]/I");
+  tree->Branch("ADC.ChNum",ev.ADC.ChNum,"ChNum[ADCNhits]/I");
+  tree->Branch("ADC.Data",ev.ADC.Data,"Data[ADCNhits]/I");
+
+  tree->Branch("TDC.Nhits",&ev.TDC.Nhits,"TDCNhits/I");
+  tree->Branch("TDC.ID",ev.TDC.ID,"ID[TDCNhits]/I");
+  tree->Branch("TDC.ChNum",ev.TDC.ChNum,"ChNum[TDCNhits]/I");
+  tree->Branch("TDC.Data",ev.TDC.Data,"Data[TDCNhits]/I");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// The sections of a physics event. DecodePhysicsEvent() reads them in the order
+// of the ANASEN readout; the module stack of evt2root_NSCL11.C (modules_NSCL11.dat,
+// ASICS_MB and CAEN_HITS in VM_Module.hpp) calls the same functions.
+//////////////////////////////////////////////////////////////////////////////////////
+
+// The strip block of one ASICs motherboard (mbid), which starts with marker; up to
+// search more words are skipped to find it. Returns the pointer after the block, or
+// after the words read if the marker is not found.
+inline unsigned short* UnpackASICsBlock(unsigned short* fpoint, unsigned short marker, int search,
+					int mbid, PhysicsEvent& ev) {
+  int XLMdata = *fpoint++;
+  int counter = 0;
+  while (XLMdata != marker && counter < search) {
+    XLMdata = *fpoint++;
+    counter++;
+  }
+
+  if (XLMdata==marker) {
+    ev.ASICs++;
+    fpoint += 3;
+
+    unsigned short Nstrips = *fpoint;
+    fpoint+=5;
+    fpoint = DefaultASICUnpacker().Unpack(fpoint,Nstrips,mbid,ev.Si);
+  }
+  return fpoint;
+}
+
+// The CAEN modules: the blocks after marker (0xcccc), up to end, with the channels
+// selected by CAENAcceptance.h. Returns the pointer after the last block.
+inline unsigned short* UnpackCAENBlocks(unsigned short* fpoint, unsigned short* end, unsigned short marker,
+					PhysicsEvent& ev) {
+  CAENHit& ADC = ev.ADC;
+  CAENHit& TDC = ev.TDC;
+  const CAENAcceptance& caen = DefaultCAENAcceptance();
+
+  int CAEN = *fpoint++;
+
+  while (CAEN != marker) {
+    CAEN = *fpoint++;
+    if(fpoint>end) break;
+  }
+
+  if (CAEN==marker) ev.CAEN++;
+
+  while (fpoint < end) {
+    if(*fpoint == 0xffff ) {
+      fpoint++;
+      continue;
+    }
+
+    unsigned short *gpoint = fpoint;
+    unsigned short chanCount = (*(gpoint++) & 0xff00)>>8;
+    unsigned short GEOaddress = (*(gpoint++) & 0xf800)>>11;
+
+    int i;
+
+    for (i=0;i<chanCount;i++) {
+      if(i>31) continue;
+
+      unsigned short ov  = (*gpoint&0x1000)>>12;
+      unsigned short un  = (*gpoint&0x2000)>>13;
+      unsigned short dat = (*(gpoint++)&0xfff);
+      unsigned short geo = (*gpoint&0xf800)>>11;
+      unsigned short chn = (*(gpoint++)&0x1f);
+
+      if (geo == GEOaddress) {
+	//keep, route or drop the channel (see CAENAcceptance.h)
+	switch (caen.GetRoute(GEOaddress,chn)) {
+	case CAENAcceptance::kADC:
+	  if (ADC.Nhits >= MaxCaenHits) {
+	    continue;
+	  }
+	  ADC.ID[ADC.Nhits] = caen.GetID(GEOaddress);
+	  ADC.ChNum[ADC.Nhits] = chn;
+	  if (ov) {
+	    ADC.Data[ADC.Nhits++] = 5000;
+	  } else if (un) {
+	    ADC.Data[ADC.Nhits++] = -1000;
+	  } else {
+	    ADC.Data[ADC.Nhits++] = dat;
+	  }
+	  break;
+
+	case CAENAcceptance::kTDC:
+	  if (TDC.Nhits >= MaxCaenHits) {
+	    continue;
+	  }
+	  TDC.ID[TDC.Nhits] = caen.GetID(GEOaddress);
+	  TDC.ChNum[TDC.Nhits] = chn;
+	  TDC.Data[TDC.Nhits++] = dat;
+	  break;
+	}
+      }// end of if(geo)
+    }//end of for(chanCount)
+
+    unsigned short EOB_l = *(gpoint++);
+    unsigned short EOB_h = *(gpoint++);
+    unsigned short EOB_bit;
+
+    unsigned short geo = (EOB_h&0xf800)>>11;
+    EOB_bit = (EOB_h&0x0400)>>10;
+
+    if (geo == GEOaddress && EOB_bit) {
+      ev.EOB_NEvents = EOB_l+(EOB_h&0x00ff)*65536+1;
+    }
+
+    while ((gpoint < end )&&(*gpoint==0xffff)) {
+      gpoint ++;
+    }
+
+    // go to next CAEN data
+    fpoint = gpoint;
+  }
+  return fpoint;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// Function where a physics event is unpacked: MB1 (0xaaaa, right after the word
+// count), MB2 (0xbbbb, within 12 words) and the CAEN blocks (0xcccc).
+//////////////////////////////////////////////////////////////////////////////////////
+inline void DecodePhysicsEvent(unsigned short* epoint, PhysicsEvent& ev) {
+  ev.Reset();
+
+  //create pointer inside of each  event
+  unsigned short * fpoint = epoint;
+  unsigned int words = *fpoint++;
+
+  fpoint = UnpackASICsBlock(fpoint,0xaaaa,0,1,ev);
+  fpoint = UnpackASICsBlock(fpoint,0xbbbb,11,2,ev);
+  UnpackCAENBlocks(fpoint,epoint+words,0xcccc,ev);
+}//end of DecodePhysicsEvent()
+
+#endif
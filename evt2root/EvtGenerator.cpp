@@ -0,0 +1,60 @@
+/* Program: EvtGenerator.cpp
+ * Description: Writes a synthetic run <output_dir>/run-XXXX-00.evt (see
+ * EvtGenerator.h) for timing evt2root without beam data.
+ * See readme.md for general instructions.
+ *
+ * Compile: g++ -O2 EvtGenerator.cpp -o evtgen.out
+ * Run:     ./evtgen.out <output_dir>/ 9999 [-n events] [-s1 strips] [-s2 strips]
+ *                       [-a adc_channels] [-t tdc_channels] [-seed seed]
+ */
+
+//C and C++ libraries
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "EvtGenerator.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+  if(argc < 3) {
+    printf("Usage: %s <output_dir> run [-n events] [-s1 strips] [-s2 strips] [-a adc_channels] [-t tdc_channels] [-seed seed]\n",argv[0]);
+    return 1;
+  }
+
+  string dir = argv[1];
+  int run = atoi(argv[2]);
+  long long nevents = 100000;
+  EvtGenerator gen;
+  for(int i=3; i+1<argc; i+=2) {
+    if(strcmp(argv[i],"-n") == 0) nevents = atoll(argv[i+1]);
+    else if(strcmp(argv[i],"-s1") == 0) gen.StripsMB1 = atoi(argv[i+1]);
+    else if(strcmp(argv[i],"-s2") == 0) gen.StripsMB2 = atoi(argv[i+1]);
+    else if(strcmp(argv[i],"-a") == 0) gen.ChannelsADC = atoi(argv[i+1]);
+    else if(strcmp(argv[i],"-t") == 0) gen.ChannelsTDC = atoi(argv[i+1]);
+    else if(strcmp(argv[i],"-seed") == 0) gen.Seed = strtoull(argv[i+1],NULL,0);
+    else {
+      printf(" *** Error: unknown option %s\n",argv[i]);
+      return 1;
+    }
+  }
+  if(gen.ChannelsADC > 32) gen.ChannelsADC = 32;
+  if(gen.ChannelsTDC > 32) gen.ChannelsTDC = 32;
+
+  char name[64];
+  sprintf(name,"run-%.4d-00.evt",run);
+  string path = dir + name;
+  printf(" Writing %lld events to %s\n",nevents,path.c_str());
+  printf("  strips MB1 %d, MB2 %d (mean), ADC channels %d, TDC channels %d\n",
+	 gen.StripsMB1,gen.StripsMB2,gen.ChannelsADC,gen.ChannelsTDC);
+  unsigned long long nbytes = gen.Write(path.c_str(),run,nevents);
+  if(nbytes == 0) {
+    printf(" *** Error: could not write %s\n",path.c_str());
+    return 1;
+  }
+  printf("  %.1f MB, %.0f bytes/event\n",nbytes/1048576.,nevents>0 ? (double)nbytes/nevents : 0.);
+  return 0;
+}
@@ -0,0 +1,144 @@
+/***************************************************************
+Class: EvtGenerator
+Writes synthetic NSCLDAQ-11 .evt segments in the format read by
+evt2root_NSCL11.C, so that the converter can be timed without beam
+data.
+
+A segment starts with a begin-run item (type 0x01) and ends with an
+end-run item (type 0x02); the physics items (type 0x1E) in between
+hold, in the order expected by DecodePhysicsEvent():
+  - the MB1 (0xaaaa) and MB2 (0xbbbb) ASICs blocks with a random
+    number of strips in [0,2*StripsMB1] and [0,2*StripsMB2], on chips
+    1-14 (MB1) and 1-10 (MB2) and channels 0-31,
+  - the CAEN blocks (0xcccc) of the ADCs at GEO 2 and 3 with
+    ChannelsADC channels each and the TDC at GEO 12 with ChannelsTDC
+    channels, every block closed by an end-of-block word and a
+    0xffff filler.
+Energies, times and CAEN data are random; the sequence depends only
+on Seed.
+
+Usage:
+  EvtGenerator gen;
+  gen.StripsMB1 = 64;
+  gen.Write("/tmp/run-9999-00.evt",9999,100000);
+****************************************************************/
+#ifndef EVTGENERATOR_H
+#define EVTGENERATOR_H
+
+// C includes
+#include <stdio.h>
+#include <string.h>
+
+// C++ includes
+#include <vector>
+
+class EvtGenerator {
+  std::vector<unsigned short> body; //physics item body, in 16-bit words
+  unsigned long long state;
+  unsigned int nread;               //CAEN event counter
+
+  unsigned int Random(unsigned int n) { //xorshift64*, uniform in [0,n)
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (unsigned int)(((state * 2685821657736338717ULL) >> 32) % n);
+  }
+
+  void AddASICs(unsigned short tag, int mean, int nchips) {
+    int nstrips = mean > 0 ? Random(2*mean+1) : 0;
+    body.push_back(tag);
+    body.push_back(0);
+    body.push_back(0);
+    body.push_back(0);
+    body.push_back(nstrips);
+    for(int i=0; i<4; i++) body.push_back(0);
+    for(int i=0; i<nstrips; i++) {
+      body.push_back(((1 + Random(nchips))<<5) | Random(32));
+      body.push_back(Random(16384));
+      body.push_back(Random(16384));
+    }
+  }
+
+  // One CAEN V785/V775 block: header, data words and end-of-block, each
+  // 32 bits written as low and high 16-bit words.
+  void AddCAEN(unsigned int geo, int nchan) {
+    body.push_back(nchan<<8);
+    body.push_back((geo<<11) | 0x0200);
+    int chn = Random(32);
+    for(int i=0; i<nchan; i++) {
+      unsigned int data = Random(4096);
+      unsigned int flag = Random(100);
+      if(flag == 0) data |= 0x1000;      //overflow
+      else if(flag == 1) data |= 0x2000; //underthreshold
+      body.push_back(data);
+      body.push_back((geo<<11) | ((chn + i)&0x1f));
+    }
+    body.push_back(nread & 0xffff);
+    body.push_back((geo<<11) | 0x0400 | ((nread>>16) & 0xff));
+    body.push_back(0xffff);
+    body.push_back(0xffff);
+  }
+
+  static bool WriteItem(FILE* f, unsigned int type, const void* data, size_t size) {
+    unsigned int header[3] = {(unsigned int)(12 + size), type, 0};
+    return fwrite(header,sizeof(header),1,f) == 1 && (size == 0 || fwrite(data,size,1,f) == 1);
+  }
+
+  // Begin/end-run items carry a 20-byte body header before the run
+  // number, as written by the DAQ (the converter prints the run number).
+  static bool WriteStateChange(FILE* f, unsigned int type, int run, unsigned int time) {
+    unsigned int item[6+4] = {20,0,0,0,0,(unsigned int)run,time,time,1,0};
+    char title[84];
+    memset(title,0,sizeof(title));
+    strcpy(title,"evtgen synthetic run");
+    unsigned int header[2] = {(unsigned int)(8 + sizeof(item) + sizeof(title)), type};
+    return fwrite(header,sizeof(header),1,f) == 1 && fwrite(item,sizeof(item),1,f) == 1
+      && fwrite(title,sizeof(title),1,f) == 1;
+  }
+
+ public:
+  int StripsMB1;   //mean number of MB1 strips per event
+  int StripsMB2;   //mean number of MB2 strips per event
+  int ChannelsADC; //channels read from each of the ADCs at GEO 2 and 3
+  int ChannelsTDC; //channels read from the TDC at GEO 12
+  unsigned long long Seed;
+
+  EvtGenerator() : state(1), nread(0), StripsMB1(32), StripsMB2(16),
+    ChannelsADC(16), ChannelsTDC(2), Seed(1) {}
+
+  // Builds the body of the next physics item; returns its size in words.
+  const std::vector<unsigned short>& MakeEvent() {
+    body.clear();
+    body.push_back(0); //word count, set below
+    AddASICs(0xaaaa,StripsMB1,14);
+    AddASICs(0xbbbb,StripsMB2,10);
+    body.push_back(0xcccc);
+    AddCAEN(2,ChannelsADC);
+    AddCAEN(3,ChannelsADC);
+    AddCAEN(12,ChannelsTDC);
+    nread++;
+    body[0] = body.size();
+    return body;
+  }
+
+  // Writes a segment with nevents physics items. Returns the number of
+  // bytes written, or 0 on error.
+  unsigned long long Write(const char* name, int run, long long nevents) {
+    FILE* f = fopen(name,"wb");
+    if(!f) return 0;
+    state = Seed ? Seed : 1;
+    nread = 0;
+    bool ok = WriteStateChange(f,0x01,run,0);
+    unsigned long long nbytes = 0;
+    for(long long i=0; ok && i<nevents; i++) {
+      const std::vector<unsigned short>& ev = MakeEvent();
+      ok = WriteItem(f,0x1E,&ev[0],2*ev.size());
+    }
+    ok = ok && WriteStateChange(f,0x02,run,nevents/1000);
+    if(ok) nbytes = ftell(f);
+    if(fclose(f) != 0) nbytes = 0;
+    return nbytes;
+  }
+};
+
+#endif
@@ -0,0 +1,213 @@
+/***************************************************************
+Classes: IntHist1, IntHist2, EvtHistograms
+Fixed-binning integer histograms for the online histograms of
+evt2root (hit pattern, energy and time vs channel of both ASICs
+motherboards).
+
+A fill is a bin lookup and an array increment, with no ROOT call, so
+every decoder thread can keep its own copy. At the end of the run the
+copies are added (Add) and the sum is written once into the TH1I/TH2I
+objects of the converter (CopyTo), which then hold exactly what
+TH1I::Fill() and TH2I::Fill() would have given: the same bins (ROOT's
+TAxis::FindFixBin formula), under/overflows, number of entries and
+statistics. CopyTo replaces the content of the histogram: a TH1 with
+entries but no sum of weights recomputes its statistics from the bin
+centres in GetStats(), so a copy is never added onto another.
+
+The statistics (sum of x, x^2, ...) are double sums, and their last
+bits depend on the order of the fills. FillCounts() and FillStats()
+are therefore separate: the counts may be filled on any thread, the
+statistics are filled on one thread in event order.
+****************************************************************/
+#ifndef EVTHISTOGRAMS_H
+#define EVTHISTOGRAMS_H
+
+// C++ includes
+#include <vector>
+
+#include <TH1I.h>
+#include <TH2I.h>
+
+#include "../include/2016_detclass.h"
+
+class IntHist1 {
+  Int_t nx;
+  Double_t xmin, xmax;
+ public:
+  std::vector<Int_t> counts; //nx+2 bins with under/overflow, as in TH1I
+  Long64_t entries;
+  Double_t stats[4];         //sumw, sumw2, sumwx, sumwx2
+
+  IntHist1(Int_t n=1, Double_t x0=0, Double_t x1=1) : nx(n), xmin(x0), xmax(x1), counts(n+2,0), entries(0) {
+    for(int i=0; i<4; i++) stats[i] = 0;
+  }
+
+  Int_t FindBin(Double_t x) const {
+    if(x < xmin) return 0;
+    if(!(x < xmax)) return nx+1;
+    return 1 + Int_t(nx*(x-xmin)/(xmax-xmin));
+  }
+
+  void FillCount(Double_t x) {
+    counts[FindBin(x)]++;
+    entries++;
+  }
+  void FillStats(Double_t x) {
+    Int_t bin = FindBin(x);
+    if(bin == 0 || bin > nx) return;
+    stats[0]++;
+    stats[1]++;
+    stats[2] += x;
+    stats[3] += x*x;
+  }
+
+  void Reset() {
+    counts.assign(counts.size(),0);
+    entries = 0;
+    for(int i=0; i<4; i++) stats[i] = 0;
+  }
+
+  void Add(const IntHist1& h) {
+    for(size_t i=0; i<counts.size(); i++) counts[i] += h.counts[i];
+    entries += h.entries;
+    for(int i=0; i<4; i++) stats[i] += h.stats[i];
+  }
+
+  void CopyTo(TH1I* h) const {
+    Double_t s[4];
+    Int_t* a = h->GetArray();
+    for(size_t i=0; i<counts.size(); i++) a[i] = counts[i];
+    for(int i=0; i<4; i++) s[i] = stats[i];
+    h->PutStats(s);
+    h->SetEntries(entries);
+  }
+};
+
+class IntHist2 {
+  Int_t nx, ny;
+  Double_t xmin, xmax, ymin, ymax;
+
+  static Int_t FindBin(Double_t x, Int_t n, Double_t x0, Double_t x1) {
+    if(x < x0) return 0;
+    if(!(x < x1)) return n+1;
+    return 1 + Int_t(n*(x-x0)/(x1-x0));
+  }
+
+ public:
+  std::vector<Int_t> counts; //(nx+2)*(ny+2) bins, x running fastest, as in TH2I
+  Long64_t entries;
+  Double_t stats[7];         //sumw, sumw2, sumwx, sumwx2, sumwy, sumwy2, sumwxy
+
+  IntHist2(Int_t n=1, Double_t x0=0, Double_t x1=1, Int_t m=1, Double_t y0=0, Double_t y1=1)
+    : nx(n), ny(m), xmin(x0), xmax(x1), ymin(y0), ymax(y1), counts((n+2)*(m+2),0), entries(0) {
+    for(int i=0; i<7; i++) stats[i] = 0;
+  }
+
+  void FillCount(Double_t x, Double_t y) {
+    counts[FindBin(y,ny,ymin,ymax)*(nx+2) + FindBin(x,nx,xmin,xmax)]++;
+    entries++;
+  }
+  void FillStats(Double_t x, Double_t y) {
+    Int_t binx = FindBin(x,nx,xmin,xmax);
+    Int_t biny = FindBin(y,ny,ymin,ymax);
+    if(binx == 0 || binx > nx || biny == 0 || biny > ny) return;
+    stats[0]++;
+    stats[1]++;
+    stats[2] += x;
+    stats[3] += x*x;
+    stats[4] += y;
+    stats[5] += y*y;
+    stats[6] += x*y;
+  }
+
+  void Reset() {
+    counts.assign(counts.size(),0);
+    entries = 0;
+    for(int i=0; i<7; i++) stats[i] = 0;
+  }
+
+  void Add(const IntHist2& h) {
+    for(size_t i=0; i<counts.size(); i++) counts[i] += h.counts[i];
+    entries += h.entries;
+    for(int i=0; i<7; i++) stats[i] += h.stats[i];
+  }
+
+  void CopyTo(TH2I* h) const {
+    Double_t s[7];
+    Int_t* a = h->GetArray();
+    for(size_t i=0; i<counts.size(); i++) a[i] = counts[i];
+    for(int i=0; i<7; i++) s[i] = stats[i];
+    h->PutStats(s);
+    h->SetEntries(entries);
+  }
+};
+
+// The ASICs histograms of evt2root_NSCL11.C, index 0 for MB1 and 1 for MB2.
+// The channel of a strip is CBID*16-16+ChNum.
+class EvtHistograms {
+ public:
+  IntHist1 HitPattern[2];
+  IntHist2 ChanEn[2];
+  IntHist2 ChanT[2];
+
+  EvtHistograms(Int_t xbins, Int_t ybins, Double_t ymax) {
+    for(int mb=0; mb<2; mb++) {
+      HitPattern[mb] = IntHist1(xbins,0,xbins);
+      ChanEn[mb] = IntHist2(xbins,0,xbins,ybins,0,ymax);
+      ChanT[mb] = IntHist2(xbins,0,xbins,ybins,0,ymax);
+    }
+  }
+
+  void FillCounts(const ASICHit& Si) {
+    for(Int_t n=0; n<Si.Nhits; n++) {
+      Int_t chan = Si.CBID[n]*16-16+Si.ChNum[n];
+      Int_t mb = Si.MBID[n]==1 ? 0 : 1;
+      HitPattern[mb].FillCount(chan);
+      ChanEn[mb].FillCount(chan,Si.Energy[n]);
+      ChanT[mb].FillCount(chan,Si.Time[n]);
+    }
+  }
+
+  void FillStats(const ASICHit& Si) {
+    for(Int_t n=0; n<Si.Nhits; n++) {
+      Int_t chan = Si.CBID[n]*16-16+Si.ChNum[n];
+      Int_t mb = Si.MBID[n]==1 ? 0 : 1;
+      HitPattern[mb].FillStats(chan);
+      ChanEn[mb].FillStats(chan,Si.Energy[n]);
+      ChanT[mb].FillStats(chan,Si.Time[n]);
+    }
+  }
+
+  void Fill(const ASICHit& Si) {
+    FillCounts(Si);
+    FillStats(Si);
+  }
+
+  void Reset() {
+    for(int mb=0; mb<2; mb++) {
+      HitPattern[mb].Reset();
+      ChanEn[mb].Reset();
+      ChanT[mb].Reset();
+    }
+  }
+
+  void Add(const EvtHistograms& h) {
+    for(int mb=0; mb<2; mb++) {
+      HitPattern[mb].Add(h.HitPattern[mb]);
+      ChanEn[mb].Add(h.ChanEn[mb]);
+      ChanT[mb].Add(h.ChanT[mb]);
+    }
+  }
+
+  // Replaces the content of the ROOT histograms with this one
+  void CopyTo(TH1I* hit1, TH1I* hit2, TH2I* en1, TH2I* en2, TH2I* t1, TH2I* t2) const {
+    HitPattern[0].CopyTo(hit1);
+    HitPattern[1].CopyTo(hit2);
+    ChanEn[0].CopyTo(en1);
+    ChanEn[1].CopyTo(en2);
+    ChanT[0].CopyTo(t1);
+    ChanT[1].CopyTo(t2);
+  }
+};
+
+#endif
@@ -0,0 +1,186 @@
+/***************************************************************
+Class: EvtIndex
+Byte-offset index of the ring items of one run (all its .evt segments).
+
+For every ring item the index holds the segment number, the byte offset
+of the item inside the segment, the ring item type (0x1E physics,
+0x01/0x02 begin/end of run, ...) and the event counter, i.e. the number
+of physics items before it in the run. With it a converter can jump
+straight to physics event N of a run instead of parsing every segment
+from the start.
+
+The index is built in one pass over the segments and stored next to
+them in a sidecar file run-XXXX.evt.idx. The sizes of the segments are
+stored as well, so a stale index (segment rewritten or appended) is
+detected on Load() and rebuilt.
+
+Usage:
+  EvtIndex index;
+  if(index.Load(data_dir,1193)) {
+    const EvtIndexEntry* e = index.FindEvent(250000);
+    //open segment e->segment, EvtReader::Seek(e->offset)
+  }
+****************************************************************/
+#ifndef EVTINDEX_H
+#define EVTINDEX_H
+
+// C includes
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+
+// C++ includes
+#include <string>
+#include <vector>
+
+#include "EvtReader.h"
+
+struct EvtIndexEntry {
+  unsigned long long offset; //byte offset of the ring item in its segment
+  unsigned long long event;  //number of physics items before this one in the run
+  unsigned int segment;      //segment number (run-XXXX-SS.evt)
+  unsigned int type;         //ring item type
+};
+
+class EvtIndex {
+  std::vector<EvtIndexEntry> entries;
+  std::vector<unsigned long long> segsize; //size of each segment, 0 if missing
+  unsigned long long nphysics;
+
+  static const unsigned int kVersion = 1;
+
+  static unsigned long long FileSize(const std::string& name) {
+    struct stat st;
+    if(stat(name.c_str(),&st) != 0) return 0;
+    return st.st_size;
+  }
+
+ public:
+  static const int kMaxSegments = 3; //segments tried per run, as in evt2root
+
+  EvtIndex() : nphysics(0) {}
+
+  // Name of a segment on disk, possibly a compressed copy (see EvtReader).
+  static std::string SegmentName(const std::string& dir, int run, int seg) {
+    char name[64];
+    sprintf(name,"run-%.4d-%.2d.evt",run,seg);
+    return EvtReader::FindFile(dir + name);
+  }
+  static std::string IndexName(const std::string& dir, int run) {
+    char name[64];
+    sprintf(name,"run-%.4d.evt.idx",run);
+    return dir + name;
+  }
+
+  // Scans all segments of a run. Returns false if none could be opened or
+  // a compressed one could not be read to the end.
+  bool Build(const std::string& dir, int run) {
+    entries.clear();
+    segsize.assign(kMaxSegments,0);
+    nphysics = 0;
+    bool found = false;
+    EvtReader reader;
+    for(int seg=0; seg<kMaxSegments; seg++) {
+      std::string name = SegmentName(dir,run,seg);
+      if(!reader.Open(name.c_str())) continue;
+      found = true;
+      segsize[seg] = FileSize(name);
+      for(;;) {
+	EvtIndexEntry e;
+	e.offset = reader.Tell();
+	char* item = reader.Next();
+	if(!item) break;
+	e.event = nphysics;
+	e.segment = seg;
+	e.type = *(unsigned int*)(item+4);
+	if(e.type == 0x1E) nphysics++;
+	entries.push_back(e);
+      }
+      reader.Close();
+      if(reader.Failed()) return false;
+    }
+    return found;
+  }
+
+  // Sidecar format: "EVTIDX", version, number of segments, segment sizes,
+  // number of entries, entries.
+  bool Write(const std::string& name) const {
+    FILE* f = fopen(name.c_str(),"wb");
+    if(!f) return false;
+    unsigned int version = kVersion;
+    unsigned int nseg = segsize.size();
+    unsigned long long n = entries.size();
+    bool ok = fwrite("EVTIDX",1,6,f) == 6
+      && fwrite(&version,sizeof(version),1,f) == 1
+      && fwrite(&nseg,sizeof(nseg),1,f) == 1
+      && fwrite(&segsize[0],sizeof(segsize[0]),nseg,f) == nseg
+      && fwrite(&n,sizeof(n),1,f) == 1
+      && (n == 0 || fwrite(&entries[0],sizeof(EvtIndexEntry),n,f) == n);
+    return fclose(f) == 0 && ok;
+  }
+
+  // Reads a sidecar file. Fails if it is missing, corrupt or does not
+  // match the current segment sizes.
+  bool Read(const std::string& dir, int run) {
+    FILE* f = fopen(IndexName(dir,run).c_str(),"rb");
+    if(!f) return false;
+    char magic[6];
+    unsigned int version = 0, nseg = 0;
+    unsigned long long n = 0;
+    bool ok = fread(magic,1,6,f) == 6 && memcmp(magic,"EVTIDX",6) == 0
+      && fread(&version,sizeof(version),1,f) == 1 && version == kVersion
+      && fread(&nseg,sizeof(nseg),1,f) == 1 && nseg == (unsigned int)kMaxSegments;
+    if(ok) {
+      segsize.resize(nseg);
+      ok = fread(&segsize[0],sizeof(segsize[0]),nseg,f) == nseg
+	&& fread(&n,sizeof(n),1,f) == 1;
+    }
+    if(ok) {
+      entries.resize(n);
+      ok = n == 0 || fread(&entries[0],sizeof(EvtIndexEntry),n,f) == n;
+    }
+    fclose(f);
+    for(int seg=0; ok && seg<kMaxSegments; seg++)
+      if(segsize[seg] != FileSize(SegmentName(dir,run,seg))) ok = false;
+    if(!ok) {
+      entries.clear();
+      segsize.clear();
+      return false;
+    }
+    nphysics = 0;
+    if(n > 0)
+      nphysics = entries[n-1].event + (entries[n-1].type == 0x1E ? 1 : 0);
+    return true;
+  }
+
+  // Reads the sidecar of a run, or builds the index and tries to write the
+  // sidecar (a read-only data directory only costs the rebuild next time).
+  bool Load(const std::string& dir, int run) {
+    if(Read(dir,run)) return true;
+    if(!Build(dir,run)) return false;
+    Write(IndexName(dir,run));
+    return true;
+  }
+
+  // The physics item with event counter n, or NULL if the run has fewer
+  // physics events.
+  const EvtIndexEntry* FindEvent(unsigned long long n) const {
+    size_t lo = 0, hi = entries.size();
+    while(lo < hi) {
+      size_t mid = lo + (hi - lo)/2;
+      const EvtIndexEntry& e = entries[mid];
+      if(e.event < n || (e.event == n && e.type != 0x1E)) lo = mid + 1;
+      else hi = mid;
+    }
+    if(lo < entries.size() && entries[lo].type == 0x1E && entries[lo].event == n)
+      return &entries[lo];
+    return NULL;
+  }
+
+  unsigned long long GetNumPhysics() const { return nphysics; }
+  size_t GetNumEntries() const { return entries.size(); }
+  const EvtIndexEntry& GetEntry(size_t i) const { return entries[i]; }
+};
+
+#endif
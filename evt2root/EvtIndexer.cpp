@@ -0,0 +1,61 @@
+/* Program: EvtIndexer.cpp
+ * Description: Builds the sidecar index run-XXXX.evt.idx (see EvtIndex.h)
+ * for the .evt segments of one or more runs, and prints the event ranges
+ * that split each run into equal chunks for evt2root_NSCL11(first,last).
+ * See readme.md for general instructions.
+ *
+ * Compile: g++ -O2 EvtIndexer.cpp SimpleInPipe.cpp -pthread -o evtindex.out
+ * Run:     ./evtindex.out <input_dir>/ 1193 [1194 ...] [-n chunks]
+ */
+
+//C and C++ libraries
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "EvtIndex.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+  if(argc < 3) {
+    printf("Usage: %s <data_dir> run [run ...] [-n chunks]\n",argv[0]);
+    return 1;
+  }
+
+  string data_dir = argv[1];
+  int nchunks = 1;
+  vector<int> runs;
+  for(int i=2; i<argc; i++) {
+    if(strcmp(argv[i],"-n") == 0 && i+1 < argc)
+      nchunks = atoi(argv[++i]);
+    else
+      runs.push_back(atoi(argv[i]));
+  }
+  if(nchunks < 1) nchunks = 1;
+
+  int status = 0;
+  for(size_t r=0; r<runs.size(); r++) {
+    EvtIndex index;
+    if(!index.Build(data_dir,runs[r])) {
+      printf(" run %.4d: no segments found in %s\n",runs[r],data_dir.c_str());
+      status = 1;
+      continue;
+    }
+    string name = EvtIndex::IndexName(data_dir,runs[r]);
+    if(!index.Write(name)) {
+      printf(" run %.4d: could not write %s\n",runs[r],name.c_str());
+      status = 1;
+    }
+    unsigned long long n = index.GetNumPhysics();
+    printf(" run %.4d: %zu ring items, %llu physics events -> %s\n",
+	   runs[r],index.GetNumEntries(),n,name.c_str());
+    if(nchunks > 1)
+      for(int c=0; c<nchunks; c++)
+	printf("   chunk %d: [%llu,%llu)\n",c,n*c/nchunks,n*(c+1)/nchunks);
+  }
+  return status;
+}
@@ -0,0 +1,209 @@
+/***************************************************************
+Class: EvtPipeline
+Decodes physics ring items on a pool of worker threads while keeping
+the original event order for the output.
+
+One reader thread hands ring items to Submit(). Items are collected in
+batches; the worker threads claim slices of the oldest batches and
+decode them into Event objects that are owned by the pipeline. A
+single writer thread calls Next() to receive the decoded events in
+exactly the order in which they were submitted.
+
+The number of batches is fixed, so the reader blocks when the writer
+falls behind and memory use stays bounded.
+
+Items that live in a memory-mapped segment are not copied. Before the
+segment is unmapped the reader must call Sync(), which returns once
+every submitted item has been decoded. Items from a streaming buffer
+are copied on Submit().
+
+Event must provide a default constructor. The decode function is
+called as decode(item, event, worker) where worker is the index of the
+calling thread in [0,nworkers).
+****************************************************************/
+#ifndef EVTPIPELINE_H
+#define EVTPIPELINE_H
+
+// C++ includes
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+template<class Event>
+class EvtPipeline {
+ public:
+  typedef void (*DecodeFunc)(unsigned short* item, Event& ev, int worker);
+
+ private:
+  struct Batch {
+    std::vector<unsigned short*> items;
+    std::vector< std::vector<char> > store; //copies of streamed items
+    std::vector<Event> events;
+    int n;       //number of items submitted
+    int claimed; //number of items handed to workers
+    int done;    //number of items decoded
+  };
+
+  static const int kSlice = 16; //items claimed by a worker at once
+
+  DecodeFunc decode;
+  int nworkers;
+  int batchsize;
+
+  std::vector<Batch*> batches;
+  std::vector<Batch*> freelist;
+  std::deque<Batch*> inflight;  //submitted batches in order
+  Batch* current;               //batch being filled by the reader
+  Batch* writing;               //batch being read by the writer
+  int windex;
+  bool finished;
+
+  std::mutex mtx;
+  std::condition_variable cv_free;    //reader waits for a free batch
+  std::condition_variable cv_work;    //workers wait for items
+  std::condition_variable cv_done;    //writer and Sync() wait for decoded batches
+  std::vector<std::thread> workers;
+
+  void Publish() {
+    //called with the lock held
+    if(current && current->n > 0) {
+      inflight.push_back(current);
+      current = NULL;
+      cv_work.notify_all();
+    }
+  }
+
+  void Work(int worker) {
+    std::unique_lock<std::mutex> lock(mtx);
+    for(;;) {
+      Batch* b = NULL;
+      for(size_t i=0; i<inflight.size(); i++) {
+	if(inflight[i]->claimed < inflight[i]->n) {
+	  b = inflight[i];
+	  break;
+	}
+      }
+      if(!b) {
+	if(finished) return;
+	cv_work.wait(lock);
+	continue;
+      }
+      int first = b->claimed;
+      int last = first + kSlice < b->n ? first + kSlice : b->n;
+      b->claimed = last;
+      lock.unlock();
+      for(int i=first; i<last; i++)
+	decode(b->items[i], b->events[i], worker);
+      lock.lock();
+      b->done += last - first;
+      if(b->done == b->n)
+	cv_done.notify_all();
+    }
+  }
+
+ public:
+  EvtPipeline(DecodeFunc func, int nthreads, int size = 256)
+    : decode(func), nworkers(nthreads > 0 ? nthreads : 1), batchsize(size),
+      current(NULL), writing(NULL), windex(0), finished(false) {
+    int nbatches = 2*nworkers + 2;
+    for(int i=0; i<nbatches; i++) {
+      Batch* b = new Batch;
+      b->items.resize(batchsize);
+      b->store.resize(batchsize);
+      b->events.resize(batchsize);
+      b->n = b->claimed = b->done = 0;
+      batches.push_back(b);
+      freelist.push_back(b);
+    }
+    for(int i=0; i<nworkers; i++)
+      workers.push_back(std::thread(&EvtPipeline::Work, this, i));
+  }
+
+  ~EvtPipeline() {
+    Finish();
+    for(size_t i=0; i<workers.size(); i++)
+      workers[i].join();
+    for(size_t i=0; i<batches.size(); i++)
+      delete batches[i];
+  }
+
+  // Reader: queue one ring item body. Set copy when the item is only
+  // valid until the next read.
+  void Submit(unsigned short* item, unsigned int nbytes, bool copy) {
+    if(!current) {
+      std::unique_lock<std::mutex> lock(mtx);
+      while(freelist.empty())
+	cv_free.wait(lock);
+      current = freelist.back();
+      freelist.pop_back();
+      current->n = current->claimed = current->done = 0;
+    }
+    int i = current->n;
+    if(copy) {
+      std::vector<char>& store = current->store[i];
+      store.assign((char*)item, (char*)item + nbytes);
+      current->items[i] = (unsigned short*)(&store[0]);
+    }
+    else
+      current->items[i] = item;
+    current->n++;
+    if(current->n == batchsize) {
+      std::lock_guard<std::mutex> lock(mtx);
+      Publish();
+    }
+  }
+
+  // Reader: wait until every submitted item has been decoded, e.g. before
+  // the memory map the items point into is released.
+  void Sync() {
+    std::unique_lock<std::mutex> lock(mtx);
+    Publish();
+    for(;;) {
+      bool busy = false;
+      for(size_t i=0; i<inflight.size(); i++)
+	if(inflight[i]->done < inflight[i]->n) busy = true;
+      if(!busy) return;
+      cv_done.wait(lock);
+    }
+  }
+
+  // Reader: no more items will be submitted.
+  void Finish() {
+    std::lock_guard<std::mutex> lock(mtx);
+    Publish();
+    finished = true;
+    cv_work.notify_all();
+    cv_done.notify_all();
+  }
+
+  // Writer: the next decoded event in submission order, or NULL once the
+  // reader has finished and all events have been returned.
+  Event* Next() {
+    if(writing && windex < writing->n)
+      return &writing->events[windex++];
+
+    std::unique_lock<std::mutex> lock(mtx);
+    if(writing) {
+      freelist.push_back(writing);
+      writing = NULL;
+      cv_free.notify_one();
+    }
+    for(;;) {
+      if(!inflight.empty() && inflight.front()->done == inflight.front()->n) {
+	writing = inflight.front();
+	inflight.pop_front();
+	windex = 0;
+	return &writing->events[windex++];
+      }
+      if(finished && inflight.empty())
+	return NULL;
+      cv_done.wait(lock);
+    }
+  }
+
+  int GetNumWorkers() const { return nworkers; }
+};
+
+#endif
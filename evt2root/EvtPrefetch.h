@@ -0,0 +1,135 @@
+/***************************************************************
+Class: EvtPrefetch
+Reads a SimpleInPipe on a background thread into a ring of large
+buffers, so that the decompressor writing into the pipe and the
+converter reading the ring items run at the same time.
+
+The thread fills the buffers in order and blocks when all of them are
+full; Read() hands the bytes out in the same order and blocks when all
+of them are empty. While Read() is starved a buffer is handed over as
+soon as some data arrived, so a slow live stream is not held back
+until a whole buffer is full.
+
+Usage (see EvtReader):
+  EvtPrefetch ring;
+  ring.Start(&pipe);
+  while((n = ring.Read(dst,max)) > 0) {...}
+  ring.Stop();
+****************************************************************/
+#ifndef EVTPREFETCH_H
+#define EVTPREFETCH_H
+
+// C includes
+#include <string.h>
+
+// C++ includes
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "SimpleInPipe.h"
+
+class EvtPrefetch {
+  SimpleInPipe* in;
+  std::vector< std::vector<char> > ring;
+  std::vector<size_t> filled; //bytes in each buffer
+  size_t rbuf, roffset;       //buffer and offset read next
+  size_t wbuf;                //buffer filled next
+  size_t nfull;               //buffers filled and not yet read
+  bool eof, stop;
+  std::mutex lock;
+  std::condition_variable cond;
+  std::thread thread;
+
+  void Run() {
+    for(;;) {
+      char* dst;
+      size_t size;
+      {
+	std::unique_lock<std::mutex> guard(lock);
+	while(nfull == ring.size() && !stop) cond.wait(guard);
+	if(stop) return;
+	dst = &ring[wbuf][0];
+	size = ring[wbuf].size();
+      }
+      //the buffer being filled is not visible to Read() until nfull grows.
+      //It is handed over when it is full, or earlier if Read() is waiting.
+      size_t n = 0;
+      bool end = false;
+      for(;;) {
+	int actual = in->read_some(dst + n, size - n);
+	if(actual <= 0) {
+	  end = true;
+	  break;
+	}
+	n += actual;
+	if(n == size) break;
+	std::lock_guard<std::mutex> guard(lock);
+	if(nfull == 0) break;
+      }
+      std::lock_guard<std::mutex> guard(lock);
+      filled[wbuf] = n;
+      wbuf = (wbuf + 1) % ring.size();
+      nfull++;
+      if(end) eof = true;
+      cond.notify_all();
+      if(end) return;
+    }
+  }
+
+ public:
+  static const size_t kBuffers = 4;
+  static const size_t kBufferSize = 4*1024*1024;
+
+  EvtPrefetch() : in(NULL), rbuf(0), roffset(0), wbuf(0), nfull(0), eof(true), stop(false) {}
+  ~EvtPrefetch() { Stop(); }
+
+  void Start(SimpleInPipe* pipe, size_t nbuffers = kBuffers, size_t size = kBufferSize) {
+    Stop();
+    in = pipe;
+    ring.assign(nbuffers, std::vector<char>(size));
+    filled.assign(nbuffers, 0);
+    rbuf = roffset = wbuf = nfull = 0;
+    eof = false;
+    stop = false;
+    thread = std::thread(&EvtPrefetch::Run, this);
+  }
+
+  // Copies up to n bytes into dst. Returns 0 at the end of the stream.
+  size_t Read(char* dst, size_t n) {
+    std::unique_lock<std::mutex> guard(lock);
+    while(nfull == 0 && !eof) cond.wait(guard);
+    if(nfull == 0) return 0;
+    size_t avail = filled[rbuf] - roffset;
+    if(n > avail) n = avail;
+    guard.unlock();
+    memcpy(dst, &ring[rbuf][0] + roffset, n); //the thread does not touch full buffers
+    guard.lock();
+    roffset += n;
+    if(roffset == filled[rbuf]) {
+      rbuf = (rbuf + 1) % ring.size();
+      roffset = 0;
+      nfull--;
+      cond.notify_all();
+    }
+    return n;
+  }
+
+  // Stops the thread. A thread blocked on the pipe is released by
+  // terminating the child process that writes into it.
+  void Stop() {
+    if(!thread.joinable()) return;
+    bool running;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stop = true;
+      running = !eof;
+      cond.notify_all();
+    }
+    if(running) in->terminate();
+    thread.join();
+  }
+};
+
+#endif
@@ -0,0 +1,86 @@
+/* Program: EvtReadSpeed.cpp
+ * Description: Compares the read throughput (MB/s) of the ifstream loop
+ * used by evt2root with the memory-mapped and streaming modes of EvtReader.
+ * Every ring item is walked word by word so that all modes touch the data.
+ * See readme.md for general instructions.
+ *
+ * Compile: g++ -O2 EvtReadSpeed.cpp SimpleInPipe.cpp -pthread -o readspeed.out
+ * Run:     ./readspeed.out run-1193-00.evt [run-1193-01.evt ...]
+ */
+
+//C and C++ libraries
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <sys/time.h>
+
+#include "EvtReader.h"
+
+using namespace std;
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv,NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+// sums the 16-bit words of a ring item
+unsigned long long Walk(const char* item) {
+  unsigned int size = *(unsigned int*)item;
+  const unsigned short* w = (const unsigned short*)item;
+  const unsigned short* end = w + size/2;
+  unsigned long long sum = 0;
+  while(w < end) sum += *w++;
+  return sum;
+}
+
+// the read pattern of evt2root_NSCL11.C before EvtReader
+double ReadIfstream(const char* name, unsigned long long& bytes, unsigned long long& sum) {
+  vector<char> buffer(26656);
+  ifstream evtfile(name,ios::binary);
+  double t0 = Now();
+  for(;;) {
+    evtfile.read(&buffer[0],8);
+    unsigned int size = *(unsigned int*)(&buffer[0]);
+    if(!evtfile || size < 8) break;
+    if(size > buffer.size()) buffer.resize(size);
+    evtfile.read(&buffer[0]+8,size-8);
+    if(!evtfile) break;
+    bytes += size;
+    sum += Walk(&buffer[0]);
+  }
+  return Now()-t0;
+}
+
+double ReadEvtReader(const char* name, bool usemap, unsigned long long& bytes, unsigned long long& sum) {
+  EvtReader reader;
+  double t0 = Now();
+  if(!reader.Open(name,usemap)) return 0;
+  while(char* item = reader.Next())
+    sum += Walk(item);
+  bytes += reader.BytesRead();
+  return Now()-t0;
+}
+
+int main(int argc, char* argv[]) {
+  if(argc < 2) {
+    printf("Usage: %s file.evt [file.evt ...]\n",argv[0]);
+    return 1;
+  }
+
+  const char* label[3] = {"ifstream","EvtReader (mapped)","EvtReader (streamed)"};
+  for(int mode=0; mode<3; mode++) {
+    unsigned long long bytes = 0, sum = 0;
+    double t = 0;
+    for(int i=1; i<argc; i++) {
+      if(mode==0) t += ReadIfstream(argv[i],bytes,sum);
+      else t += ReadEvtReader(argv[i],mode==1,bytes,sum);
+    }
+    double MB = bytes/1048576.;
+    printf(" %-22s %10.1f MB in %7.3f s = %8.1f MB/s (checksum %llx)\n",
+	   label[mode],MB,t,t>0 ? MB/t : 0.,sum);
+  }
+  printf(" Note: the first mode to run also pays for cold page-cache reads.\n");
+  return 0;
+}
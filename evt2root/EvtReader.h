@@ -0,0 +1,306 @@
+/***************************************************************
+Class: EvtReader
+Reads the length-prefixed ring items of an NSCLDAQ-11 .evt segment.
+
+Regular files are memory-mapped and every ring item is handed out as
+a pointer straight into the mapping (no copy). The kernel is told
+that the segment is read front to back (MADV_SEQUENTIAL) and the
+window ahead of the current position is requested with MADV_WILLNEED,
+while the window already consumed is released again so that multi-GB
+segments do not pile up in the resident set.
+
+Pipes, FIFOs and standard input ("-") cannot be mapped. For those the
+reader falls back to streaming read(2) calls into an internal buffer,
+in which case the returned pointer is only valid until the next call
+to Next().
+
+Compressed segments (.evt.zst, .evt.gz, .evt.xz) are decompressed by
+zstd, gzip or xz running as a child process (SimpleInPipe). A
+background thread reads the pipe into a ring of buffers (EvtPrefetch)
+while the ring items are handed out, so decompression and conversion
+overlap. Such segments are streamed; Seek() reads forward to the
+requested offset. FindFile() picks the compressed copy of a segment
+when the plain .evt file is not there. OpenCommand() reads the output
+of any other command (e.g. a ring selector) the same way. If that
+process exits with an error or is killed by a signal, Failed() is true
+after Close(); a process stopped by Close() itself before the end of
+its output does not count.
+
+Usage:
+  EvtReader reader;
+  if(reader.Open("run-1193-00.evt")) {
+    while(char* item = reader.Next()) {
+      //item points to the ring item header (size, type, body)
+    }
+    reader.Close();
+    if(reader.Failed()) {
+      //the decompressor exited with an error, the segment may be incomplete
+    }
+  }
+****************************************************************/
+#ifndef EVTREADER_H
+#define EVTREADER_H
+
+// C includes
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+// C++ includes
+#include <vector>
+#include <string>
+
+#include "EvtPrefetch.h"
+
+class EvtReader {
+  int fd;
+  bool isopen;
+  bool ownfd;          //false when reading from stdin
+  bool mapped;
+  char* map;           //start of the mapping
+  size_t mapsize;
+  size_t pos;          //offset of the next ring item
+  size_t advised;      //end of the window passed to MADV_WILLNEED
+  size_t released;     //end of the window passed to MADV_DONTNEED
+  std::vector<char> buf;  //streaming buffer
+  size_t head, tail;      //unread part of the streaming buffer
+  unsigned long long nbytes;
+  SimpleInPipe* pipe;     //decompressor of a compressed segment
+  EvtPrefetch* prefetch;  //background reader of the pipe
+  bool failed;            //the pipe's process exited with an error
+
+  static const size_t kWindow = 64*1024*1024; //readahead window in bytes
+  static const size_t kChunk = 4*1024*1024;   //streaming read size in bytes
+
+  // Makes sure n bytes are buffered from head on, compacting and
+  // refilling the streaming buffer with large reads.
+  bool Fill(size_t n) {
+    if(tail - head >= n) return true;
+    if(head > 0) {
+      memmove(&buf[0], &buf[0] + head, tail - head);
+      tail -= head;
+      head = 0;
+    }
+    if(n > buf.size()) buf.resize(n);
+    while(tail < n) {
+      ssize_t actual = prefetch ? prefetch->Read(&buf[0] + tail, buf.size() - tail)
+	: ::read(fd, &buf[0] + tail, buf.size() - tail);
+      if(actual > 0)
+	tail += actual;
+      else if(actual < 0 && errno == EINTR)
+	continue;
+      else
+	return false;
+    }
+    return true;
+  }
+
+  // Returns the decompressor for a compressed file name, or NULL.
+  static const char* Decompressor(const char* name) {
+    const char* ext[3] = {".zst", ".gz", ".xz"};
+    const char* cmd[3] = {"zstd", "gzip", "xz"};
+    size_t len = strlen(name);
+    for(int i=0; i<3; i++) {
+      size_t n = strlen(ext[i]);
+      if(len > n && strcmp(name + len - n, ext[i]) == 0) return cmd[i];
+    }
+    return NULL;
+  }
+
+  bool OpenPipe(char* argv[]) {
+    pipe = new SimpleInPipe;
+    if(!pipe->open(argv)) {
+      delete pipe;
+      pipe = NULL;
+      return false;
+    }
+    prefetch = new EvtPrefetch;
+    prefetch->Start(pipe);
+    return true;
+  }
+
+  void Advise() {
+    //request the next window and drop the one already consumed
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t end = pos + kWindow < mapsize ? pos + kWindow : mapsize;
+    if(end > advised) {
+      madvise(map + advised, end - advised, MADV_WILLNEED);
+      advised = end;
+    }
+    if(pos > released + 2*kWindow) {
+      size_t done = ((pos - kWindow)/page)*page;
+      madvise(map + released, done - released, MADV_DONTNEED);
+      released = done;
+    }
+  }
+
+ public:
+  EvtReader() : fd(-1), isopen(false), ownfd(false), mapped(false), map(NULL),
+    mapsize(0), pos(0), advised(0), released(0), head(0), tail(0), nbytes(0),
+    pipe(NULL), prefetch(NULL), failed(false) {}
+  ~EvtReader() { Close(); }
+
+  // Opens a segment. When usemap is true the file is mapped if it is a
+  // regular file; otherwise (or if mmap fails) it is streamed.
+  bool Open(const char* name, bool usemap = true) {
+    Close();
+    failed = false;
+    if(const char* cmd = Decompressor(name)) {
+      char* argv[4] = {(char*)cmd, (char*)"-dc", (char*)name, NULL};
+      if(access(name, R_OK) != 0 || !OpenPipe(argv))
+	return false;
+      ownfd = false;
+      usemap = false;
+    }
+    else if(strcmp(name,"-") == 0) {
+      fd = 0;
+      ownfd = false;
+    }
+    else {
+      fd = ::open(name, O_RDONLY);
+      if(fd < 0)
+	return false;
+      ownfd = true;
+    }
+    isopen = true;
+    pos = 0;
+    advised = 0;
+    released = 0;
+    head = 0;
+    tail = 0;
+
+    struct stat st;
+    if(usemap && fstat(fd,&st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(addr != MAP_FAILED) {
+	map = (char*)addr;
+	mapsize = st.st_size;
+	mapped = true;
+	madvise(map, mapsize, MADV_SEQUENTIAL);
+	Advise();
+      }
+    }
+    return true;
+  }
+
+  // Reads the standard output of a command, e.g. a ring selector or a
+  // replay program (argv as for execvp, NULL-terminated).
+  bool OpenCommand(char* argv[]) {
+    Close();
+    failed = false;
+    if(!OpenPipe(argv))
+      return false;
+    ownfd = false;
+    isopen = true;
+    pos = 0;
+    head = 0;
+    tail = 0;
+    return true;
+  }
+
+  void Close() {
+    if(prefetch) {
+      prefetch->Stop();
+      delete prefetch;
+      prefetch = NULL;
+    }
+    if(pipe) {
+      //a process terminated by prefetch->Stop() was not read to the end on purpose
+      if(pipe->close() != 0 && !pipe->was_terminated())
+	failed = true;
+      delete pipe;
+      pipe = NULL;
+    }
+    if(mapped)
+      munmap(map, mapsize);
+    if(isopen && ownfd)
+      ::close(fd);
+    map = NULL;
+    mapsize = 0;
+    mapped = false;
+    isopen = false;
+    fd = -1;
+  }
+
+  // Returns a pointer to the next complete ring item, or NULL at the end
+  // of the segment (a truncated last item is treated as the end).
+  char* Next() {
+    if(!isopen) return NULL;
+
+    if(mapped) {
+      if(pos + 8 > mapsize) return NULL;
+      unsigned int size = *(unsigned int*)(map + pos);
+      if(size < 8 || pos + size > mapsize) return NULL;
+      char* item = map + pos;
+      pos += size;
+      nbytes += size;
+      if(pos + kWindow/2 > advised) Advise();
+      return item;
+    }
+
+    if(buf.size() < kChunk) buf.resize(kChunk);
+    if(!Fill(8)) return NULL;
+    unsigned int size = *(unsigned int*)(&buf[0] + head);
+    if(size < 8 || !Fill(size)) return NULL;
+    char* item = &buf[0] + head;
+    head += size;
+    pos += size;
+    nbytes += size;
+    return item;
+  }
+
+  // Byte offset of the next ring item in the segment.
+  size_t Tell() const { return pos; }
+
+  // Moves to the ring item starting at byte offset (e.g. taken from an
+  // EvtIndex). Compressed segments are read forward to the offset; on
+  // other pipes and standard input it fails.
+  bool Seek(size_t offset) {
+    if(!isopen) return false;
+    if(mapped) {
+      if(offset > mapsize) return false;
+      pos = offset;
+      if(pos > advised) advised = pos;
+      Advise();
+      return true;
+    }
+    if(prefetch) {
+      if(offset < pos) return false;
+      if(buf.size() < kChunk) buf.resize(kChunk);
+      while(pos < offset) {
+	if(head == tail && !Fill(1)) return false;
+	size_t n = tail - head < offset - pos ? tail - head : offset - pos;
+	head += n;
+	pos += n;
+      }
+      return true;
+    }
+    if(lseek(fd, offset, SEEK_SET) < 0) return false;
+    pos = offset;
+    head = 0;
+    tail = 0;
+    return true;
+  }
+
+  // Returns name if it exists, else the first existing compressed copy
+  // (name.zst, name.gz, name.xz), else name.
+  static std::string FindFile(const std::string& name) {
+    const char* ext[4] = {"", ".zst", ".gz", ".xz"};
+    for(int i=0; i<4; i++)
+      if(access((name + ext[i]).c_str(), F_OK) == 0) return name + ext[i];
+    return name;
+  }
+
+  bool IsOpen() const { return isopen; }
+  // True after Close() if the decompressor or command exited with an
+  // error or was killed, i.e. the segment may be incomplete.
+  bool Failed() const { return failed; }
+  bool IsMapped() const { return mapped; }
+  unsigned long long BytesRead() const { return nbytes; }
+};
+
+#endif
@@ -0,0 +1,84 @@
+/* Program: EvtReplay.cpp
+ * Description: Writes the ring items of .evt segments to standard output,
+ * optionally at a limited rate of physics events and in a loop. Stands in
+ * for the DAQ ring buffer when testing the online mode of evt2root
+ * (evt2root_online.C) without beam.
+ * See readme.md for general instructions.
+ *
+ * Compile: g++ -O2 EvtReplay.cpp SimpleInPipe.cpp -pthread -o evtreplay.out
+ * Run:     ./evtreplay.out run-1193-00.evt [...] [-r events_per_s] [-l loops]
+ *          (-l 0 replays forever)
+ */
+
+//C and C++ libraries
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "EvtReader.h"
+
+using namespace std;
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv,NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+int main(int argc, char* argv[]) {
+  vector<string> files;
+  double rate = 0;
+  int loops = 1;
+  for(int i=1; i<argc; i++) {
+    if(strcmp(argv[i],"-r") == 0 && i+1 < argc)
+      rate = atof(argv[++i]);
+    else if(strcmp(argv[i],"-l") == 0 && i+1 < argc)
+      loops = atoi(argv[++i]);
+    else
+      files.push_back(argv[i]);
+  }
+  if(files.empty()) {
+    fprintf(stderr,"Usage: %s file.evt [file.evt ...] [-r events_per_s] [-l loops]\n",argv[0]);
+    return 1;
+  }
+
+  EvtReader reader;
+  long long nphysics = 0;
+  double start = Now();
+  for(int loop=0; loops<=0 || loop<loops; loop++) {
+    for(size_t f=0; f<files.size(); f++) {
+      if(!reader.Open(files[f].c_str())) {
+	fprintf(stderr," *** Error: could not open %s\n",files[f].c_str());
+	return 1;
+      }
+      while(char* item = reader.Next()) {
+	unsigned int size = *(unsigned int*)item;
+	if(*(unsigned int*)(item+4) == 0x1E) {
+	  nphysics++;
+	  if(rate > 0) { //wait until this event is due
+	    double wait = start + nphysics/rate - Now();
+	    if(wait > 0.001) {
+	      fflush(stdout);
+	      usleep((useconds_t)(1e6*wait));
+	    }
+	  }
+	}
+	if(fwrite(item,size,1,stdout) != 1) //the reader has gone away
+	  return 0;
+      }
+      reader.Close();
+      if(reader.Failed()) {
+	fprintf(stderr," *** Error: could not read %s to the end\n",files[f].c_str());
+	return 1;
+      }
+    }
+  }
+  fflush(stdout);
+  fprintf(stderr," Replayed %lld physics events in %.1f s\n",nphysics,Now()-start);
+  return 0;
+}
@@ -0,0 +1,121 @@
+/***************************************************************
+Class: EvtRunReader
+Reads the physics events of one run, segment after segment
+(run-XXXX-00.evt, -01, -02, compressed copies included), and decodes
+them with EvtDecode.h.
+
+It lets a program go from the .evt files straight to the decoded
+ASICHit/CAENHit of each event, without writing and reading back a
+DataTree (see analysis_software/Main.cpp, -evt mode). The run index
+(EvtIndex.h) gives the number of events up front and the position of
+the first one when the run is not read from the start. If the decompressor
+of a compressed segment fails, the run ends there and Failed() is true.
+
+Usage:
+  EvtRunReader run;
+  PhysicsEvent ev;
+  if(run.Open(data_dir,1193)) {
+    while(run.Next(ev)) { ... }
+    run.Close();
+    if(run.Failed()) { ... } //the run was not read to the end
+  }
+****************************************************************/
+#ifndef EVTRUNREADER_H
+#define EVTRUNREADER_H
+
+// C++ includes
+#include <string>
+
+#include "EvtReader.h"
+#include "EvtIndex.h"
+#include "EvtDecode.h"
+
+class EvtRunReader {
+  EvtReader reader;
+  EvtIndex index;
+  std::string dir;
+  int run;
+  int seg;                    //segment being read
+  unsigned long long nread;   //physics events returned so far, from the start of the run
+  bool failed;                //a segment could not be read to the end
+
+  // Closes the segment being read; a failed decompressor fails the run.
+  void CloseSegment() {
+    if(!reader.IsOpen()) return;
+    reader.Close();
+    if(reader.Failed()) failed = true;
+  }
+
+  // Opens the next segment that exists. False after the last one, or if
+  // the segment before failed.
+  bool OpenNext() {
+    CloseSegment();
+    if(failed) return false;
+    while(++seg < EvtIndex::kMaxSegments)
+      if(reader.Open(EvtIndex::SegmentName(dir,run,seg).c_str())) return true;
+    return false;
+  }
+
+ public:
+  EvtRunReader() : run(-1), seg(EvtIndex::kMaxSegments), nread(0), failed(false) {}
+  ~EvtRunReader() { Close(); }
+
+  // Indexes the run (see EvtIndex::Load) and positions the reader on
+  // physics event first. False if the run cannot be read or is shorter.
+  bool Open(const std::string& data_dir, int run_number, unsigned long long first = 0) {
+    Close();
+    dir = data_dir;
+    run = run_number;
+    nread = 0;
+    failed = false;
+    if(!index.Load(dir,run)) return false;
+    seg = -1;
+    if(first == 0) return OpenNext() || index.GetNumPhysics() == 0;
+
+    const EvtIndexEntry* e = index.FindEvent(first);
+    if(!e) return false;
+    seg = e->segment;
+    if(!reader.Open(EvtIndex::SegmentName(dir,run,seg).c_str()) || !reader.Seek(e->offset)) {
+      Close();
+      return false;
+    }
+    nread = first;
+    return true;
+  }
+
+  // Body of the next physics ring item (the word count that starts the
+  // event, as expected by DecodePhysicsEvent), or NULL at the end of the run.
+  unsigned short* NextPhysics() {
+    while(seg < EvtIndex::kMaxSegments) {
+      char* item = reader.Next();
+      if(!item) {
+	if(!OpenNext()) break;
+	continue;
+      }
+      if(*(unsigned int*)(item+4) == 0x1E) {
+	nread++;
+	return ((unsigned short*)item) + 6;
+      }
+    }
+    return NULL;
+  }
+
+  // Decodes the next physics event into ev. False at the end of the run.
+  bool Next(PhysicsEvent& ev) {
+    unsigned short* body = NextPhysics();
+    if(!body) return false;
+    DecodePhysicsEvent(body,ev);
+    return true;
+  }
+
+  void Close() {
+    CloseSegment();
+    seg = EvtIndex::kMaxSegments;
+  }
+
+  unsigned long long GetNumPhysics() const { return index.GetNumPhysics(); }
+  unsigned long long GetNumRead() const { return nread; }
+  bool Failed() const { return failed; }
+};
+
+#endif
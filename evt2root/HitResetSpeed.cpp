@@ -0,0 +1,102 @@
+/* Program: HitResetSpeed.cpp
+ * Description: Benchmark of the per-event reset of the hit classes in
+ * include/2016_detclass.h. Compares clearing the full ASICHit/CAENHit
+ * arrays (as before) with clearing only the Nhits entries written by the
+ * event, for a few hit multiplicities.
+ * See readme.md for general instructions.
+ *
+ * Compile: g++ -O2 HitResetSpeed.cpp `root-config --cflags` -o resetspeed.out
+ * Run:     ./resetspeed.out [events]
+ */
+
+//C and C++ libraries
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/time.h>
+
+#include <TROOT.h>
+
+#include "../include/2016_detclass.h"
+
+using namespace std;
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv,NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+// the reset of 2016_detclass.h before it became sparse
+void FullReset(ASICHit& Si, CAENHit& ADC, CAENHit& TDC) {
+  Si.Nhits = 0;
+  for (Int_t i=0; i<MaxHits;i++) {
+    Si.MBID[i] = 0;
+    Si.CBID[i] = 0;
+    Si.ChNum[i] = 0;
+    Si.Energy[i] = 0;
+    Si.Time[i]  = 0;
+  }
+  CAENHit* caen[2] = {&ADC,&TDC};
+  for (int c=0; c<2; c++) {
+    caen[c]->Nhits = 0;
+    for (Int_t i=0; i<MaxCaenHits;i++) {
+      caen[c]->ID[i] = 0;
+      caen[c]->ChNum[i] = 0;
+      caen[c]->Data[i]  = 0;
+    }
+  }
+}
+
+// writes nhits hits, as the decoder does
+void Fill(int nhits, ASICHit& Si, CAENHit& ADC, CAENHit& TDC) {
+  for (int i=0; i<nhits; i++) {
+    Si.MBID[i] = 1;
+    Si.CBID[i] = i;
+    Si.ChNum[i] = i;
+    Si.Energy[i] = i;
+    Si.Time[i] = i;
+    ADC.ID[i] = 2;
+    ADC.ChNum[i] = i;
+    ADC.Data[i] = i;
+  }
+  Si.Nhits = nhits;
+  ADC.Nhits = nhits;
+  TDC.ID[0] = 2;
+  TDC.ChNum[0] = 0;
+  TDC.Data[0] = 1;
+  TDC.Nhits = 1;
+}
+
+int main(int argc, char* argv[]) {
+  int nevents = argc > 1 ? atoi(argv[1]) : 2000000;
+  ASICHit* Si = new ASICHit;
+  CAENHit* ADC = new CAENHit;
+  CAENHit* TDC = new CAENHit;
+
+  const int mult[4] = {5,20,50,200};
+  printf(" hits/event   full reset    sparse reset (ns/event)\n");
+  for (int m=0; m<4; m++) {
+    double t[2];
+    long long sum = 0;
+    for (int mode=0; mode<2; mode++) {
+      double t0 = Now();
+      for (int ev=0; ev<nevents; ev++) {
+	if (mode==0) FullReset(*Si,*ADC,*TDC);
+	else {
+	  Si->ResetASICHit();
+	  ADC->ResetCAENHit();
+	  TDC->ResetCAENHit();
+	}
+	Fill(mult[m],*Si,*ADC,*TDC);
+	sum += Si->Energy[ev%MaxHits] + ADC->Data[ev%MaxCaenHits];
+      }
+      t[mode] = 1e9*(Now()-t0)/nevents;
+    }
+    printf(" %10d %12.1f %15.1f   (checksum %lld)\n",mult[m],t[0],t[1],sum);
+  }
+  delete Si;
+  delete ADC;
+  delete TDC;
+  return 0;
+}
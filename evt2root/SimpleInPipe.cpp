@@ -5,6 +5,8 @@
 #include <stdio.h>
 #include <fcntl.h>
 #include <termios.h>
+#include <signal.h>
+#include <sys/wait.h>
 #include <iostream>
 
 // project includes
@@ -13,10 +15,10 @@
 using namespace std;
 
 bool SimpleInPipe::open(char* argv[]) {
-  if(isopen)
-    ::close(fd);
+  close();
 
   eof_flag = false;
+  terminated_flag = false;
 
   // open the pipe
   int fds[2];
@@ -26,9 +28,11 @@ bool SimpleInPipe::open(char* argv[]) {
   }
 
   // fork off the subprocess
-  pid_t pid = fork();
+  pid = fork();
   if(pid < 0) {
     cerr << "unable to fork()" << endl;
+    ::close(fds[0]);
+    ::close(fds[1]);
     return false;
   }
 
@@ -40,7 +44,7 @@ bool SimpleInPipe::open(char* argv[]) {
     ::close(fds[1]);
     execvp(argv[0],argv);
     cerr << "failed to execute child process " << argv[0] << endl;
-    exit(errno);
+    _exit(errno);
   }
   else {
     ::close(fds[1]);
@@ -55,11 +59,13 @@ int SimpleInPipe::read(char* buffer, unsigned n) {
 
   unsigned total(0);
   while(total != n) {
-    unsigned actual(::read(fd, buffer, n - total));
+    ssize_t actual(::read(fd, buffer, n - total));
     if(actual > 0) {
       total += actual;
       buffer += actual;
     }
+    else if(actual < 0 && errno == EINTR)
+      continue;
     else {
       eof_flag = true;
       break;
@@ -67,3 +73,36 @@ int SimpleInPipe::read(char* buffer, unsigned n) {
   }
   return total;
 }
+
+int SimpleInPipe::read_some(char* buffer, unsigned n) {
+  if(!isopen) return 0;
+
+  for(;;) {
+    ssize_t actual(::read(fd, buffer, n));
+    if(actual > 0)
+      return actual;
+    if(actual < 0 && errno == EINTR)
+      continue;
+    eof_flag = true;
+    return 0;
+  }
+}
+
+void SimpleInPipe::terminate() {
+  if(pid > 0) {
+    kill(pid, SIGTERM);
+    terminated_flag = true;
+  }
+}
+
+int SimpleInPipe::close() {
+  if(isopen)
+    ::close(fd);
+  isopen = false;
+  fd = -1;
+  int status = 0;
+  if(pid > 0)
+    while(waitpid(pid, &status, 0) < 0 && errno == EINTR) ;
+  pid = -1;
+  return status;
+}
@@ -8,16 +8,22 @@
 
 class SimpleInPipe {
   int fd;
+  pid_t pid;
   bool isopen;
   bool eof_flag;
+  bool terminated_flag;
 public:
-  SimpleInPipe() : isopen(false), eof_flag(false) {}
-  SimpleInPipe(char* argv[]) { open(argv); }
-  ~SimpleInPipe() { if(isopen) ::close(fd); }
+  SimpleInPipe() : fd(-1), pid(-1), isopen(false), eof_flag(false), terminated_flag(false) {}
+  SimpleInPipe(char* argv[]) : fd(-1), pid(-1), isopen(false), eof_flag(false), terminated_flag(false) { open(argv); }
+  ~SimpleInPipe() { close(); }
   bool open(char* argv[]);
-  int read(char* buffer, unsigned n);
+  int read(char* buffer, unsigned n);      //blocks until n bytes or EOF
+  int read_some(char* buffer, unsigned n); //returns what is available, 0 at EOF
   bool eof() { return eof_flag; }
-  void close() { ::close(fd); isopen = false; }
+  bool is_open() { return isopen; }
+  void terminate(); //stops the child process, e.g. to unblock a read()
+  bool was_terminated() { return terminated_flag; }
+  int close(); //waits for the child; returns its waitpid() status, 0 without a child
 };
 
 #endif
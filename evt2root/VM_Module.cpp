@@ -71,23 +71,128 @@ UInt_t VM_Module::SetBranch(TTree* _tree){
   return 1;
 }
 /////////////////////////////////////////////////////////////////////////////////////////////////
-VM_Module_Stack::VM_Module_Stack(const TString& name):VM_BaseClass_Stack(name)					     
+VM_Module_Stack::VM_Module_Stack(const TString& name):VM_BaseClass_Stack(name),
+						     fCompiled(kFALSE)
 {
 
   //VM_Module_Stack(const TString& name="");
   //~VM_Module_Stack(){};
 }
 /////////////////////////////////////////////////////////////////////////////////////////////////
-Bool_t VM_Module_Stack::UnpackModules(unsigned short *& gpointer,int filepos){
+void VM_Module_Stack::Compile(){
+  //resolve the TList once into an array, and find the modules whose Unpack()
+  //can be called directly (the class itself, not a class derived from it)
+  fModules.clear();
+  fUnpack.clear();
   TIter next(fVMStack);
   while( VM_Module*obj = (VM_Module*)next()){
-    if(!obj->Unpack(gpointer)){
+    TClass* cl = obj->IsA();
+    UInt_t unpack = kVirtualUnpack;
+    if(cl == CAEN_ADC::Class() || cl == CAEN_TDC::Class())
+      unpack = kCAENUnpack;
+    else if(cl == MESY_QDC::Class() || cl == MESY_ADC::Class())
+      unpack = kMESYUnpack;
+    else if(cl == CHINP::Class())
+      unpack = kCHINPUnpack;
+    else if(cl == VMUSBMARK::Class())
+      unpack = kMARKUnpack;
+    else if(cl == ASICS_MB::Class())
+      unpack = kASICSUnpack;
+    else if(cl == CAEN_HITS::Class())
+      unpack = kHITSUnpack;
+    fModules.push_back(obj);
+    fUnpack.push_back(unpack);
+  }
+  fCompiled = kTRUE;
+}
+/////////////////////////////////////////////////////////////////////////////////////////////////
+Bool_t VM_Module_Stack::UnpackModules(unsigned short *& gpointer,int filepos,unsigned short* end,PhysicsEvent* event){
+  //returns 0 if the modules read past end (if given). ASICS_MB and CAEN_HITS
+  //unpack into event; without it they use the event given by their SetEvent()
+  if(!fCompiled)
+    Compile();
+  for(size_t i=0;i<fModules.size();i++){
+    VM_Module* obj = fModules[i];
+    Bool_t ok;
+    switch(fUnpack[i]){
+    case kCAENUnpack:  ok = static_cast<CAEN_ADC*>(obj)->CAEN_ADC::Unpack(gpointer); break;
+    case kMESYUnpack:  ok = static_cast<MESY_QDC*>(obj)->MESY_QDC::Unpack(gpointer); break;
+    case kCHINPUnpack: ok = static_cast<CHINP*>(obj)->CHINP::Unpack(gpointer); break;
+    case kMARKUnpack:  ok = static_cast<VMUSBMARK*>(obj)->VMUSBMARK::Unpack(gpointer); break;
+    case kASICSUnpack: ok = event ? static_cast<ASICS_MB*>(obj)->Unpack(gpointer,*event) : obj->Unpack(gpointer); break;
+    case kHITSUnpack:  ok = (event && end) ? static_cast<CAEN_HITS*>(obj)->Unpack(gpointer,*event,end) : obj->Unpack(gpointer); break;
+    default:           ok = obj->Unpack(gpointer);
+    }
+    if(!ok){
       std::cout<<"error at file pos: "<< filepos<<std::endl;
       break; //--ddc 15dec ... No point unpacking rest with a serious error.
     }
+    if(end && gpointer>end)
+      break;
   }  
   
-  return 1;
+  return !(end && gpointer>end);
+}
+/////////////////////////////////////////////////////////////////////////////////////////////////
+void VM_Module_Stack::Reset(){
+  if(!fCompiled)
+    Compile();
+  for(size_t i=0;i<fModules.size();i++)
+    fModules[i]->Reset();
+}
+/////////////////////////////////////////////////////////////////////////////////////////////////
+UInt_t VM_Module_Stack::Load(const char* filename){
+  //adds the modules listed in a file, one per line in readout order:
+  //  <class> <name> <geoaddress> [channels, CHINP only]
+  //  ASICS_MB <name> <marker> <mbid> [words searched for the marker]
+  //  CAEN_HITS <name> <marker>
+  //lines starting with # are comments. Returns the number of modules added.
+  std::ifstream file(filename);
+  if(!file.is_open()){
+    std::cout<<"could not open module stack "<<filename<<std::endl;
+    return 0;
+  }
+  UInt_t count=0;
+  std::string line;
+  while(std::getline(file,line)){
+    std::istringstream words(line);
+    std::string type, name, geo;
+    if(!(words>>type>>name>>geo) || type[0]=='#')
+      continue;
+    UInt_t geoaddress = strtoul(geo.c_str(),NULL,0);
+    VM_Module* mod = NULL;
+    if(type=="CAEN_ADC") mod = new CAEN_ADC(name,geoaddress);
+    else if(type=="CAEN_TDC") mod = new CAEN_TDC(name,geoaddress);
+    else if(type=="MESY_QDC") mod = new MESY_QDC(name,geoaddress);
+    else if(type=="MESY_ADC") mod = new MESY_ADC(name,geoaddress);
+    else if(type=="VMUSBMARK") mod = new VMUSBMARK(name,geoaddress);
+    else if(type=="CHINP"){
+      UInt_t size = MODULE_MAX_CHANNELS_CHINP;
+      words>>size;
+      mod = new CHINP(size,name,geoaddress);
+    }
+    else if(type=="ASICS_MB"){
+      UShort_t mbid = 0, search = 0;
+      if(!(words>>mbid)){
+        std::cout<<filename<<": no motherboard ID for "<<name<<std::endl;
+        continue;
+      }
+      words>>search;
+      mod = new ASICS_MB(name,geoaddress,mbid,search);
+    }
+    else if(type=="CAEN_HITS") mod = new CAEN_HITS(name,geoaddress);
+    else{
+      std::cout<<filename<<": unknown module type "<<type<<std::endl;
+      continue;
+    }
+    Add(mod);
+    count++;
+  }
+  return count;
+}
+/////////////////////////////////////////////////////////////////////////////////////////////////
+VM_Module* VM_Module_Stack::GetModule(const char* name){
+  return fVMStack ? (VM_Module*)fVMStack->FindObject(name) : NULL;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////
 UInt_t VM_Module_Stack::GetNum(UInt_t modtype){
@@ -141,6 +246,7 @@ UInt_t VM_Module_Stack::Add(VM_BaseClass *base){
     Init();
   }
   fVMStack->Add(base);
+  fCompiled = kFALSE;
   return 1;
 }
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -237,6 +343,17 @@ Bool_t MESY_QDC::Unpack(unsigned short *& gpointer){
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 CHINP::CHINP(const UShort_t& modsize,const TString& name,const UInt_t& geoaddress):VM_Module(modsize,name,geoaddress){
   fModuleType =kCHINPtype; 
+  SetPolarity();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void CHINP::SetPolarity(){
+  //chipEnergy() maps energy to either energy or 16384-energy, depending on
+  //module and chip, which is stored as offset + sign*energy
+  TString modname = TString(GetName());
+  for(int chip=0;chip<256;chip++){
+    fEnergyOffset[chip] = chipEnergy(0,chip,modname);
+    fEnergySign[chip] = (Int_t)chipEnergy(1,chip,modname) - fEnergyOffset[chip];
+  }
 }
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 Bool_t CHINP::Unpack(unsigned short *& gpointer){
@@ -344,9 +461,7 @@ Bool_t CHINP::Unpack(unsigned short *& gpointer){
       //here before the chip number is modified.  So this should match what
       //I've seen done where the chipnumber directly from the event stream is used..
 
-      TString modname = TString(GetName());
-
-      e = chipEnergy(e,chip,modname);
+      e = fEnergyOffset[chip] + fEnergySign[chip]*(Int_t)e;
     //time = chipTime(time,chip,modname);//chip and modname not used
       time = chipTime(time);
 
@@ -425,5 +540,21 @@ void CHINP::Reset(){
   return;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////////
+ASICS_MB::ASICS_MB(const TString& name,const UInt_t& marker,const UShort_t& mbid,const UShort_t& search):
+  VM_Module(1,name,marker),
+  fMBID(mbid),
+  fSearch(search),
+  fEvent(NULL)
+{
+  fModuleType = kASICStype;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+CAEN_HITS::CAEN_HITS(const TString& name,const UInt_t& marker):VM_Module(1,name,marker),
+							       fEvent(NULL),
+							       fEnd(NULL)
+{
+  fModuleType = kHITStype;
+}
+//////////////////////////////////////////////////////////////////////////////////////////////////
 
 #endif
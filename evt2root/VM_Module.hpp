@@ -13,6 +13,15 @@ CAEN_ADC and MESY_QDC are implementations each with their own
 override of Unpack(). By Calling UnpackModules from the Module_stack, 
 the pointer to PhysicsEventBuffer gets passed to each Module
 
+ASICS_MB and CAEN_HITS unpack the ANASEN readout of evt2root_NSCL11.C
+(modules_NSCL11.dat) into the hit lists of a PhysicsEvent (EvtDecode.h)
+instead of one array per module; the event is given to UnpackModules().
+
+The stack is resolved once (Compile()) into a plain array of modules and
+their classes, so UnpackModules() does not iterate the TList and calls the
+Unpack() of the known module classes directly instead of through the
+vtable. A stack can also be read from a configuration file with Load().
+
  Author: Nabin Rijal, ddc
 ******************************************************************/
 //--ddc nov15 add class for CHINP, and VMUSB marker  Any variables for 'chinp' added by me.
@@ -25,6 +34,7 @@ the pointer to PhysicsEventBuffer gets passed to each Module
 #include <iostream>
 #include <iomanip>
 #include <math.h>
+#include <stdlib.h>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -50,6 +60,7 @@ the pointer to PhysicsEventBuffer gets passed to each Module
 #include <TCutG.h>
 
 #include "VM_BaseClass.hpp"
+#include "EvtDecode.h"
 
 #define MODULE_MAX_CHANNELS 32
 #define MODULE_MAX_CHANNELS_CHINP 1024
@@ -59,6 +70,9 @@ the pointer to PhysicsEventBuffer gets passed to each Module
 const static unsigned int kCAENtype(1);
 const static unsigned int kMESYtype(2);
 const static unsigned int kCHINPtype(3);
+const static unsigned int kMARKtype(4);
+const static unsigned int kASICStype(5);
+const static unsigned int kHITStype(6);
 
 //VM_Module is an abstract baseclass, example modules which inherit from VM_Module and override the proper methods are CAEN_ADC and MESY_QDC
 class VM_Module:public VM_BaseClass{
@@ -107,6 +121,12 @@ public:
 
 class VM_Module_Stack:public VM_BaseClass_Stack{
 protected:
+  //how Compile() dispatches Unpack() of each module
+  enum { kVirtualUnpack, kCAENUnpack, kMESYUnpack, kCHINPUnpack, kMARKUnpack, kASICSUnpack, kHITSUnpack };
+
+  std::vector<VM_Module*> fModules;//! the stack in readout order
+  std::vector<UInt_t> fUnpack;//!
+  Bool_t fCompiled;//!
 
 public: 
   using VM_BaseClass_Stack::GetNum;
@@ -117,7 +137,12 @@ public:
   virtual UInt_t AddBranches(TTree* _tree);
   virtual UInt_t SetBranches(TTree* _tree); 
   virtual UInt_t Add(VM_BaseClass * base);
-  Bool_t UnpackModules(unsigned short *& pointer, int filepos);
+  virtual void ClearStack(){VM_BaseClass_Stack::ClearStack(); fCompiled=kFALSE;}
+  virtual void Reset();
+  void Compile();
+  UInt_t Load(const char* filename);
+  VM_Module* GetModule(const char* name);
+  Bool_t UnpackModules(unsigned short *& pointer, int filepos, unsigned short* end = NULL, PhysicsEvent* event = NULL);
   UInt_t SortGeoChVal(const UShort_t&geoaddress,const UInt_t& ch, const UInt_t& val);
  
   ClassDef(VM_Module_Stack,1);
@@ -172,13 +197,19 @@ public:
   std::vector<UShort_t> hits; //list of channels which were actually read.
   std::vector<UShort_t> energies; //list of energies
   std::vector<UShort_t> times; //list of energies
+
+  //energy = fEnergyOffset[chip] + fEnergySign[chip]*e, filled from
+  //chipEnergy() in the constructor so Unpack() does not compare names
+  Int_t fEnergySign[256];//!
+  Int_t fEnergyOffset[256];//!
   //--ddc dec15 AND I will override the addbranch and setbranch methods
   UInt_t AddBranch(TTree* _tree);
   UInt_t SetBranch(TTree* _tree);
 
-  CHINP(){};
+  CHINP(){SetPolarity();};
   CHINP(const UShort_t& modsize,const TString& name,const UInt_t& geoaddress);
   void Reset();
+  void SetPolarity();
 
   virtual Bool_t Unpack(unsigned short*& gpointer);
   //--ddc NOTE chips (and chipboards) count starting with '1'.  (channels still count from 0).
@@ -268,6 +299,7 @@ public:
   VMUSBMARK(){};
   VMUSBMARK(const TString& name,const UInt_t& geoaddress):
     VM_Module( 1 ,name, geoaddress) {
+    fModuleType = kMARKtype;
   }
 
   virtual Bool_t Unpack(unsigned short*& gpointer) {
@@ -283,4 +315,58 @@ public:
   ClassDef(VMUSBMARK,1);
 };
 
+//--- ANASEN readout of evt2root_NSCL11.C, see EvtDecode.h ---------------------
+//The strips of one ASICs motherboard. The geoaddress is the marker that starts
+//the block (0xaaaa, 0xbbbb), searched for over up to search more words.
+class ASICS_MB:public VM_Module{
+protected:
+  UShort_t fMBID;//!
+  UShort_t fSearch;//!
+  PhysicsEvent* fEvent;//!
+public:
+
+  ASICS_MB():fMBID(0),fSearch(0),fEvent(NULL){};
+  ASICS_MB(const TString& name,const UInt_t& marker,const UShort_t& mbid,const UShort_t& search=0);
+
+  UShort_t MBID()const {return fMBID;}
+  void SetEvent(PhysicsEvent* event){fEvent = event;}
+  Bool_t Unpack(unsigned short*& gpointer,PhysicsEvent& event){
+    gpointer = UnpackASICsBlock(gpointer,fGeoAddress,fSearch,fMBID,event);
+    return 1;
+  }
+  virtual Bool_t Unpack(unsigned short*& gpointer){
+    return fEvent ? Unpack(gpointer,*fEvent) : 0;
+  }
+  //the hits are written by BranchPhysicsEvent()
+  virtual UInt_t AddBranch(TTree*){return 0;}
+  virtual UInt_t SetBranch(TTree*){return 0;}
+
+  ClassDef(ASICS_MB,1);
+};
+
+//The CAEN blocks after the marker (0xcccc), up to the end of the event, as
+//sparse ADC/TDC hits selected by CAENAcceptance.h
+class CAEN_HITS:public VM_Module{
+protected:
+  PhysicsEvent* fEvent;//!
+  unsigned short* fEnd;//!
+public:
+
+  CAEN_HITS():fEvent(NULL),fEnd(NULL){};
+  CAEN_HITS(const TString& name,const UInt_t& marker);
+
+  void SetEvent(PhysicsEvent* event,unsigned short* end){fEvent = event; fEnd = end;}
+  Bool_t Unpack(unsigned short*& gpointer,PhysicsEvent& event,unsigned short* end){
+    gpointer = UnpackCAENBlocks(gpointer,end,fGeoAddress,event);
+    return 1;
+  }
+  virtual Bool_t Unpack(unsigned short*& gpointer){
+    return (fEvent && fEnd) ? Unpack(gpointer,*fEvent,fEnd) : 0;
+  }
+  virtual UInt_t AddBranch(TTree*){return 0;}
+  virtual UInt_t SetBranch(TTree*){return 0;}
+
+  ClassDef(CAEN_HITS,1);
+};
+
 #endif
@@ -2,6 +2,12 @@
  * Description: Runs evt2root on the files listed in runs.lst.
  * See readme.md for general instructions.
  * Developed by J. Lighthall Jul-Dec 2016
+ *
+ * Options:
+ *  -j N         convert N runs at the same time (default 1)
+ *  -m file      merge the per-run ROOT files into file with hadd (only if
+ *               all runs were converted)
+ *  -c macro     converter to use with -j (default evt2root_NSCL11_mADC)
  */
 
 //C and C++ libraries
@@ -10,18 +16,69 @@
 #include <string>
 #include <sstream>
 #include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
 
 using namespace std;
 
-int main() {
+// Converts one run in a child process and returns its pid. The job gets
+// its own list file and log file so that jobs do not overwrite each other.
+pid_t ConvertRun(int run, string str0, string outdir, string converter, bool del) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid != 0)
+    return pid;
+
+  stringstream list, cmd;
+  list << "evt_files_" << run << ".lst";
+  std::ofstream outfile(list.str().c_str());
+  outfile << "Output ROOT file: " << outdir << "run" << run << ".root" << endl;
+  outfile << "Data directory: "<< str0 << endl;
+  outfile << run << endl;
+  outfile.close();
+
+  cmd << "root -l -b -n -q 'evt2root_run.C(\"" << converter << "\",\"" << list.str()
+      << "\")' > evt2root_" << run << ".log 2>&1";
+  int status = system(cmd.str().c_str());
+
+  if (status==0 && del) {
+    stringstream rm;
+    rm << "rm -vf " << str0 << "run-" << run << "-00.evt";
+    system(rm.str().c_str());
+  }
+  unlink(list.str().c_str());
+  _exit(status==0 ? 0 : 1);
+}
+
+int main(int argc, char* argv[]) {
   int list[999];
   const char* fname="runs.lst"; //name of file with list of run numbers
-  
+  string str0 = "/home/lighthall/data/"; //location of .evt files
+  string outdir = "/home/lighthall/root/raw/"; //location of .root files
+
+  int njobs = 1;
+  string merged = "";
+  string converter = "evt2root_NSCL11_mADC";
+  for (int a=1; a<argc; a++) {
+    if (strcmp(argv[a],"-j")==0 && a+1<argc)
+      njobs = atoi(argv[++a]);
+    else if (strcmp(argv[a],"-m")==0 && a+1<argc)
+      merged = argv[++a];
+    else if (strcmp(argv[a],"-c")==0 && a+1<argc)
+      converter = argv[++a];
+    else {
+      printf("Usage: %s [-j jobs] [-m merged.root] [-c converter]\n",argv[0]);
+      return 1;
+    }
+  }
+  if (njobs<1) njobs = 1;
+
   ifstream infile(fname);
   printf("Reading list file \"%s\"\n",fname);
   printf(" The following runs will be converted\n");
   int i=0;
-  while (infile >> list[i]) {
+  while (i<999 && infile >> list[i]) {
     printf("  %d\n",list[i]);
     i++;
   }
@@ -32,15 +89,21 @@ int main() {
   cin >> ans;
   if (ans=='y')
     del=true;
-      
-  for(int j=0;j<i;j++) {
+
+  int failed=0;
+  if (njobs==1) {
+    for(int j=0;j<i;j++) {
       std::ofstream outfile("evt_files.lst"); //name of file referenced in evt2root_NSCL11.C
-      string str0 = "/home/lighthall/data/"; //location of .evt files
-      outfile << "Output ROOT file: /home/lighthall/root/raw/run" << list[j] << ".root" << endl;
+      outfile << "Output ROOT file: " << outdir << "run" << list[j] << ".root" << endl;
       outfile << "Data directory: "<< str0 << endl;
       outfile << list[j] << endl;
-      system("root -l -n -q rootinput.C"); //name of file with ROOT command
-      
+      outfile.close();
+      if (system("root -l -n -q rootinput.C")!=0) { //name of file with ROOT command
+	printf("  *** Error: run %d was not converted\n",list[j]);
+	failed++;
+	continue; //keep the .evt file
+      }
+
       string str1 = "rm -vf ";
       str1+=str0;
       str1+="run-";
@@ -53,4 +116,52 @@ int main() {
       if(del)
 	system(str3.c_str()); //use this line to delete the .evt files after conversion
     }
+  }
+  else {
+    //compile the libraries once before the jobs start loading them
+    printf(" Compiling %s\n",converter.c_str());
+    fflush(stdout);
+    string compile = "root -l -b -n -q 'evt2root_run.C(\"" + converter + "\",\"\")'";
+    if (system(compile.c_str())!=0) {
+      printf(" *** Error: could not compile %s\n",converter.c_str());
+      return 1;
+    }
+
+    printf(" Converting %d runs with %d jobs (output in evt2root_<run>.log)\n",i,njobs);
+    int running=0;
+    for(int j=0;j<i || running>0;) {
+      if (j<i && running<njobs) {
+	if (ConvertRun(list[j],str0,outdir,converter,del)<0) {
+	  printf("  *** Error: could not start run %d\n",list[j]);
+	  failed++;
+	}
+	else
+	  running++;
+	j++;
+	continue;
+      }
+      int status;
+      if (wait(&status)<0) break;
+      running--;
+      if (!WIFEXITED(status) || WEXITSTATUS(status)!=0)
+	failed++;
+    }
+    printf(" %d of %d runs converted\n",i-failed,i);
+  }
+
+  if (failed>0) {
+    if (merged!="")
+      printf(" *** %d runs failed, not merging into %s\n",failed,merged.c_str());
+    return 1;
+  }
+  if (merged!="") {
+    stringstream hadd;
+    hadd << "hadd -f " << merged;
+    for(int j=0;j<i;j++)
+      hadd << " " << outdir << "run" << list[j] << ".root";
+    printf(" Merging into %s\n",merged.c_str());
+    fflush(stdout);
+    return system(hadd.str().c_str())==0 ? 0 : 1;
+  }
+  return 0;
 }
@@ -1,25 +1,36 @@
 ////////////////////////////////////////////////////////
 // Nabin Rijal - December 2015.
 ////////////////////////////////////////////////////////
+#ifndef detclass_2016_h
+#define detclass_2016_h
+
 using namespace std;
 
 #define MaxHits 416
 #define MaxCaenHits 500
 #define MaxMesyHits 200
 ////////////////////////////////////////////////////////
+// The hit arrays are zero beyond Nhits: the constructors clear them once and
+// the Reset functions only clear the first Nhits entries, which are the only
+// ones an event writes (and the only ones stored in the tree).
+////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////
 class ASICHit {
   // This class is for ASICs hit
  public:
-  ASICHit(){};
+  ASICHit(){
+    Nhits = MaxHits;
+    ResetASICHit();
+  };
   Int_t Nhits,MBID[MaxHits],CBID[MaxHits],ChNum[MaxHits];
   Int_t Energy[MaxHits];
   Int_t Time[MaxHits];
 
   void ResetASICHit() {
+    Int_t n = Nhits<MaxHits ? Nhits : MaxHits;
     Nhits = 0;
 
-    for (Int_t i=0; i<MaxHits;i++) {
+    for (Int_t i=0; i<n;i++) {
       MBID[i] = 0;
       CBID[i] = 0;
       ChNum[i] = 0;
@@ -32,14 +43,18 @@ class ASICHit {
 class CAENHit {
   //This class is for CAEN hit
  public:
-  CAENHit(){};
+  CAENHit(){
+    Nhits = MaxCaenHits;
+    ResetCAENHit();
+  };
   Int_t Nhits,ID[MaxCaenHits],ChNum[MaxCaenHits];
   Int_t Data[MaxCaenHits];
 
   void ResetCAENHit() {
+    Int_t n = Nhits<MaxCaenHits ? Nhits : MaxCaenHits;
     Nhits = 0;
 
-    for (Int_t i=0; i<MaxCaenHits;i++) {
+    for (Int_t i=0; i<n;i++) {
       ID[i] = 0;
       ChNum[i] = 0;
       Data[i]  = 0;
@@ -50,14 +65,18 @@ class CAENHit {
 class MesyHit {
   //This class is for MesyTech hit
  public:
-  MesyHit(){};
+  MesyHit(){
+    Nhits = MaxMesyHits;
+    ResetMesyHit();
+  };
   Int_t Nhits,ID[MaxMesyHits],ChNum[MaxMesyHits];
   Int_t Data[MaxMesyHits];
 
   void ResetMesyHit() {
+    Int_t n = Nhits<MaxMesyHits ? Nhits : MaxMesyHits;
     Nhits = 0;
 
-    for (Int_t i=0; i<MaxMesyHits;i++) {
+    for (Int_t i=0; i<n;i++) {
       ID[i] = 0;
       ChNum[i] = 0;
       Data[i]  = 0;
@@ -65,3 +84,4 @@ class MesyHit {
   };
 };
 ////////////////////////////////////////////////////////
+#endif
@@ -0,0 +1,91 @@
+/***************************************************************
+Class: CounterRNG
+Random numbers that are a function of where they are used instead
+of a generator state: each number is computed from (run, entry,
+stream, detector, hit, draw) with the Philox4x32-10 counter-based
+generator (Salmon et al., SC'11). There is nothing to seed per event,
+a number costs a few integer multiplications, and the output does not
+change between runs or with the order in which the events or the hits
+are processed.
+
+  CounterRNG rng(run);
+  rng.SetEntry(global_evt);   //once per event
+  Double_t u = rng.Rndm(CounterRNG::kQ3,det,hit,0); //uniform in (0,1)
+
+Each (stream, detector, hit) gives an independent sequence of draws
+0,1,2,...; the streams keep apart the users that share detector and
+hit numbers. SetSeed() changes all the numbers, e.g. to check that a
+result does not depend on the smearing.
+****************************************************************/
+#ifndef COUNTERRNG_H
+#define COUNTERRNG_H
+
+#include <float.h>
+
+#include <TROOT.h>
+
+class CounterRNG {
+  UInt_t key[2];  //run, seed
+  Long64_t entry;
+
+  static UInt_t MulHiLo(UInt_t a, UInt_t b, UInt_t& hi) {
+    ULong64_t p = (ULong64_t)a*b;
+    hi = (UInt_t)(p >> 32);
+    return (UInt_t)p;
+  }
+
+ public:
+  // Streams of the analysis programs
+  enum Stream { kPCWire = 1, kQ3 = 2, kSX3 = 3 };
+
+  CounterRNG(UInt_t run = 0, UInt_t seed = 0) : entry(0) {
+    key[0] = run;
+    key[1] = seed;
+  }
+
+  void SetRun(UInt_t run) { key[0] = run; }
+  void SetSeed(UInt_t seed) { key[1] = seed; }
+  void SetEntry(Long64_t e) { entry = e; }
+  UInt_t GetRun() const { return key[0]; }
+  UInt_t GetSeed() const { return key[1]; }
+  Long64_t GetEntry() const { return entry; }
+
+  // Philox4x32-10: encrypts the counter ctr with key k in place.
+  static void Philox(UInt_t ctr[4], const UInt_t k[2]) {
+    UInt_t k0 = k[0], k1 = k[1];
+    for(int round=0; round<10; round++) {
+      UInt_t hi0, hi1;
+      UInt_t lo0 = MulHiLo(0xD2511F53u,ctr[0],hi0);
+      UInt_t lo1 = MulHiLo(0xCD9E8D57u,ctr[2],hi1);
+      ctr[0] = hi1^ctr[1]^k0;
+      ctr[1] = lo1;
+      ctr[2] = hi0^ctr[3]^k1;
+      ctr[3] = lo0;
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+  }
+
+  // Uniform in (0,1) with 53 random bits, for draw number draw of hit hit
+  // of detector det in stream stream of the current entry. Draws 2n and
+  // 2n+1 come from the same Philox block.
+  Double_t Rndm(Int_t stream, Int_t det, Int_t hit, Int_t draw = 0) const {
+    UInt_t ctr[4];
+    ctr[0] = (UInt_t)entry;
+    ctr[1] = (UInt_t)((ULong64_t)entry >> 32);
+    ctr[2] = ((UInt_t)stream << 24) ^ ((UInt_t)det & 0xFFFFFFu);
+    ctr[3] = ((UInt_t)hit << 16) ^ ((UInt_t)draw >> 1);
+    Philox(ctr,key);
+    const UInt_t* w = (draw & 1) ? ctr+2 : ctr;
+    return ToUniform(w[0],w[1]);
+  }
+
+  // 53 bits of hi and lo to (0,1). Above 2^52 the sum x+0.5 rounds to an even
+  // integer, so the largest x would give exactly 1: it is kept below 1.
+  static Double_t ToUniform(UInt_t hi, UInt_t lo) {
+    Double_t u = ((hi >> 5)*67108864.0 + (lo >> 6) + 0.5)/9007199254740992.0;
+    return u < 1 ? u : 1 - DBL_EPSILON/2;
+  }
+};
+
+#endif
@@ -0,0 +1,177 @@
+/***************************************************************
+Classes: CutRegistry, FastCut
+Graphical cuts (TCutG) read once from their files and tested
+without going over all the vertices for most points.
+
+TCutG::IsInside() goes around the whole polygon for every point.
+FastCut keeps the vertices of a cut together with its bounding box
+and a grid over the box in which each cell is marked inside,
+outside, or near an edge. A point outside the box or in a marked
+cell is answered with one lookup; only the points in the cells near
+an edge are tested against the polygon, with the same test as
+TCutG::IsInside() (TMath::IsInside), so the answer is always that of
+the TCutG.
+
+CutRegistry reads all the TCutG of a cut file the first time the
+file is asked for and keeps them for the whole program:
+
+  CutRegistry Cuts;
+  const FastCut* cut1 = Cuts.Load(file_cut1,"alphas");
+  if (cut1 == NULL) { ...cut or file does not exist... }
+  ...
+  if (cut1->IsInside(SiEnergy,dE)) ...
+
+FastCut::IsInside() only reads the cut, so a cut can be used by
+several threads at the same time.
+****************************************************************/
+#ifndef CUTREGISTRY_H
+#define CUTREGISTRY_H
+
+// C++ includes
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <TROOT.h>
+#include <TMath.h>
+#include <TFile.h>
+#include <TList.h>
+#include <TKey.h>
+#include <TCutG.h>
+
+class FastCut {
+  std::string name;
+  std::vector<Double_t> x, y; //vertices
+  Double_t xmin, xmax, ymin, ymax;
+  Int_t nx, ny;
+  Double_t x0, y0, sx, sy;    //grid origin and cells per unit
+  std::vector<UChar_t> cells; //kOutside, kInside or kEdge
+
+  enum { kOutside = 0, kInside = 1, kEdge = 2 };
+
+  Bool_t Exact(Double_t px, Double_t py) const {
+    return TMath::IsInside(px,py,(Int_t)x.size(),(Double_t*)&x[0],(Double_t*)&y[0]);
+  }
+
+ public:
+  // grid: number of cells along each axis of the bounding box
+  FastCut(const TCutG* cut, Int_t grid = 128)
+    : name(cut->GetName()), nx(0), ny(0), x0(0), y0(0), sx(0), sy(0) {
+    Int_t n = cut->GetN();
+    x.assign(cut->GetX(),cut->GetX()+n);
+    y.assign(cut->GetY(),cut->GetY()+n);
+    if (n==0) {
+      xmin = xmax = ymin = ymax = 0;
+      return;
+    }
+    xmin = xmax = x[0];
+    ymin = ymax = y[0];
+    for (Int_t i=1; i<n; i++) {
+      if (x[i]<xmin) xmin = x[i];
+      if (x[i]>xmax) xmax = x[i];
+      if (y[i]<ymin) ymin = y[i];
+      if (y[i]>ymax) ymax = y[i];
+    }
+    // The grid covers the box with a margin, so that the points just outside
+    // the box, where rounding could matter, go to the exact test.
+    Double_t mx = 1e-6*(xmax-xmin) + 1e-12*(fabs(xmin)+fabs(xmax)) + 1e-300;
+    Double_t my = 1e-6*(ymax-ymin) + 1e-12*(fabs(ymin)+fabs(ymax)) + 1e-300;
+    nx = ny = grid < 1 ? 1 : grid;
+    x0 = xmin - mx;
+    y0 = ymin - my;
+    sx = nx/(xmax - xmin + 2*mx);
+    sy = ny/(ymax - ymin + 2*my);
+    cells.assign(nx*ny,(UChar_t)kOutside);
+
+    // Cells near an edge: points along each edge, closer together than half
+    // a cell, mark their cell and its neighbours.
+    for (Int_t i=0, j=n-1; i<n; j=i++) {
+      Double_t cx = (x[j]-x[i])*sx, cy = (y[j]-y[i])*sy;
+      Int_t steps = 1 + (Int_t)(2*sqrt(cx*cx + cy*cy));
+      for (Int_t k=0; k<=steps; k++) {
+	Double_t t = (Double_t)k/steps;
+	Int_t ix = (Int_t)((x[i] + t*(x[j]-x[i]) - x0)*sx);
+	Int_t iy = (Int_t)((y[i] + t*(y[j]-y[i]) - y0)*sy);
+	for (Int_t a=ix-1; a<=ix+1; a++)
+	  for (Int_t b=iy-1; b<=iy+1; b++)
+	    if (a>=0 && a<nx && b>=0 && b<ny) cells[b*nx+a] = kEdge;
+      }
+    }
+    // The other cells are all inside or all outside: test their centre.
+    for (Int_t b=0; b<ny; b++)
+      for (Int_t a=0; a<nx; a++)
+	if (cells[b*nx+a] != kEdge && Exact(x0 + (a+0.5)/sx, y0 + (b+0.5)/sy))
+	  cells[b*nx+a] = kInside;
+  }
+
+  const char* GetName() const { return name.c_str(); }
+  Int_t GetN() const { return x.size(); }
+
+  // Same as TCutG::IsInside(px,py)
+  Bool_t IsInside(Double_t px, Double_t py) const {
+    if (x.empty()) return kFALSE;
+    Double_t fx = (px - x0)*sx, fy = (py - y0)*sy;
+    if (!(fx >= 0 && fx < nx && fy >= 0 && fy < ny)) return kFALSE; //outside the box, or NaN
+    UChar_t c = cells[(Int_t)fy*nx + (Int_t)fx];
+    if (c == kEdge) return Exact(px,py);
+    return c == kInside;
+  }
+};
+
+class CutRegistry {
+  std::map<std::string, std::map<std::string,FastCut*> > files; //cuts by file and name
+  Int_t grid;
+
+ public:
+  CutRegistry(Int_t cells = 128) : grid(cells) {}
+  ~CutRegistry() {
+    for (std::map<std::string, std::map<std::string,FastCut*> >::iterator f=files.begin(); f!=files.end(); f++)
+      for (std::map<std::string,FastCut*>::iterator c=f->second.begin(); c!=f->second.end(); c++)
+	delete c->second;
+  }
+
+  // Reads all the TCutG of filename, if not done before. kFALSE if the file cannot be opened.
+  Bool_t LoadFile(const char* filename) {
+    if (files.count(filename)) return kTRUE;
+    TDirectory* dir = gDirectory;
+    TFile* file = TFile::Open(filename);
+    if (!file || file->IsZombie()) {
+      delete file;
+      if (dir) dir->cd();
+      return kFALSE;
+    }
+    std::map<std::string,FastCut*>& cuts = files[filename];
+    TIter next(file->GetListOfKeys());
+    TKey* key;
+    while ((key = (TKey*)next())) {
+      if (strcmp(key->GetClassName(),"TCutG") != 0 || cuts.count(key->GetName())) continue; //highest cycle first
+      TCutG* cut = (TCutG*)key->ReadObj();
+      cuts[key->GetName()] = new FastCut(cut,grid);
+      delete cut;
+    }
+    file->Close();
+    delete file;
+    if (dir) dir->cd();
+    std::cout << " " << cuts.size() << " cuts read from " << filename << std::endl;
+    return kTRUE;
+  }
+
+  // The cut name of filename, read with the whole file the first time; NULL if it does not exist.
+  const FastCut* Load(const char* filename, const char* name) {
+    if (!LoadFile(filename)) return NULL;
+    return Get(filename,name);
+  }
+
+  // The cut name of filename if the file has been read, otherwise NULL.
+  const FastCut* Get(const char* filename, const char* name) const {
+    std::map<std::string, std::map<std::string,FastCut*> >::const_iterator f = files.find(filename);
+    if (f == files.end()) return NULL;
+    std::map<std::string,FastCut*>::const_iterator c = f->second.find(name);
+    return c == f->second.end() ? NULL : c->second;
+  }
+};
+
+#endif
@@ -0,0 +1,190 @@
+/***************************************************************
+Class: EntrySelection
+The entries of a run that a program processes, chosen on the command
+line instead of with MaxEntries, bfirst and nstep compiled in:
+
+  -first N       first entry processed (default 0)
+  -last N        entry after the last one processed (default: all)
+  -every n       one entry of every n of [first,last)
+  -random n      n entries of [first,last) drawn at random, each entry
+                 with the same chance, none twice
+  -stratified n  [first,last) cut into n equal parts, one entry drawn at
+                 random in each, so the sample covers the whole run
+  -seed s        seed of -random and -stratified (default 1; 0: a
+                 different sample each time)
+
+N and n may be written as 1e6. With -first and -last a batch system
+runs a run as chunks, [0,1e6), [1e6,2e6), ..., and merges the outputs
+(hadd). The samples are for a quick look at huge runs, e.g. for a
+calibration: only the selected entries are read, and a histogram of
+the sample times GetWeight() estimates the one of [first,last).
+
+  EntrySelection Entries;
+  if (!Entries.ParseArgs(argc,argv)) exit(EXIT_FAILURE); //takes the options out of argv
+  Long64_t n = Entries.Select(tree->GetEntries());
+  Entries.Apply(input);                                    //TreeInput: only the selected baskets are cached
+  for (Long64_t k=0; k<n; k++) input.GetEntry(Entries.GetEntry(k));
+
+The entries are given in increasing order. A program that reads a list
+of files (the Analyzers) selects and applies them for each file in turn,
+so -first, -last and the samples are per file. The TEntryList of a
+sample belongs to the TreeInput it is applied to.
+****************************************************************/
+#ifndef ENTRYSELECTION_H
+#define ENTRYSELECTION_H
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// C++ includes
+#include <vector>
+#include <algorithm>
+#include <unordered_set>
+
+#include <TROOT.h>
+#include <TRandom3.h>
+#include <TEntryList.h>
+
+#include "TreeInput.h"
+
+class EntrySelection {
+ public:
+  enum Mode { kRange, kEvery, kRandom, kStratified };
+
+ private:
+  Mode mode;
+  Long64_t first_arg, last_arg; //as given, last_arg<0: to the end
+  Long64_t first, last;         //[first,last) of the input of Select()
+  Long64_t n;           //nstep of kEvery, size of the kRandom and kStratified samples
+  UInt_t seed;
+  Long64_t nselected;
+  std::vector<Long64_t> entries; //kRandom, kStratified
+
+  static Bool_t Number(const char* s, Long64_t& value) {
+    char* end;
+    Double_t v = strtod(s,&end);
+    if (*end || v < 0) return kFALSE;
+    value = (Long64_t)v;
+    return kTRUE;
+  }
+
+ public:
+  EntrySelection() : mode(kRange), first_arg(0), last_arg(-1), first(0), last(0), n(1), seed(1), nselected(0) {}
+
+  static const char* Usage() {
+    return "[-first N] [-last N] [-every n | -random n | -stratified n] [-seed s]";
+  }
+
+  // Takes the options above out of argv. kFALSE (and a message) if one is wrong.
+  Bool_t ParseArgs(int& argc, char* argv[]) {
+    int out = 1;
+    for (int i=1; i<argc; i++) {
+      const char* opt = argv[i];
+      Bool_t known = !strcmp(opt,"-first") || !strcmp(opt,"-last") || !strcmp(opt,"-every") ||
+	!strcmp(opt,"-random") || !strcmp(opt,"-stratified") || !strcmp(opt,"-seed");
+      if (!known) {
+	argv[out++] = argv[i];
+	continue;
+      }
+      Long64_t value;
+      if (i+1 >= argc || !Number(argv[i+1],value)) {
+	printf(" Option %s needs a number\n",opt);
+	return kFALSE;
+      }
+      i++;
+      if (!strcmp(opt,"-first")) first_arg = value;
+      else if (!strcmp(opt,"-last")) last_arg = value;
+      else if (!strcmp(opt,"-seed")) seed = value;
+      else {
+	if (mode != kRange) {
+	  printf(" Only one of -every, -random and -stratified\n");
+	  return kFALSE;
+	}
+	if (value < 1) {
+	  printf(" Option %s needs a number above 0\n",opt);
+	  return kFALSE;
+	}
+	mode = !strcmp(opt,"-every") ? kEvery : !strcmp(opt,"-random") ? kRandom : kStratified;
+	n = value;
+      }
+    }
+    argc = out;
+    argv[argc] = NULL;
+    if (last_arg >= 0 && last_arg < first_arg) {
+      printf(" -last %lld is before -first %lld\n",last_arg,first_arg);
+      return kFALSE;
+    }
+    return kTRUE;
+  }
+
+  Mode GetMode() const { return mode; }
+  Long64_t GetFirst() const { return first; }
+  Long64_t GetLast() const { return last; }
+
+  // Chooses the entries among the nentries of an input (each file of a list in turn); the number of entries selected
+  Long64_t Select(Long64_t nentries) {
+    last = (last_arg < 0 || last_arg > nentries) ? nentries : last_arg;
+    first = first_arg < last ? first_arg : last;
+    Long64_t range = last - first;
+    entries.clear();
+    if (mode == kEvery)
+      nselected = (range + n - 1)/n;
+    else if ((mode == kRandom || mode == kStratified) && n < range) {
+      TRandom3 rnd(seed);
+      if (mode == kStratified)
+	for (Long64_t k=0; k<n; k++) {
+	  Long64_t lo = first + k*range/n, hi = first + (k+1)*range/n;
+	  entries.push_back(lo + rnd.Integer((UInt_t)(hi-lo)));
+	}
+      else {
+	//Floyd's algorithm: n different entries, each subset of n as likely
+	std::unordered_set<Long64_t> drawn;
+	for (Long64_t j=range-n; j<range; j++)
+	  if (!drawn.insert(rnd.Integer((UInt_t)(j+1))).second) drawn.insert(j);
+	entries.assign(drawn.begin(),drawn.end());
+	std::sort(entries.begin(),entries.end());
+	for (size_t k=0; k<entries.size(); k++) entries[k] += first;
+      }
+      nselected = n;
+    }
+    else
+      nselected = range; //the sample would be all of [first,last)
+    return nselected;
+  }
+
+  Long64_t GetN() const { return nselected; }
+
+  // Entry number of the k-th entry selected, k in [0,GetN())
+  Long64_t GetEntry(Long64_t k) const {
+    if (!entries.empty()) return entries[k];
+    return mode == kEvery ? first + k*n : first + k;
+  }
+
+  // Entries of [first,last) per entry selected
+  Double_t GetWeight() const { return nselected > 0 ? (Double_t)(last - first)/nselected : 0; }
+
+  // The entries selected, for a TTree; NULL if they are all those of [first,last) or evenly spaced. The caller owns the list
+  TEntryList* MakeEntryList(const TTree* tree) const {
+    if (entries.empty()) return NULL;
+    TEntryList* list = new TEntryList(tree);
+    for (size_t k=0; k<entries.size(); k++) list->Enter(entries[k]);
+    return list;
+  }
+
+  // input only reads, and only caches, the entries selected; input owns (and deletes) their list
+  void Apply(TreeInput& input) const {
+    input.SetEntryRange(first,last);
+    input.SetEntryList(MakeEntryList(input.GetTree()));
+  }
+
+  void Print() const {
+    printf(" Processing %lld entries of [%lld,%lld)",nselected,first,last);
+    if (mode == kEvery) printf(", 1 of every %lld",n);
+    if (!entries.empty()) printf(", %s sample (seed %u), weight %g",mode == kRandom ? "random" : "stratified",seed,GetWeight());
+    printf("\n");
+  }
+};
+
+#endif
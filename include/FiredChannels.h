@@ -0,0 +1,70 @@
+/***************************************************************
+Class: FiredChannels
+The (detector, channel) cells written in the current event, kept as
+one bit per detector and one bit per channel of each detector.
+
+The per-event arrays of Main ([detector][channel] energies and
+times, one value per PC wire) used to be reset in full before every
+event and then swept in full to find what fired, although an event
+only writes a few cells. With FiredChannels only the cells marked in
+the event are read, so neither the reset nor the sweep depends on the
+size of the arrays:
+
+  FiredChannels<NumSX3,MaxSX3Ch> SX3Fired;
+  SX3Fired.Clear();                    //once per event
+  SX3Fired.Set(det,ch);                //for each cell written
+  for (UInt_t dets = SX3Fired.Detectors(); dets; dets &= dets-1) {
+    Int_t i = FiredChannels<NumSX3,MaxSX3Ch>::Lowest(dets);
+    for (UInt_t chs = SX3Fired.Channels(i); chs; chs &= chs-1) {
+      Int_t j = FiredChannels<NumSX3,MaxSX3Ch>::Lowest(chs);
+      ...cell [i][j], in the same order as for(i) for(j)...
+    }
+  }
+
+Set() tells whether the cell is new in the event, so that cells
+which are not always overwritten in full can be reset then. At most
+32 detectors and 32 channels per detector.
+****************************************************************/
+#ifndef FIREDCHANNELS_H
+#define FIREDCHANNELS_H
+
+#include <TROOT.h>
+
+template<Int_t NDet, Int_t NCh> class FiredChannels {
+  static_assert(NDet <= 32 && NCh <= 32, "FiredChannels: one bit per detector and per channel");
+
+  UInt_t det_mask;
+  UInt_t ch_mask[NDet]; //valid for the detectors set in det_mask
+
+ public:
+  FiredChannels() : det_mask(0) {}
+
+  void Clear() { det_mask = 0; }
+
+  // Marks channel ch of detector det. kTRUE if it was not marked since Clear().
+  Bool_t Set(Int_t det, Int_t ch) {
+    UInt_t bit = 1u << ch;
+    if (!(det_mask & (1u << det))) {
+      det_mask |= 1u << det;
+      ch_mask[det] = bit;
+      return kTRUE;
+    }
+    Bool_t first = !(ch_mask[det] & bit);
+    ch_mask[det] |= bit;
+    return first;
+  }
+
+  Bool_t IsSet(Int_t det, Int_t ch) const {
+    return (det_mask & (1u << det)) && (ch_mask[det] & (1u << ch));
+  }
+
+  // Bit i: detector i has a marked channel
+  UInt_t Detectors() const { return det_mask; }
+  // Bit j: channel j of detector det is marked
+  UInt_t Channels(Int_t det) const { return (det_mask & (1u << det)) ? ch_mask[det] : 0; }
+
+  // Number of the lowest bit set in mask (mask != 0)
+  static Int_t Lowest(UInt_t mask) { return __builtin_ctz(mask); }
+};
+
+#endif
@@ -0,0 +1,417 @@
+/***************************************************************
+Classes: FlatMainTree, FlatColumns, MainTreeReader
+A MainTree layout without objects: the Si and PC hits of an event are
+written as arrays of numbers, one branch per member, instead of
+vector<struct> branches.
+
+The nested layout (Si.Detector, Si.Hit, PC.Hit) needs the dictionary
+of tree_structure.h to be read, and every hit is streamed member by
+member as an object. In the flat layout each member of the hits is a
+branch of its own, e.g. Si.Hit.Energy[SiNHit]/F, whose entry is the
+array of that member over the hits of the event, and the number of
+hits is a branch of its own (Si.NHit). All the branches are plain
+numbers: they compress better, are read without the dictionary (also
+from TTree::Draw, uproot, ...), and an analysis that only reads a
+few members only reads their branches.
+
+  Si.NHit, Si.Hit.<member>     one row per SiHit::SortByHit
+  PC.NHit, PC.Hit.<member>     one row per PCHit::SortByPC
+  Si.NDet, Si.Det.<member>     one row per SiHit::SortByDetector: DetID,
+                               multiplicities, HitType and the number of
+                               channels of each side (NUp, NDown, NFront, NBack)
+  Si.NStrip, Si.Strip.<member> the channels of the detectors, detector after
+                               detector and Up, Down, Front, Back within a
+                               detector: ChNum, ECal, T, and ERaw, EPulser,
+                               ERel when the tree has the energy steps
+
+The Double_t members are written as Float_t. Si.NSiHits, PC.NPCHits
+and the other single numbers of MainTree keep their branches.
+
+Writing (Main.cpp, FlatOutput):
+  FlatMainTree Flat(esteps);
+  Flat.Branch(MainTree);
+  Flat.Set(Si,PC);  //before each MainTree->Fill(), or Set(*Si.ReadDet,*Si.ReadHit,*PC.ReadHit)
+
+Reading, whatever the layout of the tree (the Analyzers):
+  MainTreeReader reader(tree,Si,PC);  //binds Si.NSiHits, Si.ReadHit, PC.ReadHit, ...
+  reader.GetEntry(i);                 //instead of tree->GetEvent(i)
+With a flat tree the reader fills Si.Hit, Si.Detector and PC.Hit from
+the arrays and points Si.ReadHit, Si.ReadDet and PC.ReadHit to them, so
+the code after GetEntry() is the same for both layouts. Built on a
+TreeInput (TreeInput.h), the reader declares the hit branches to it,
+without those of Si.Detector if detectors is kFALSE:
+  TreeInput input(tree,InputCache);
+  MainTreeReader reader(input,Si,PC,kFALSE);
+****************************************************************/
+#ifndef FLATMAINTREE_H
+#define FLATMAINTREE_H
+
+// C++ includes
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <TROOT.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TLeaf.h>
+
+#include "TreeInput.h"
+
+// SiHit and PCHit: tree_structure.h, included before this file
+
+// The members of a vector of Row, written as one array branch each
+template<class Row> class FlatColumns {
+  std::string prefix;    //the branches are prefix + member name
+  std::string counter;   //branch of the number of rows
+  std::string countleaf; //its leaf, the dimension of the arrays
+  std::vector<std::string> inames, fnames;
+  std::vector<Int_t Row::*> imembers;
+  std::vector<Double_t Row::*> fmembers;
+  std::vector<std::vector<Int_t> > icols;
+  std::vector<std::vector<Float_t> > fcols;
+  std::vector<TBranch*> ibranches, fbranches; //to move the addresses when the columns grow
+  std::vector<Bool_t> fwritten;               //float columns written (all are read when present)
+  std::vector<Bool_t> ipresent, fpresent;     //branches found in the tree read
+  Int_t n;
+  size_t capacity;
+
+  void Grow(size_t rows) {
+    if (rows <= capacity) return;
+    capacity = rows < 2*capacity ? 2*capacity : rows;
+    for (size_t c=0; c<icols.size(); c++) icols[c].resize(capacity);
+    for (size_t c=0; c<fcols.size(); c++) fcols[c].resize(capacity);
+    for (size_t c=0; c<ibranches.size(); c++) ibranches[c]->SetAddress(&icols[c][0]);
+    for (size_t c=0; c<fbranches.size(); c++) if (fbranches[c]) fbranches[c]->SetAddress(&fcols[c][0]);
+  }
+
+ public:
+  FlatColumns(const char* branch_prefix, const char* count_branch, const char* count_leaf)
+    : prefix(branch_prefix), counter(count_branch), countleaf(count_leaf), n(0), capacity(0) {}
+
+  void AddInt(const char* name, Int_t Row::*member) {
+    inames.push_back(name);
+    imembers.push_back(member);
+    icols.push_back(std::vector<Int_t>());
+  }
+  // write: kFALSE for a column that is read if the tree has it but not written
+  void AddFloat(const char* name, Double_t Row::*member, Bool_t write = kTRUE) {
+    fnames.push_back(name);
+    fmembers.push_back(member);
+    fcols.push_back(std::vector<Float_t>());
+    fwritten.push_back(write);
+  }
+
+  Int_t GetN() const { return n; }
+
+  // Writing: creates the branches in tree
+  void Branch(TTree* tree) {
+    Grow(64);
+    tree->Branch(counter.c_str(),&n,(countleaf + "/I").c_str());
+    for (size_t c=0; c<icols.size(); c++)
+      ibranches.push_back(tree->Branch((prefix + inames[c]).c_str(),&icols[c][0],(inames[c] + "[" + countleaf + "]/I").c_str()));
+    for (size_t c=0; c<fcols.size(); c++)
+      fbranches.push_back(fwritten[c] ? tree->Branch((prefix + fnames[c]).c_str(),&fcols[c][0],(fnames[c] + "[" + countleaf + "]/F").c_str()) : NULL);
+  }
+
+  // Writing: the rows of the next entry
+  void Set(const std::vector<Row>& rows) {
+    Grow(rows.size());
+    n = rows.size();
+    for (size_t c=0; c<icols.size(); c++)
+      for (Int_t r=0; r<n; r++) icols[c][r] = rows[r].*imembers[c];
+    for (size_t c=0; c<fcols.size(); c++)
+      if (fwritten[c])
+	for (Int_t r=0; r<n; r++) fcols[c][r] = rows[r].*fmembers[c];
+  }
+
+  // Reading: binds the branches of tree. kFALSE if the tree does not have them.
+  // The columns are as long as the longest entry of the tree.
+  Bool_t SetBranchAddress(TTree* tree) {
+    TLeaf* leaf = tree->GetLeaf(countleaf.c_str());
+    if (!tree->GetBranch(counter.c_str()) || !leaf) return kFALSE;
+    Grow(leaf->GetMaximum() > 1 ? leaf->GetMaximum() : 1);
+    tree->SetBranchAddress(counter.c_str(),&n);
+    ipresent.assign(icols.size(),kFALSE);
+    fpresent.assign(fcols.size(),kFALSE);
+    for (size_t c=0; c<icols.size(); c++)
+      if ((ipresent[c] = (tree->GetBranch((prefix + inames[c]).c_str()) != NULL)))
+	tree->SetBranchAddress((prefix + inames[c]).c_str(),&icols[c][0]);
+    for (size_t c=0; c<fcols.size(); c++)
+      if ((fpresent[c] = (tree->GetBranch((prefix + fnames[c]).c_str()) != NULL)))
+	tree->SetBranchAddress((prefix + fnames[c]).c_str(),&fcols[c][0]);
+    return kTRUE;
+  }
+
+  // Reading: whether the tree has the branch of member name
+  Bool_t Has(const char* name) const {
+    for (size_t c=0; c<inames.size(); c++) if (inames[c] == name) return c < ipresent.size() && ipresent[c];
+    for (size_t c=0; c<fnames.size(); c++) if (fnames[c] == name) return c < fpresent.size() && fpresent[c];
+    return kFALSE;
+  }
+
+  // Reading: the rows of the entry read; members without a branch are 0 or NaN
+  void Get(std::vector<Row>& rows) const {
+    rows.resize(n);
+    for (size_t c=0; c<icols.size(); c++)
+      for (Int_t r=0; r<n; r++) rows[r].*imembers[c] = ipresent[c] ? icols[c][r] : 0;
+    for (size_t c=0; c<fcols.size(); c++)
+      for (Int_t r=0; r<n; r++) rows[r].*fmembers[c] = fpresent[c] ? fcols[c][r] : sqrt(-1);
+  }
+};
+
+// A row of Si.Det: the numbers of a SiHit::SortByDetector and the number of its channels per side
+struct FlatDetector {
+  Int_t DetID, UpMult, DownMult, FrontMult, BackMult, HitType;
+  Int_t NUp, NDown, NFront, NBack;
+};
+
+// A row of Si.Strip: one channel of a SiHit::SortByDetector
+struct FlatStrip {
+  Int_t ChNum;
+  Double_t ERaw, EPulser, ERel, ECal, T;
+};
+
+class FlatMainTree {
+  FlatColumns<SiHit::SortByHit> SiHits;
+  FlatColumns<FlatDetector> SiDets;
+  FlatColumns<FlatStrip> SiStrips;
+  FlatColumns<PCHit::SortByPC> PCHits;
+  std::vector<FlatDetector> dets;
+  std::vector<FlatStrip> strips;
+  Bool_t esteps;
+
+  static Double_t At(const std::vector<Double_t>& v, size_t k) { return k < v.size() ? v[k] : sqrt(-1); }
+
+  void AddStrips(const std::vector<Int_t>& ch, const std::vector<Double_t>& raw, const std::vector<Double_t>& pulser,
+		 const std::vector<Double_t>& rel, const std::vector<Double_t>& cal, const std::vector<Double_t>& t) {
+    for (size_t k=0; k<ch.size(); k++) {
+      FlatStrip s = { ch[k], At(raw,k), At(pulser,k), At(rel,k), At(cal,k), At(t,k) };
+      strips.push_back(s);
+    }
+  }
+
+  size_t GetStrips(size_t first, Int_t nstrips, std::vector<Int_t>& ch, std::vector<Double_t>& raw, std::vector<Double_t>& pulser,
+		   std::vector<Double_t>& rel, std::vector<Double_t>& cal, std::vector<Double_t>& t) const {
+    ch.clear(); raw.clear(); pulser.clear(); rel.clear(); cal.clear(); t.clear();
+    for (size_t k=first; k<first+nstrips && k<strips.size(); k++) {
+      ch.push_back(strips[k].ChNum);
+      if (esteps) {
+	raw.push_back(strips[k].ERaw);
+	pulser.push_back(strips[k].EPulser);
+	rel.push_back(strips[k].ERel);
+      }
+      cal.push_back(strips[k].ECal);
+      t.push_back(strips[k].T);
+    }
+    return first + nstrips;
+  }
+
+ public:
+  // with_steps: write ERaw, EPulser and ERel of the Si channels (FillTree_Esteps, Hist_for_Si_Cal)
+  FlatMainTree(Bool_t with_steps = kFALSE)
+    : SiHits("Si.Hit.","Si.NHit","SiNHit"), SiDets("Si.Det.","Si.NDet","SiNDet"),
+      SiStrips("Si.Strip.","Si.NStrip","SiNStrip"), PCHits("PC.Hit.","PC.NHit","PCNHit"), esteps(with_steps) {
+    typedef SiHit::SortByHit H;
+    SiHits.AddInt("NHitsInDet",&H::NHitsInDet);
+    SiHits.AddInt("DetID",&H::DetID);
+    SiHits.AddInt("HitType",&H::HitType);
+    SiHits.AddInt("FrontChannel",&H::FrontChannel);
+    SiHits.AddInt("BackChannel",&H::BackChannel);
+    SiHits.AddInt("TrackType",&H::TrackType);
+    SiHits.AddFloat("EnergyBack",&H::EnergyBack);
+    SiHits.AddFloat("EnergyFront",&H::EnergyFront);
+    SiHits.AddFloat("Energy",&H::Energy);
+    SiHits.AddFloat("Time",&H::Time);
+    SiHits.AddFloat("X",&H::X);
+    SiHits.AddFloat("Y",&H::Y);
+    SiHits.AddFloat("Z",&H::Z);
+    SiHits.AddFloat("ZUp",&H::ZUp);
+    SiHits.AddFloat("ZDown",&H::ZDown);
+    SiHits.AddFloat("ZUpCal",&H::ZUpCal);
+    SiHits.AddFloat("ZDownCal",&H::ZDownCal);
+    SiHits.AddFloat("XW",&H::XW);
+    SiHits.AddFloat("YW",&H::YW);
+    SiHits.AddFloat("ZW",&H::ZW);
+    SiHits.AddFloat("RW",&H::RW);
+    SiHits.AddFloat("PhiW",&H::PhiW);
+
+    SiDets.AddInt("DetID",&FlatDetector::DetID);
+    SiDets.AddInt("UpMult",&FlatDetector::UpMult);
+    SiDets.AddInt("DownMult",&FlatDetector::DownMult);
+    SiDets.AddInt("FrontMult",&FlatDetector::FrontMult);
+    SiDets.AddInt("BackMult",&FlatDetector::BackMult);
+    SiDets.AddInt("HitType",&FlatDetector::HitType);
+    SiDets.AddInt("NUp",&FlatDetector::NUp);
+    SiDets.AddInt("NDown",&FlatDetector::NDown);
+    SiDets.AddInt("NFront",&FlatDetector::NFront);
+    SiDets.AddInt("NBack",&FlatDetector::NBack);
+
+    SiStrips.AddInt("ChNum",&FlatStrip::ChNum);
+    SiStrips.AddFloat("ERaw",&FlatStrip::ERaw,esteps);
+    SiStrips.AddFloat("EPulser",&FlatStrip::EPulser,esteps);
+    SiStrips.AddFloat("ERel",&FlatStrip::ERel,esteps);
+    SiStrips.AddFloat("ECal",&FlatStrip::ECal);
+    SiStrips.AddFloat("T",&FlatStrip::T);
+
+    typedef PCHit::SortByPC P;
+    PCHits.AddInt("WireID",&P::WireID);
+    PCHits.AddInt("TrackType",&P::TrackType);
+    PCHits.AddFloat("Down",&P::Down);
+    PCHits.AddFloat("Up",&P::Up);
+    PCHits.AddFloat("DownVoltage",&P::DownVoltage);
+    PCHits.AddFloat("UpVoltage",&P::UpVoltage);
+    PCHits.AddFloat("DownRel",&P::DownRel);
+    PCHits.AddFloat("UpRel",&P::UpRel);
+    PCHits.AddFloat("Sum",&P::Sum);
+    PCHits.AddFloat("SumVoltage",&P::SumVoltage);
+    PCHits.AddFloat("SumRel",&P::SumRel);
+    PCHits.AddFloat("Energy",&P::Energy);
+    PCHits.AddFloat("Z",&P::Z);
+    PCHits.AddFloat("XW",&P::XW);
+    PCHits.AddFloat("YW",&P::YW);
+    PCHits.AddFloat("ZW",&P::ZW);
+    PCHits.AddFloat("RW",&P::RW);
+    PCHits.AddFloat("PhiW",&P::PhiW);
+  }
+
+  Bool_t HasSteps() const { return esteps; }
+
+  // Writing: creates the branches of the Si and PC hits in tree
+  void Branch(TTree* tree) {
+    SiDets.Branch(tree);
+    SiStrips.Branch(tree);
+    SiHits.Branch(tree);
+    PCHits.Branch(tree);
+  }
+
+  // Writing: the hits of the next entry
+  void Set(const SiHit& Si, const PCHit& PC) { Set(Si.Detector,Si.Hit,PC.Hit); }
+  void Set(const std::vector<SiHit::SortByDetector>& si_det, const std::vector<SiHit::SortByHit>& si_hit,
+	   const std::vector<PCHit::SortByPC>& pc_hit) {
+    dets.clear();
+    strips.clear();
+    for (size_t d=0; d<si_det.size(); d++) {
+      const SiHit::SortByDetector& det = si_det[d];
+      FlatDetector fd = { det.DetID, det.UpMult, det.DownMult, det.FrontMult, det.BackMult, det.HitType,
+			  (Int_t)det.UpChNum.size(), (Int_t)det.DownChNum.size(),
+			  (Int_t)det.FrontChNum.size(), (Int_t)det.BackChNum.size() };
+      dets.push_back(fd);
+      AddStrips(det.UpChNum,det.EUp_Raw,det.EUp_Pulser,det.EUp_Rel,det.EUp_Cal,det.TUp);
+      AddStrips(det.DownChNum,det.EDown_Raw,det.EDown_Pulser,det.EDown_Rel,det.EDown_Cal,det.TDown);
+      AddStrips(det.FrontChNum,det.EFront_Raw,det.EFront_Pulser,det.EFront_Rel,det.EFront_Cal,det.TFront);
+      AddStrips(det.BackChNum,det.EBack_Raw,det.EBack_Pulser,det.EBack_Rel,det.EBack_Cal,det.TBack);
+    }
+    SiDets.Set(dets);
+    SiStrips.Set(strips);
+    SiHits.Set(si_hit);
+    PCHits.Set(pc_hit);
+  }
+
+  // Reading: binds the branches of tree. kFALSE if the tree is not flat.
+  Bool_t SetBranchAddress(TTree* tree) {
+    if (!tree->GetBranch("Si.NHit")) return kFALSE;
+    SiDets.SetBranchAddress(tree);
+    if (SiStrips.SetBranchAddress(tree)) esteps = SiStrips.Has("ERaw");
+    SiHits.SetBranchAddress(tree);
+    PCHits.SetBranchAddress(tree);
+    return kTRUE;
+  }
+
+  // Reading: the hits of the entry read, into Si.Detector, Si.Hit and PC.Hit
+  void Get(SiHit& Si, PCHit& PC) {
+    SiDets.Get(dets);
+    SiStrips.Get(strips);
+    Si.Detector.resize(dets.size());
+    size_t k = 0;
+    for (size_t d=0; d<dets.size(); d++) {
+      SiHit::SortByDetector& det = Si.Detector[d];
+      det.DetID = dets[d].DetID;
+      det.UpMult = dets[d].UpMult;
+      det.DownMult = dets[d].DownMult;
+      det.FrontMult = dets[d].FrontMult;
+      det.BackMult = dets[d].BackMult;
+      det.HitType = dets[d].HitType;
+      k = GetStrips(k,dets[d].NUp,det.UpChNum,det.EUp_Raw,det.EUp_Pulser,det.EUp_Rel,det.EUp_Cal,det.TUp);
+      k = GetStrips(k,dets[d].NDown,det.DownChNum,det.EDown_Raw,det.EDown_Pulser,det.EDown_Rel,det.EDown_Cal,det.TDown);
+      k = GetStrips(k,dets[d].NFront,det.FrontChNum,det.EFront_Raw,det.EFront_Pulser,det.EFront_Rel,det.EFront_Cal,det.TFront);
+      k = GetStrips(k,dets[d].NBack,det.BackChNum,det.EBack_Raw,det.EBack_Pulser,det.EBack_Rel,det.EBack_Cal,det.TBack);
+    }
+    SiHits.Get(Si.Hit);
+    PCHits.Get(PC.Hit);
+  }
+};
+
+// Reads the Si and PC hits of a MainTree written by Main, flat or nested
+class MainTreeReader {
+  TTree* tree;
+  TreeInput* input;
+  SiHit& Si;
+  PCHit& PC;
+  FlatMainTree flat;
+  Bool_t isflat;
+
+  void Bind(Bool_t detectors) {
+    Bind("Si.NSiHits",&Si.NSiHits);
+    Bind("PC.NPCHits",&PC.NPCHits);
+    isflat = flat.SetBranchAddress(tree);
+    if (isflat) {
+      Si.ReadDet = &Si.Detector;
+      Si.ReadHit = &Si.Hit;
+      PC.ReadHit = &PC.Hit;
+      if (input) {
+	input->Use("Si.NHit");
+	input->Use("Si.Hit.*");
+	input->Use("PC.NHit");
+	input->Use("PC.Hit.*");
+	if (detectors) {
+	  input->Use("Si.NDet");
+	  input->Use("Si.Det.*");
+	  input->Use("Si.NStrip");
+	  input->Use("Si.Strip.*");
+	}
+      }
+    }
+    else {
+      Si.ReadDet = detectors ? 0 : &Si.Detector;
+      Si.ReadHit = 0;
+      PC.ReadHit = 0;
+      if (detectors) Bind("Si.Detector",&Si.ReadDet,kTRUE);
+      Bind("Si.Hit",&Si.ReadHit,kTRUE);
+      Bind("PC.Hit",&PC.ReadHit,kTRUE);
+    }
+  }
+
+  // split: an object branch, read with its sub-branches
+  template<class T> void Bind(const char* name, T* address, Bool_t split = kFALSE) {
+    if (input) {
+      input->Read(name,address);
+      if (split) input->Use((std::string(name) + ".*").c_str());
+    }
+    else
+      tree->SetBranchAddress(name,address);
+  }
+
+ public:
+  MainTreeReader(TTree* t, SiHit& si, PCHit& pc) : tree(t), input(NULL), Si(si), PC(pc), isflat(kFALSE) {
+    Bind(kTRUE);
+  }
+  // Reads through in, which only reads the hit branches (and the other branches declared to it);
+  // detectors: kFALSE if Si.Detector is not used, Si.ReadDet is then empty
+  MainTreeReader(TreeInput& in, SiHit& si, PCHit& pc, Bool_t detectors = kTRUE)
+    : tree(in.GetTree()), input(&in), Si(si), PC(pc), isflat(kFALSE) {
+    Bind(detectors);
+  }
+
+  Bool_t IsFlat() const { return isflat; }
+  Bool_t HasSteps() const { return flat.HasSteps(); }
+
+  // Same as tree->GetEntry(entry); Si.ReadDet, Si.ReadHit and PC.ReadHit then hold the hits
+  Int_t GetEntry(Long64_t entry) {
+    Int_t status = input ? input->GetEntry(entry) : tree->GetEntry(entry);
+    if (isflat && status > 0) flat.Get(Si,PC);
+    return status;
+  }
+};
+
+#endif
@@ -0,0 +1,199 @@
+/***************************************************************
+Classes: HistRegistry, HistFamily, HistSlot
+Histograms filled through integer handles instead of by name.
+
+MyFill(Form("down_vs_up%i_%i_%i",det,up,back),...) formatted the name,
+built a string and searched it in a std::map for every fill. Here each
+histogram, or family of histograms differing only by indices, is
+declared once:
+
+  HistRegistry fh;
+  HistFamily hTime_RF = fh.Book("Time_RF");
+  HistFamily hdown_vs_upN_N_N = fh.Book("down_vs_up%i_%i_%i",28,4,4);
+
+and filled through the handle, which indexes an array of TH1 pointers:
+
+  fh.Fill(hTime_RF(),1028,0,4096,RFTime);
+  fh.Fill(hdown_vs_upN_N_N(det,up,back),bins,0,udmax,eup,bins,0,udmax,edown);
+
+As with MyFill, the binning is given at the fill and a histogram is
+created (TH1F or TH2F, named by the format and the indices) and added
+to the list at its first fill, so the names, binnings and order of the
+histograms in the list do not change. Indices outside the declared
+ranges are looked up by name and still work, only more slowly.
+
+SetLookupByName(true) formats and searches the name on every fill as
+MyFill did, to compare the event rates.
+
+For an event loop on several threads each thread fills a copy of the
+registry (copied before the first fill, without a list) and tells it
+the entry of each event with SetEntry(). Merge() then puts the
+histograms of all copies in the list in the order of their first fill
+over all entries, as one registry filling entry after entry would have
+done, and adds up the histograms created by several threads. The bin
+contents and entries are those of a single registry; the sums of the
+statistics (mean, RMS) can differ in the last digits, as they are
+added up in another order.
+****************************************************************/
+#ifndef HISTREGISTRY_H
+#define HISTREGISTRY_H
+
+// C++ includes
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include <TString.h>
+#include <TList.h>
+#include <TH1.h>
+#include <TH2.h>
+
+// One histogram of a family: the position in the handle array (-1 if the
+// indices are outside the declared ranges) and the indices of its name.
+struct HistSlot {
+  int family;
+  int slot;
+  int i0, i1, i2;
+};
+
+// Handle of a histogram family, returned by HistRegistry::Book().
+class HistFamily {
+  int family, first, n0, n1, n2;
+ public:
+  HistFamily(int f = -1, int start = 0, int m0 = 1, int m1 = 1, int m2 = 1)
+    : family(f), first(start), n0(m0), n1(m1), n2(m2) {}
+
+  HistSlot operator()(int i0 = 0, int i1 = 0, int i2 = 0) const {
+    HistSlot s = { family, -1, i0, i1, i2 };
+    if((unsigned)i0 < (unsigned)n0 && (unsigned)i1 < (unsigned)n1 && (unsigned)i2 < (unsigned)n2)
+      s.slot = first + (i0*n1 + i1)*n2 + i2;
+    return s;
+  }
+};
+
+class HistRegistry {
+  TList* list;
+  bool byname;
+  std::vector<std::string> formats; //name format of each family
+  std::vector<TH1*> slots;          //histograms of all families, NULL until the first fill
+  std::map<std::string,TH1*> names; //every histogram created, by name
+  std::vector<TH1*> created;        //in the order of creation
+  std::vector<Long64_t> stamps;     //entry that created them
+  Long64_t entry;
+
+  std::string Name(const HistSlot& s) const {
+    return Form(formats[s.family].c_str(),s.i0,s.i1,s.i2);
+  }
+
+  TH1* Find(const HistSlot& s, const std::string& name) {
+    std::map<std::string,TH1*>::const_iterator it = names.find(name);
+    TH1* h = it == names.end() ? NULL : it->second;
+    if(h && s.slot >= 0) slots[s.slot] = h;
+    return h;
+  }
+
+  void Add(const HistSlot& s, const std::string& name, TH1* h) {
+    if(list) list->Add(h);
+    names[name] = h;
+    if(s.slot >= 0) slots[s.slot] = h;
+    created.push_back(h);
+    stamps.push_back(entry);
+  }
+
+  struct Created {
+    Long64_t entry;
+    size_t part, index;
+    bool operator<(const Created& o) const {
+      return entry != o.entry ? entry < o.entry : part != o.part ? part < o.part : index < o.index;
+    }
+  };
+
+  // Histogram of s, or NULL if it does not exist yet.
+  TH1* Get(const HistSlot& s, std::string& name) {
+    if(!byname && s.slot >= 0 && slots[s.slot]) return slots[s.slot];
+    name = Name(s);
+    return Find(s,name);
+  }
+
+ public:
+  HistRegistry(TList* l = NULL) : list(l), byname(false), entry(0) {}
+
+  // The list the histograms are added to when they are created.
+  void SetList(TList* l) { list = l; }
+  void SetLookupByName(bool b) { byname = b; }
+  // Entry of the event being filled, which orders the histograms in Merge().
+  void SetEntry(Long64_t e) { entry = e; }
+
+  // Declares the histograms named format (printf style, up to three
+  // integer indices) with indices [0,n0) x [0,n1) x [0,n2).
+  HistFamily Book(const char* format, int n0 = 1, int n1 = 1, int n2 = 1) {
+    HistFamily f(formats.size(),slots.size(),n0,n1,n2);
+    formats.push_back(format);
+    slots.resize(slots.size() + n0*n1*n2,NULL);
+    return f;
+  }
+
+  void Fill(const HistSlot& s, int binsX, double lowX, double highX, double valueX) {
+    std::string name;
+    TH1* h = Get(s,name);
+    if(!h) {
+      h = new TH1F(name.c_str(),name.c_str(),binsX,lowX,highX);
+      Add(s,name,h);
+    }
+    h->Fill(valueX);
+  }
+
+  void Fill(const HistSlot& s,
+	    int binsX, double lowX, double highX, double valueX,
+	    int binsY, double lowY, double highY, double valueY) {
+    std::string name;
+    TH1* h = Get(s,name);
+    if(!h) {
+      h = new TH2F(name.c_str(),name.c_str(),binsX,lowX,highX,binsY,lowY,highY);
+      Add(s,name,h);
+    }
+    h->Fill(valueX,valueY);
+  }
+
+  // Histogram of s if it has been filled, otherwise NULL.
+  TH1* Get(const HistSlot& s) {
+    std::string name;
+    return Get(s,name);
+  }
+
+  // Adds the histograms of the copies parts, filled on separate entries,
+  // to list in the order of their first fill. A histogram that several
+  // parts have created is added up into the first one, the others are
+  // deleted; the parts are left empty.
+  static void Merge(const std::vector<HistRegistry*>& parts, TList* list) {
+    std::vector<Created> all;
+    for(size_t p=0; p<parts.size(); p++)
+      for(size_t i=0; i<parts[p]->created.size(); i++) {
+	Created c = { parts[p]->stamps[i], p, i };
+	all.push_back(c);
+      }
+    std::sort(all.begin(),all.end());
+    std::map<std::string,TH1*> merged;
+    for(size_t i=0; i<all.size(); i++) {
+      TH1* h = parts[all[i].part]->created[all[i].index];
+      std::map<std::string,TH1*>::iterator it = merged.find(h->GetName());
+      if(it == merged.end()) {
+	merged[h->GetName()] = h;
+	if(list) list->Add(h);
+      }
+      else {
+	it->second->Add(h);
+	delete h;
+      }
+    }
+    for(size_t p=0; p<parts.size(); p++) {
+      std::fill(parts[p]->slots.begin(),parts[p]->slots.end(),(TH1*)NULL);
+      parts[p]->names.clear();
+      parts[p]->created.clear();
+      parts[p]->stamps.clear();
+    }
+  }
+};
+
+#endif
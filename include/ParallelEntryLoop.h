@@ -0,0 +1,106 @@
+/***************************************************************
+Class: ParallelEntryLoop
+Runs an event loop over the entries [first,last) on several threads
+and hands the results back in entry order.
+
+The entries are split into chunks of consecutive entries. Each thread
+takes the next chunk that nobody has taken, runs work() on it and goes
+on with the next one. The calling thread gets the results of the
+chunks in entry order through done(), e.g. to fill the output tree,
+so that the tree has the same events in the same order as with one
+thread:
+
+  ParallelEntryLoop<Output> loop(0,nentries,NThreads,ChunkSize);
+  loop.Run([&](int thread, Long64_t first, Long64_t last, Output& out){
+             //runs on thread thread: process entries [first,last) into out
+           },
+           [&](Long64_t first, Long64_t last, Output& out){
+             //runs on the calling thread, one chunk after the other
+           });
+
+At most window chunks per thread are processed ahead of the chunk
+being handed back, which bounds the memory of the buffered results.
+Everything work() changes has to belong to its thread (input tree,
+event variables, histograms); what the threads share has to be
+read-only while the loop runs.
+****************************************************************/
+#ifndef PARALLELENTRYLOOP_H
+#define PARALLELENTRYLOOP_H
+
+// C++ includes
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <TROOT.h>
+
+template<class Result> class ParallelEntryLoop {
+  struct Chunk {
+    Long64_t first, last;
+    bool done;
+    Result result;
+  };
+
+  std::vector<Chunk> chunks;
+  int nthreads;
+  Long64_t window;
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  Long64_t next;   //first chunk not taken by a thread
+  Long64_t handed; //first chunk not handed back
+
+ public:
+  ParallelEntryLoop(Long64_t first, Long64_t last, int threads, Long64_t chunk_size, int window_per_thread = 2)
+    : nthreads(threads < 1 ? 1 : threads), window((Long64_t)nthreads*(window_per_thread < 1 ? 1 : window_per_thread)),
+      next(0), handed(0) {
+    if(chunk_size < 1) chunk_size = 1;
+    for(Long64_t e = first; e < last; e += chunk_size) {
+      Chunk c;
+      c.first = e;
+      c.last = e + chunk_size < last ? e + chunk_size : last;
+      c.done = false;
+      chunks.push_back(c);
+    }
+  }
+
+  Long64_t GetNChunks() const { return chunks.size(); }
+  int GetNThreads() const { return nthreads; }
+
+  template<class W, class D> void Run(W work, D done) {
+    const Long64_t nchunks = chunks.size();
+    std::vector<std::thread> threads;
+    for(int t=0; t<nthreads; t++)
+      threads.push_back(std::thread([this,t,nchunks,&work]{
+	    for(;;) {
+	      Long64_t k;
+	      {
+		std::unique_lock<std::mutex> lock(mtx);
+		cv.wait(lock,[this,nchunks]{ return next >= nchunks || next < handed + window; });
+		if(next >= nchunks) return;
+		k = next++;
+	      }
+	      work(t,chunks[k].first,chunks[k].last,chunks[k].result);
+	      std::lock_guard<std::mutex> lock(mtx);
+	      chunks[k].done = true;
+	      cv.notify_all();
+	    }
+	  }));
+
+    for(Long64_t k=0; k<nchunks; k++) {
+      {
+	std::unique_lock<std::mutex> lock(mtx);
+	cv.wait(lock,[this,k]{ return chunks[k].done; });
+      }
+      done(chunks[k].first,chunks[k].last,chunks[k].result);
+      chunks[k].result = Result(); //free the buffered results
+      std::lock_guard<std::mutex> lock(mtx);
+      handed = k+1;
+      cv.notify_all();
+    }
+    for(size_t t=0; t<threads.size(); t++) threads[t].join();
+  }
+};
+
+#endif
@@ -0,0 +1,134 @@
+/***************************************************************
+Class: TreeFillThread
+Fills an output TTree on a background thread.
+
+TTree::Fill() serializes the branch variables into the baskets and
+compresses a basket whenever it is full, which for MainTree with its
+vectors of structs is a good part of the run time. With this class the
+event loop hands each event over and goes on with the next one, while
+a second thread runs TTree::Fill() on a copy of the branch variables
+(double buffering: one event being filled, one being processed).
+
+The branches are created on the copies, which Copy() returns:
+  TreeFillThread MainFill(MainTree,FillThread);
+  MainTree->Branch("Tr.NTracks",MainFill.Copy(Tr.NTracks),"NTracks/I");
+  MainTree->Branch("Tr.TrEvent",MainFill.Copy(Tr.TrEvent));
+  ...
+  MainFill.Fill();   //instead of MainTree->Fill()
+  ...
+  MainFill.Finish(); //before the tree is written
+Fill() waits for the previous event to be written, copies the branch
+variables (operator=, or the copy function given to Copy()) and
+returns. The tree gets the same values in the same order as with
+MainTree->Fill(), so its content does not change.
+
+With threaded=kFALSE, Copy() returns the variable itself and Fill()
+calls TTree::Fill() directly, as without this class.
+
+Convert() is Copy() for a branch variable of another type, made from
+the loop variable at each Fill(), e.g. the flat arrays of the hits
+(FlatMainTree.h); it works in both modes.
+
+Independently of this, ROOT::EnableImplicitMT() lets TTree::Fill()
+compress the baskets of the different branches in parallel.
+****************************************************************/
+#ifndef TREEFILLTHREAD_H
+#define TREEFILLTHREAD_H
+
+// C++ includes
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include <TROOT.h>
+#include <TTree.h>
+
+class TreeFillThread {
+  TTree* tree;
+  bool threaded;
+  std::vector<std::function<void()> > handover; //copy the loop variables to the branch copies
+  std::vector<std::function<void()> > cleanup;
+
+  std::thread writer;
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool pending; //an event is waiting for or being filled
+  bool stop;
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    for(;;) {
+      cv.wait(lock,[this]{ return pending || stop; });
+      if(!pending) break;
+      lock.unlock();
+      tree->Fill();
+      lock.lock();
+      pending = false;
+      cv.notify_all();
+    }
+  }
+
+ public:
+  TreeFillThread(TTree* t, bool thread = true) : tree(t), threaded(thread), pending(false), stop(false) {
+    if(threaded) {
+      ROOT::EnableThreadSafety();
+      writer = std::thread(&TreeFillThread::Run,this);
+    }
+  }
+  ~TreeFillThread() {
+    Finish();
+    for(size_t i=0; i<cleanup.size(); i++) cleanup[i]();
+  }
+
+  // Address to give to TTree::Branch() for the loop variable var.
+  template<class T> T* Copy(T& var) {
+    return Copy(var,[](const T& from, T& to){ to = from; });
+  }
+  template<class T, class F> T* Copy(T& var, F copy) {
+    if(!threaded) return &var;
+    T* out = new T(var);
+    T* in = &var;
+    handover.push_back([in,out,copy]{ copy(*in,*out); });
+    cleanup.push_back([out]{ delete out; });
+    return out;
+  }
+
+  // Returns out, which convert(var,*out) makes from the loop variable var at each Fill().
+  // out is deleted with the TreeFillThread.
+  template<class U, class T, class F> U* Convert(T& var, U* out, F convert) {
+    T* in = &var;
+    handover.push_back([in,out,convert]{ convert(*in,*out); });
+    cleanup.push_back([out]{ delete out; });
+    return out;
+  }
+
+  // Writes the current values of the loop variables to the tree.
+  void Fill() {
+    if(!threaded) {
+      for(size_t i=0; i<handover.size(); i++) handover[i](); //only Convert() in this mode
+      tree->Fill();
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock,[this]{ return !pending; });
+    for(size_t i=0; i<handover.size(); i++) handover[i]();
+    pending = true;
+    cv.notify_all();
+  }
+
+  // Waits until all events are in the tree and stops the thread.
+  void Finish() {
+    if(!writer.joinable()) return;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock,[this]{ return !pending; });
+      stop = true;
+      cv.notify_all();
+    }
+    writer.join();
+  }
+};
+
+#endif
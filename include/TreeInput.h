@@ -0,0 +1,173 @@
+/***************************************************************
+Class: TreeInput
+Reads the entries of an input tree through a TTreeCache, reading
+only the branches that the analysis declares, and keeps the bytes,
+read calls and time spent reading.
+
+TTree::GetEntry() reads every branch that is not disabled, so a
+program that binds three branches still reads all of them (e.g. the
+24 vectors of Si.Detector when only Si.Hit and PC.Hit are used), and
+without a cache each basket is a read call of its own. With TreeInput
+the branches are bound through Read(), which also declares them;
+branches bound by other means (FlatMainTree) are declared with Use().
+At the first GetEntry() all the other branches are disabled, and the
+declared ones are put in a TTreeCache of the given size, whose
+learning phase is stopped then: the cache reads the baskets of those
+branches only, in large reads, from the first entry.
+
+  TreeInput input(tree,InputCache);      //bytes of cache
+  input.Read("RFTime",&RFTime);          //instead of tree->SetBranchAddress()
+  input.Use("Si.Hit.*");                 //read, bound elsewhere
+  for (...) input.GetEntry(i);           //instead of tree->GetEntry(i)
+  stats += input.GetStats();             //once the file is done
+  stats.Print("MainTree");
+
+Names may contain * wildcards; "X.*" also takes the sub-branches of X.
+SetAsyncPrefetch(kTRUE), before the input files are opened, has ROOT
+read the next cache blocks on a thread of its own while the current
+ones are processed (TFile.AsyncPrefetching), which hides the latency
+of a network file system. When only part of the tree is read
+(EntrySelection.h), SetEntryRange() and SetEntryList() keep the cache
+to the baskets of the entries selected. The entry list belongs to the
+TreeInput, which takes it off the tree and deletes it when destroyed,
+so the TreeInput must go before the tree (its file).
+****************************************************************/
+#ifndef TREEINPUT_H
+#define TREEINPUT_H
+
+// C includes
+#include <stdio.h>
+
+// C++ includes
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <TROOT.h>
+#include <TEnv.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TEntryList.h>
+
+// Entries, bytes and time read from the input trees
+struct TreeReadStats {
+  Long64_t entries;
+  Long64_t bytes;
+  Int_t calls;
+  Double_t time; //s in GetEntry()
+
+  TreeReadStats() : entries(0), bytes(0), calls(0), time(0) {}
+
+  TreeReadStats& operator+=(const TreeReadStats& other) {
+    entries += other.entries;
+    bytes += other.bytes;
+    calls += other.calls;
+    time += other.time;
+    return *this;
+  }
+
+  void Print(const char* what) const {
+    printf(" %s: %lld entries read, %.1f MB in %d read calls, %.2f s reading", what, entries, bytes/1e6, calls, time);
+    if (time > 0) printf(" (%.1f MB/s, %.0f entries/s)", bytes/1e6/time, entries/time);
+    printf("\n");
+  }
+};
+
+class TreeInput {
+  TTree* tree;
+  Long64_t cache_size;
+  Long64_t first, last; //entries read, [first,last)
+  TEntryList* list;
+  std::vector<std::string> names;
+  Bool_t started;
+  Long64_t bytes0; //file counters at Start()
+  Int_t calls0;
+  TreeReadStats stats;
+
+ public:
+  // cache: bytes of the TTreeCache (0: no cache)
+  TreeInput(TTree* t, Long64_t cache = 30000000) : tree(t), cache_size(cache), first(0), last(-1), list(NULL), started(kFALSE), bytes0(0), calls0(0) {}
+  ~TreeInput() { SetEntryList(NULL); }
+  TreeInput(const TreeInput&) = delete; //owns the entry list
+  TreeInput& operator=(const TreeInput&) = delete;
+
+  // Before the input files are opened: prefetch the cache blocks on a thread of ROOT
+  static void SetAsyncPrefetch(Bool_t on) { gEnv->SetValue("TFile.AsyncPrefetching",on ? 1 : 0); }
+
+  TTree* GetTree() const { return tree; }
+
+  // Declares branch name (wildcards allowed) to be read, bound elsewhere
+  void Use(const char* name) {
+    if (started) {
+      printf("TreeInput: %s declared after the first entry, not read\n",name);
+      return;
+    }
+    names.push_back(name);
+  }
+
+  // Binds branch name to address, as TTree::SetBranchAddress(), and declares it
+  template<class T> Int_t Read(const char* name, T* address) {
+    Use(name);
+    return tree->SetBranchAddress(name,address);
+  }
+
+  // Only entries [first_entry,last_entry) are read, or (list) those of the list; before the first GetEntry()
+  void SetEntryRange(Long64_t first_entry, Long64_t last_entry) { first = first_entry; last = last_entry; }
+  // The list is deleted with the TreeInput, or when another one is set
+  void SetEntryList(TEntryList* entries) {
+    if (entries == list) return;
+    if (list) {
+      if (started) tree->SetEntryList(NULL);
+      delete list;
+    }
+    list = entries;
+    if (list && started) tree->SetEntryList(list);
+  }
+
+  // Enables the declared branches only and sets the cache; done by the first GetEntry()
+  void Start() {
+    if (started) return;
+    started = kTRUE;
+    if (!names.empty()) {
+      tree->SetBranchStatus("*",0);
+      for (size_t i=0; i<names.size(); i++) tree->SetBranchStatus(names[i].c_str(),1);
+    }
+    if (cache_size > 0) {
+      tree->SetCacheSize(cache_size);
+      if (names.empty())
+	tree->AddBranchToCache("*",kTRUE);
+      for (size_t i=0; i<names.size(); i++) tree->AddBranchToCache(names[i].c_str(),kTRUE);
+      tree->StopCacheLearningPhase();
+      if (last >= 0) tree->SetCacheEntryRange(first,last);
+    }
+    if (list) tree->SetEntryList(list); //the cache skips the baskets without a listed entry
+    TFile* file = tree->GetCurrentFile();
+    if (file) {
+      bytes0 = file->GetBytesRead();
+      calls0 = file->GetReadCalls();
+    }
+  }
+
+  // Same as tree->GetEntry(entry), for the declared branches
+  Int_t GetEntry(Long64_t entry) {
+    if (!started) Start();
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    Int_t status = tree->GetEntry(entry);
+    stats.time += std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - t0).count();
+    stats.entries++;
+    return status;
+  }
+
+  // What was read so far
+  TreeReadStats GetStats() const {
+    TreeReadStats s = stats;
+    TFile* file = tree->GetCurrentFile();
+    if (file && started) {
+      s.bytes = file->GetBytesRead() - bytes0;
+      s.calls = file->GetReadCalls() - calls0;
+    }
+    return s;
+  }
+};
+
+#endif
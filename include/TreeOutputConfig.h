@@ -0,0 +1,219 @@
+/***************************************************************
+Class: TreeOutputConfig
+Compression, basket sizes and auto-flush of the output trees, read
+from a configuration file (see tree_output.dat) instead of the ROOT
+defaults.
+
+Each configuration line has the form
+
+  <tree> <branch> <option>=<value> ...
+
+where tree is the name of the tree (DataTree, MainTree, ...) and branch
+is the name of a top-level branch; both may contain * wildcards, and
+"*" alone stands for all of them. The options are
+  algorithm=ZLIB|LZMA|LZ4|ZSTD  compression algorithm
+  level=0-9                     compression level (0: uncompressed)
+  basket=<bytes>                basket size of the branch and its sub-branches
+  autoflush=<n>                 flush the baskets every n entries, or every
+                                -n bytes if n<0 (TTree::SetAutoFlush)
+autoflush only applies with branch "*". When several lines match a
+branch, the last one wins for each option, so general lines go first:
+
+  MainTree *        algorithm=ZSTD level=5 autoflush=-30000000
+  MainTree Si.Hit   basket=256000
+  MainTree PC.*     algorithm=LZ4 level=4
+
+Lines starting with # are comments. Options that are not set keep the
+value of the output file (TFile compression) and of TTree::Branch().
+
+Apply() is called once the branches exist and before the first Fill():
+  TreeOutputConfig& out = DefaultTreeOutputConfig();
+  out.Load("../include/tree_output.dat");
+  out.Apply(MainTree);
+****************************************************************/
+#ifndef TREEOUTPUTCONFIG_H
+#define TREEOUTPUTCONFIG_H
+
+// C includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// C++ includes
+#include <string>
+#include <vector>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TObjArray.h>
+
+class TreeOutputConfig {
+ public:
+  // ROOT compression algorithms, the hundreds of the compression settings
+  enum Algorithm { kDefault = 0, kZLIB = 1, kLZMA = 2, kLZ4 = 4, kZSTD = 5 };
+
+ private:
+  struct Rule {
+    std::string tree, branch;
+    int algorithm; //-1 if not set
+    int level;
+    int basket;
+    bool has_autoflush;
+    Long64_t autoflush;
+  };
+  std::vector<Rule> rules;
+
+  // Glob match with * wildcards.
+  static bool Match(const char* pattern, const char* name) {
+    if(*pattern == 0) return *name == 0;
+    if(*pattern == '*')
+      return Match(pattern+1,name) || (*name && Match(pattern,name+1));
+    return *pattern == *name && Match(pattern+1,name+1);
+  }
+
+  static void SetBasket(TBranch* b, int size) {
+    b->SetBasketSize(size);
+    TObjArray* sub = b->GetListOfBranches();
+    for(int i=0; i<sub->GetEntriesFast(); i++) SetBasket((TBranch*)sub->At(i),size);
+  }
+
+ public:
+  static const char* AlgorithmName(int alg) {
+    switch(alg) {
+    case kZLIB: return "ZLIB";
+    case kLZMA: return "LZMA";
+    case kLZ4:  return "LZ4";
+    case kZSTD: return "ZSTD";
+    }
+    return "default";
+  }
+
+  static int AlgorithmFromName(const char* name) {
+    if(strcmp(name,"ZLIB")==0 || strcmp(name,"zlib")==0) return kZLIB;
+    if(strcmp(name,"LZMA")==0 || strcmp(name,"lzma")==0) return kLZMA;
+    if(strcmp(name,"LZ4")==0  || strcmp(name,"lz4")==0)  return kLZ4;
+    if(strcmp(name,"ZSTD")==0 || strcmp(name,"zstd")==0) return kZSTD;
+    return -1;
+  }
+
+  void Clear() { rules.clear(); }
+  size_t GetNumRules() const { return rules.size(); }
+
+  // Adds the rule of one configuration line. False if it is not valid.
+  bool Parse(const char* text) {
+    char line[512];
+    strncpy(line,text,sizeof(line)-1);
+    line[sizeof(line)-1] = 0;
+    char* hash = strchr(line,'#');
+    if(hash) *hash = 0;
+    char* tree = strtok(line," \t\r\n");
+    if(!tree) return true; //empty line
+    char* branch = strtok(NULL," \t\r\n");
+    if(!branch) {
+      printf("  * TreeOutputConfig: no branch in \"%s\"\n",text);
+      return false;
+    }
+    Rule r;
+    r.tree = tree;
+    r.branch = branch;
+    r.algorithm = r.level = r.basket = -1;
+    r.has_autoflush = false;
+    r.autoflush = 0;
+    char* tok;
+    while((tok = strtok(NULL," \t\r\n"))) {
+      char* value = strchr(tok,'=');
+      if(!value) {
+	printf("  * TreeOutputConfig: option %s without value\n",tok);
+	return false;
+      }
+      *value++ = 0;
+      if(strcmp(tok,"algorithm")==0) {
+	r.algorithm = AlgorithmFromName(value);
+	if(r.algorithm < 0) {
+	  printf("  * TreeOutputConfig: unknown algorithm %s\n",value);
+	  return false;
+	}
+      }
+      else if(strcmp(tok,"level")==0) r.level = atoi(value);
+      else if(strcmp(tok,"basket")==0) r.basket = atoi(value);
+      else if(strcmp(tok,"autoflush")==0) {
+	r.has_autoflush = true;
+	r.autoflush = atoll(value);
+      }
+      else {
+	printf("  * TreeOutputConfig: unknown option %s\n",tok);
+	return false;
+      }
+    }
+    if(r.level > 9) r.level = 9;
+    rules.push_back(r);
+    return true;
+  }
+
+  // Adds the rules of a configuration file. Returns false (and adds
+  // nothing) if the file cannot be read.
+  bool Load(const char* name) {
+    FILE* f = fopen(name,"r");
+    if(!f) return false;
+    char line[512];
+    while(fgets(line,sizeof(line),f)) Parse(line);
+    fclose(f);
+    return true;
+  }
+
+  // Sets compression, basket sizes and auto-flush of tree. Returns the
+  // number of top-level branches that were changed.
+  int Apply(TTree* tree) const {
+    if(!tree) return 0;
+    int file_settings = 0;
+    if(tree->GetCurrentFile()) file_settings = tree->GetCurrentFile()->GetCompressionSettings();
+
+    for(size_t i=0; i<rules.size(); i++)
+      if(rules[i].has_autoflush && rules[i].branch=="*" && Match(rules[i].tree.c_str(),tree->GetName()))
+	tree->SetAutoFlush(rules[i].autoflush);
+
+    int changed = 0;
+    TObjArray* branches = tree->GetListOfBranches();
+    for(int n=0; n<branches->GetEntriesFast(); n++) {
+      TBranch* b = (TBranch*)branches->At(n);
+      int algorithm = -1, level = -1, basket = -1;
+      for(size_t i=0; i<rules.size(); i++) {
+	const Rule& r = rules[i];
+	if(!Match(r.tree.c_str(),tree->GetName()) || !Match(r.branch.c_str(),b->GetName())) continue;
+	if(r.algorithm >= 0) algorithm = r.algorithm;
+	if(r.level >= 0) level = r.level;
+	if(r.basket > 0) basket = r.basket;
+      }
+      if(algorithm < 0 && level < 0 && basket < 0) continue;
+      if(algorithm >= 0 || level >= 0) {
+	if(algorithm < 0) algorithm = file_settings/100;
+	if(level < 0) level = file_settings%100;
+	b->SetCompressionSettings(100*algorithm + level); //also sets the sub-branches
+      }
+      if(basket > 0) SetBasket(b,basket);
+      changed++;
+    }
+    return changed;
+  }
+
+  void Print() const {
+    for(size_t i=0; i<rules.size(); i++) {
+      const Rule& r = rules[i];
+      printf("   %s %s",r.tree.c_str(),r.branch.c_str());
+      if(r.algorithm >= 0) printf(" algorithm=%s",AlgorithmName(r.algorithm));
+      if(r.level >= 0) printf(" level=%d",r.level);
+      if(r.basket > 0) printf(" basket=%d",r.basket);
+      if(r.has_autoflush) printf(" autoflush=%lld",r.autoflush);
+      printf("\n");
+    }
+  }
+};
+
+// The configuration used by the converters and analysis programs.
+inline TreeOutputConfig& DefaultTreeOutputConfig() {
+  static TreeOutputConfig config;
+  return config;
+}
+
+#endif
@@ -4,10 +4,14 @@
 // Author: Nabin Rijal, 2016 September.
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#define MaxEntries (Long64_t) 1e9
 #define MaxWire 1e3 //set fill goal for each wire
 #define NMaxWire 21 //number of wires to fill
 #define FillTree
+#define FillThread (Bool_t) kTRUE //fill MainTree on a background thread (../include/TreeFillThread.h)
+#define FillIMT (Bool_t) kFALSE   //compress the baskets in parallel (ROOT implicit multi-threading)
+#define OutputConfig "../include/tree_output.dat" //compression, basket sizes and auto-flush (../include/TreeOutputConfig.h)
+#define InputCache (Long64_t) 30000000 //bytes of TTreeCache for the branches read from the input MainTree (../include/TreeInput.h)
+#define AsyncPrefetch (Bool_t) kFALSE  //read the next cache blocks on a ROOT thread, for input files on a network file system
 #define FillEdE_cor
 //#define CheckBasic
 //#define DoCut //read in and apply cut file?
@@ -91,19 +95,48 @@
 #include <TVector3.h>
 
 #include "../include/tree_structure.h"
+#include "../include/FlatMainTree.h"
+#include "../include/TreeInput.h"
+#include "../include/EntrySelection.h"
 #include "LookUp.h"
+#include "../include/TreeFillThread.h"
+#include "../include/TreeOutputConfig.h"
+#include "../include/HistRegistry.h"
+#include "../include/CutRegistry.h"
 
 using namespace std;
 ////////////////////////////////////////////////////////////////////////////////////
 Int_t FindMaxPC(Double_t phi, PCHit& PC);
 
-void MyFill(string name,int binsX, double lowX, double highX, double valueX);
-
-void MyFill(string name,int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY);
-
 TList* fhlist;
-std::map<string,TH1*> fhmap;
+HistRegistry fh; //histograms of fhlist, filled through the handles below (../include/HistRegistry.h)
+HistFamily hTime_MCP_vs_RF = fh.Book("Time_MCP_vs_RF");
+HistFamily hTOF_vs_RF = fh.Book("TOF_vs_RF");
+HistFamily hTOFc_vs_RF = fh.Book("TOFc_vs_RF");
+HistFamily hTOFc = fh.Book("TOFc");
+HistFamily hTOFw = fh.Book("TOFw");
+HistFamily hTOFw2 = fh.Book("TOFw2");
+HistFamily hMCP_in = fh.Book("MCP_in");
+HistFamily hTOFw_in = fh.Book("TOFw_in");
+HistFamily hMCP_out = fh.Book("MCP_out");
+HistFamily hTOFw_out = fh.Book("TOFw_out");
+HistFamily hSi_ReadHit_size = fh.Book("Si_ReadHit_size");
+HistFamily hPC_ReadHit_size = fh.Book("PC_ReadHit_size");
+HistFamily hWireID_vs_PCEnegy = fh.Book("WireID_vs_PCEnegy");
+HistFamily hWireID_mod1_vs_PCEnegy = fh.Book("WireID_mod1_vs_PCEnegy");
+HistFamily hPCZ_RefN = fh.Book("PCZ_Ref%i",NPCWires);
+HistFamily hPCZ_vs_ZN = fh.Book("PCZ_vs_Z%i",NPCWires);
+HistFamily hPCZ_vs_ZcN = fh.Book("PCZ_vs_Zc%i",NPCWires);
+HistFamily hPCZ_vs_Zc = fh.Book("PCZ_vs_Zc");
+HistFamily hPCZ_vs_Zc_q3_r1N = fh.Book("PCZ_vs_Zc_q3_r1%i",NPCWires);
+HistFamily hPCZ_vs_Zc_q3_r1 = fh.Book("PCZ_vs_Zc_q3_r1");
+HistFamily hPCZ_vs_Zc_r1_r2N = fh.Book("PCZ_vs_Zc_r1_r2%i",NPCWires);
+HistFamily hPCZ_RefgN = fh.Book("PCZ_Refg%i",NPCWires);
+HistFamily hPCZ_vs_ZgN = fh.Book("PCZ_vs_Zg%i",NPCWires);
+HistFamily hPCZ_vs_ZgcN = fh.Book("PCZ_vs_Zgc%i",NPCWires);
+HistFamily hE_de = fh.Book("E_de");
+HistFamily hE_de_corrected = fh.Book("E_de_corrected");
+HistFamily hInteractionPoint = fh.Book("InteractionPoint");
 ////////////////////////////////////////////////////////////////////////////////////
 bool Track::Tr_Sisort_method(struct TrackEvent a,struct TrackEvent b){
   if(a.SiEnergy > b.SiEnergy)
@@ -120,6 +153,9 @@ bool Track::Tr_PCsort_method(struct TrackEvent c,struct TrackEvent d){
 int main(int argc, char* argv[]) { 
   //Don't know what this does, but libraries won't load without it
   TApplication *myapp=new TApplication("myapp",0,0); 
+  //the entries processed in each file: -first, -last, -every, -random, -stratified, -seed
+  EntrySelection Entries;
+  if (!Entries.ParseArgs(argc,argv)) exit(EXIT_FAILURE);
   
   Int_t numarg=3;
 #ifdef DoCut
@@ -128,6 +164,7 @@ int main(int argc, char* argv[]) {
 #endif
   if (argc!=numarg) {
     cout << "Error: Wrong Number of Arguments\n";
+    cout << "Options: " << EntrySelection::Usage() << ", applied to each file of the list\n";
     exit(EXIT_FAILURE);
   }
 
@@ -148,13 +185,13 @@ int main(int argc, char* argv[]) {
   strcpy( file_cut1, argv[3] );
  
   //He4 cut
-  TFile *cut_file1 = new TFile(file_cut1);
-  if (!cut_file1->IsOpen()){
+  CutRegistry Cuts; //all the cuts of the files, read once (../include/CutRegistry.h)
+  if (!Cuts.LoadFile(file_cut1)){
     cout << "Cut file1: " << file_cut1 << " could not be opened.\n";
     exit(EXIT_FAILURE);
   }
-  TCutG *cut1 = NULL;
-  cut1 = (TCutG*)cut_file1->Get("He4");
+  const FastCut *cut1 = NULL;
+  cut1 = Cuts.Get(file_cut1,"He4");
   
   if (cut1 == NULL){
     cout << "Cut1 does not exist\n";
@@ -231,37 +268,45 @@ int main(int argc, char* argv[]) {
   PC.ReadHit = 0;
   //CsI.ReadHit = 0;
 
+  if(FillIMT) ROOT::EnableImplicitMT();
   TFile *outputfile = new TFile(file_cal,"RECREATE");
   TTree *MainTree = new TTree("MainTree","MainTree");
+  TreeFillThread MainFill(MainTree,FillThread);
  
-  MainTree->Branch("Tr.NTracks",&Tr.NTracks,"NTracks/I");
-  MainTree->Branch("Tr.NTracks1",&Tr.NTracks1,"NTracks1/I");
-  MainTree->Branch("Tr.NTracks2",&Tr.NTracks2,"NTracks2/I");
-  MainTree->Branch("Tr.NTracks3",&Tr.NTracks3,"NTracks3/I");
-  MainTree->Branch("Tr.TrEvent",&Tr.TrEvent);
+  MainTree->Branch("Tr.NTracks",MainFill.Copy(Tr.NTracks),"NTracks/I");
+  MainTree->Branch("Tr.NTracks1",MainFill.Copy(Tr.NTracks1),"NTracks1/I");
+  MainTree->Branch("Tr.NTracks2",MainFill.Copy(Tr.NTracks2),"NTracks2/I");
+  MainTree->Branch("Tr.NTracks3",MainFill.Copy(Tr.NTracks3),"NTracks3/I");
+  MainTree->Branch("Tr.TrEvent",MainFill.Copy(Tr.TrEvent));
 
 #ifdef PCWireCal
   Float_t Ztgt;
-  MainTree->Branch("Ztgt",&Ztgt,"Ztgt/F");
+  MainTree->Branch("Ztgt",MainFill.Copy(Ztgt),"Ztgt/F");
   Int_t spacer;
-  MainTree->Branch("spacer",&spacer,"spacer/I");
+  MainTree->Branch("spacer",MainFill.Copy(spacer),"spacer/I");
 #else
   Int_t Old_RFTime,Old_MCPTime;
   Int_t RFTime, MCPTime;
-  MainTree->Branch("RFTime",&RFTime,"RFTime/I");
-  MainTree->Branch("MCPTime",&MCPTime,"MCPTime/I");
+  MainTree->Branch("RFTime",MainFill.Copy(RFTime),"RFTime/I");
+  MainTree->Branch("MCPTime",MainFill.Copy(MCPTime),"MCPTime/I");
   Float_t Old_TOFTime,Old_TOFcTime,Old_TOFwTime;
   Float_t TOFTime,TOFcTime,TOFwTime;
-  MainTree->Branch("TOFTime",&TOFTime,"TOFTime/F");
-  MainTree->Branch("TOFcTime",&TOFcTime,"TOFcTime/F");
-  MainTree->Branch("TOFwTime",&TOFwTime,"TOFwTime/F");
+  MainTree->Branch("TOFTime",MainFill.Copy(TOFTime),"TOFTime/F");
+  MainTree->Branch("TOFcTime",MainFill.Copy(TOFcTime),"TOFcTime/F");
+  MainTree->Branch("TOFwTime",MainFill.Copy(TOFwTime),"TOFwTime/F");
 #endif
   
+  DefaultTreeOutputConfig().Load(OutputConfig);
+  DefaultTreeOutputConfig().Apply(MainTree);
+
   TObjArray *RootObjects = new TObjArray();
   RootObjects->Add(MainTree);
 
   fhlist = new TList;
+  fh.SetList(fhlist);
   RootObjects->Add(fhlist);  
+  //the histograms made in the loop stay out of the output file, which the fill thread writes to; written with fhlist
+  if (FillThread) TH1::AddDirectory(kFALSE);
   ////////////////////////////////////////////////////  
   Int_t count_2A_1P=0, count_2A=0, count_1A_1P=0;
   Int_t count_1track=0, count_2tracks=0, count_3tracks =0,count_morethan3tracks=0;
@@ -285,6 +330,8 @@ int main(int argc, char* argv[]) {
   string rootfile;
   char rootfile_char[100];
   Int_t nfiles=0;
+  TreeInput::SetAsyncPrefetch(AsyncPrefetch);
+  TreeReadStats read_stats;
 
   while (getline(inFileList,rootfile)) {//!inFileList.eof()) {//===================loop over all of the incoming root files================
       //getline(inFileList,rootfile);
@@ -347,27 +394,22 @@ int main(int argc, char* argv[]) {
 #endif 
     
     TTree *raw_tree = (TTree*) inputFile->Get("MainTree");
-    raw_tree->SetBranchAddress("Si.NSiHits",&Si.NSiHits);
-    raw_tree->SetBranchAddress("Si.Detector",&Si.ReadDet);
-    raw_tree->SetBranchAddress("Si.Hit",&Si.ReadHit);
-    raw_tree->SetBranchAddress("PC.NPCHits",&PC.NPCHits);
-    raw_tree->SetBranchAddress("PC.Hit",&PC.ReadHit);
+    //only the branches bound here are read (../include/TreeInput.h)
+    TreeInput input(raw_tree,InputCache);
+    //Si and PC hits, from a nested or flat MainTree (../include/FlatMainTree.h); Si.Detector is not used
+    MainTreeReader reader(input,Si,PC,kFALSE);
 #ifndef PCWireCal
-    raw_tree->SetBranchAddress("RFTime",&Old_RFTime);
-    raw_tree->SetBranchAddress("MCPTime",&Old_MCPTime);
-    raw_tree->SetBranchAddress("TOFTime",&Old_TOFTime);
-    raw_tree->SetBranchAddress("TOFcTime",&Old_TOFcTime);
-    raw_tree->SetBranchAddress("TOFwTime",&Old_TOFwTime);
+    input.Read("RFTime",&Old_RFTime);
+    input.Read("MCPTime",&Old_MCPTime);
+    input.Read("TOFTime",&Old_TOFTime);
+    input.Read("TOFcTime",&Old_TOFcTime);
+    input.Read("TOFwTime",&Old_TOFwTime);
 #endif
     
-    Long64_t nentries = raw_tree->GetEntries();
-    cout<<" nentries = "<<nentries<<endl;
-#ifdef MaxEntries
-    if(nentries>MaxEntries) {
-      cout << " Max entries exceeded! Truncating data set from " << nentries << " to " << MaxEntries << endl;
-      nentries=MaxEntries;
-    }
-#endif
+    cout<<" nentries = "<<raw_tree->GetEntries()<<endl;
+    Long64_t nentries = Entries.Select(raw_tree->GetEntries()); //entries selected
+    Entries.Print();
+    Entries.Apply(input);
     
     Int_t status;
     Float_t print_step=0.1;
@@ -380,11 +422,11 @@ int main(int argc, char* argv[]) {
 	break;
       }
 #endif
-      status = raw_tree->GetEvent(i);
-      if(i%TMath::Nint(nentries*print_step)==0) cout << endl << "  Done: "
+      status = reader.GetEntry(Entries.GetEntry(i));
+      if(i%TMath::Max(TMath::Nint(nentries*print_step),1)==0) cout << endl << "  Done: "
 					       << right << fixed << setw(3)
 					       << TMath::Nint(i*100./nentries) << "%" << std::flush;
-      if(i%TMath::Nint(nentries*print_step/((nentries>1e6)?100:10))==0) cout << "." << std::flush;
+      if(i%TMath::Max(TMath::Nint(nentries*print_step/((nentries>1e6)?100:10)),1)==0) cout << "." << std::flush;
       ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 #ifndef PCWireCal
@@ -405,12 +447,12 @@ int main(int argc, char* argv[]) {
 	TOFc=MCPTime-slope*RFTime;//corrected TOF
 	TOFw=fmod(TOFc+4*offset,offset);//wrapped TOF
 
-	MyFill("Time_MCP_vs_RF",512,0,4096,RFTime,512,0,4096,MCPTime);
-	MyFill("TOF_vs_RF",512,0,4096,RFTime,512,-4096,4096,TOF);
-	MyFill("TOFc_vs_RF",512,0,4096,RFTime,512,-4096,4096,TOFc);      
-	MyFill("TOFc",tbins*2,-4096,4096,TOFc);
-	MyFill("TOFw",tbins,0,300,TOFw);
-	MyFill("TOFw2",tbins,0,600,fmod(TOFc+4*offset,wrap));//wrapped TOF
+	fh.Fill(hTime_MCP_vs_RF(),512,0,4096,RFTime,512,0,4096,MCPTime);
+	fh.Fill(hTOF_vs_RF(),512,0,4096,RFTime,512,-4096,4096,TOF);
+	fh.Fill(hTOFc_vs_RF(),512,0,4096,RFTime,512,-4096,4096,TOFc);      
+	fh.Fill(hTOFc(),tbins*2,-4096,4096,TOFc);
+	fh.Fill(hTOFw(),tbins,0,300,TOFw);
+	fh.Fill(hTOFw2(),tbins,0,600,fmod(TOFc+4*offset,wrap));//wrapped TOF
 	          
 #ifdef MCP_RF_Cut
 	Double_t mcpcenter=3063;
@@ -420,12 +462,12 @@ int main(int argc, char* argv[]) {
 	mcpmin=2650;
 	mcpmax=3210;
 	if(MCPTime>mcpmin && MCPTime<mcpmax && TOFw>117 && TOFw<215) {//inside gate; keep
-	  MyFill("MCP_in",tbins,0,300,MCPTime);
-	  MyFill("TOFw_in",tbins,0,300,TOFw);
+	  fh.Fill(hMCP_in(),tbins,0,300,MCPTime);
+	  fh.Fill(hTOFw_in(),tbins,0,300,TOFw);
 	}
 	else {//outside gate; exclude
-	  MyFill("MCP_out",tbins,0,300,MCPTime);
-	  MyFill("TOFw_out",tbins,0,300,TOFw);
+	  fh.Fill(hMCP_out(),tbins,0,300,MCPTime);
+	  fh.Fill(hTOFw_out(),tbins,0,300,TOFw);
 	  continue;
 	}
       }
@@ -440,7 +482,7 @@ int main(int argc, char* argv[]) {
       /////////////////////////////////////////////////////////////////////////////////////////////////////    
       //
       //cout<<"Si.ReadHit->size() = "<<Si.ReadHit->size()<<endl;  
-      MyFill("Si_ReadHit_size",500,0,50,Si.ReadHit->size());  
+      fh.Fill(hSi_ReadHit_size(),500,0,50,Si.ReadHit->size());  
 
       for (Int_t j=0; j<Si.ReadHit->size(); j++) {//loop over all silicon
 	
@@ -524,7 +566,7 @@ int main(int argc, char* argv[]) {
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////    
 
       //cout<<"PC.ReadHit->size() = "<<PC.ReadHit->size()<<endl;
-      MyFill("PC_ReadHit_size",500,0,50,PC.ReadHit->size());  
+      fh.Fill(hPC_ReadHit_size(),500,0,50,PC.ReadHit->size());  
 
       for (Int_t l=0; l<PC.ReadHit->size(); l++ ){//loop over pc
 	
@@ -568,12 +610,12 @@ int main(int argc, char* argv[]) {
 	  continue;
 #endif
 	//All PCWire vs Energy
-	MyFill("WireID_vs_PCEnegy",25,0,24,Tr.TrEvent[pc].WireID,500,0,2,Tr.TrEvent[pc].PCEnergy);
+	fh.Fill(hWireID_vs_PCEnegy(),25,0,24,Tr.TrEvent[pc].WireID,500,0,2,Tr.TrEvent[pc].PCEnergy);
 	
 	for(Int_t pca=0; pca<Tr.NTracks1; pca++) {
 	  
 	  //PCWire with track in channel 12 & other tracks & non-tracks in other channels
-	  MyFill("WireID_mod1_vs_PCEnegy",
+	  fh.Fill(hWireID_mod1_vs_PCEnegy(),
 		 25,0,24,(((Int_t)Tr.TrEvent[pc].WireID-(Int_t)Tr.TrEvent[pca].WireID +12)%24),
 		 500,0,2,Tr.TrEvent[pc].PCEnergy);
 	}
@@ -692,32 +734,32 @@ int main(int argc, char* argv[]) {
 	Float_t zmin=-1;
 	Float_t zmax=30;
 	
-	MyFill(Form("PCZ_Ref%i",Tr.TrEvent[s].WireID),pcbins,1,30,Tr.TrEvent[s].PCZ_Ref);
+	fh.Fill(hPCZ_RefN(Tr.TrEvent[s].WireID),pcbins,1,30,Tr.TrEvent[s].PCZ_Ref);
 	// before PCWIRECAL applied
-	MyFill(Form("PCZ_vs_Z%i",Tr.TrEvent[s].WireID),
+	fh.Fill(hPCZ_vs_ZN(Tr.TrEvent[s].WireID),
 	       pcbins,-1.5,1.5,Tr.TrEvent[s].PCZraw,
 	       pcbins,1.0,zmax,Tr.TrEvent[s].PCZ_Ref); 
 
 	// after PCWIRECAL applied
-	MyFill(Form("PCZ_vs_Zc%i",Tr.TrEvent[s].WireID),
+	fh.Fill(hPCZ_vs_ZcN(Tr.TrEvent[s].WireID),
 	       pcbins,zmin,zmax,Tr.TrEvent[s].PCZ,
 	       pcbins,zmin,zmax,Tr.TrEvent[s].PCZ_Ref); 
 
-	MyFill("PCZ_vs_Zc",
+	fh.Fill(hPCZ_vs_Zc(),
 	       pcbins,zmin,zmax,Tr.TrEvent[s].PCZ,
 	       pcbins,zmin,zmax,Tr.TrEvent[s].PCZ_Ref);
 	
 	if(Tr.TrEvent[s].DetID<16 && Tr.TrEvent[s].DetID>-1) {
-	  MyFill(Form("PCZ_vs_Zc_q3_r1%i",Tr.TrEvent[s].WireID),
+	  fh.Fill(hPCZ_vs_Zc_q3_r1N(Tr.TrEvent[s].WireID),
 		 pcbins,zmin,zmax,Tr.TrEvent[s].PCZ,
 		 pcbins,zmin,zmax,Tr.TrEvent[s].PCZ_Ref);
-	  MyFill("PCZ_vs_Zc_q3_r1",
+	  fh.Fill(hPCZ_vs_Zc_q3_r1(),
 		 pcbins,zmin,zmax,Tr.TrEvent[s].PCZ,
 		 pcbins,zmin,zmax,Tr.TrEvent[s].PCZ_Ref);
 	}
 
 	if(Tr.TrEvent[s].DetID<28 && Tr.TrEvent[s].DetID>3) {
-	  MyFill(Form("PCZ_vs_Zc_r1_r2%i",Tr.TrEvent[s].WireID),
+	  fh.Fill(hPCZ_vs_Zc_r1_r2N(Tr.TrEvent[s].WireID),
 		 pcbins,zmin,zmax,Tr.TrEvent[s].PCZ,
 		 pcbins,zmin,zmax,Tr.TrEvent[s].PCZ_Ref);
 	}
@@ -738,12 +780,12 @@ int main(int argc, char* argv[]) {
 	  }
 #endif
 	  
-	  MyFill(Form("PCZ_Refg%i",Tr.TrEvent[s].WireID),
+	  fh.Fill(hPCZ_RefgN(Tr.TrEvent[s].WireID),
 		 pcbins,1.0,zmax,Tr.TrEvent[s].PCZ_Ref);
-	  MyFill(Form("PCZ_vs_Zg%i",Tr.TrEvent[s].WireID),
+	  fh.Fill(hPCZ_vs_ZgN(Tr.TrEvent[s].WireID),
 		 pcbins,-1.5,1.5,Tr.TrEvent[s].PCZraw,
 		 pcbins,1.0,zmax,Tr.TrEvent[s].PCZ_Ref);
-	  MyFill(Form("PCZ_vs_Zgc%i",Tr.TrEvent[s].WireID),
+	  fh.Fill(hPCZ_vs_ZgcN(Tr.TrEvent[s].WireID),
 		 pcbins,zmin,zmax,Tr.TrEvent[s].PCZ,
 		 pcbins,zmin,zmax,Tr.TrEvent[s].PCZ_Ref); // after PCWIRECAL applied
 	  /////////////////////////////////////////////////////////////////	 
@@ -758,15 +800,15 @@ int main(int argc, char* argv[]) {
       Float_t demax=0.25;
       Int_t debins=600;
       for(Int_t q=0; q<Tr.NTracks1;q++) {
-	MyFill("E_de",
+	fh.Fill(hE_de(),
 	       debins,-1,29,Tr.TrEvent[q].SiEnergy,
 	       debins,demin,demax,Tr.TrEvent[q].PCEnergy);
 	//MyFill("E_de_corrected",debins,-1,35,Tr.TrEvent[q].SiEnergy,debins,demin,demax,Tr.TrEvent[q].PCEnergy*Tr.TrEvent[q].PathLength);
-	MyFill("E_de_corrected",
+	fh.Fill(hE_de_corrected(),
 	       debins,-1,29,Tr.TrEvent[q].SiEnergy,debins,
 	       demin,demax,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));	  
 	///MyFill(Form("PCZ%i",PC.WireID[GoodPC]),300,-10,50,Tr.TrEvent[q].PCZ);	    
-	MyFill("InteractionPoint",300,-10,50,Tr.TrEvent[q].IntPoint);	
+	fh.Fill(hInteractionPoint(),300,-10,50,Tr.TrEvent[q].IntPoint);	
       }
 #endif
 
@@ -780,10 +822,13 @@ int main(int argc, char* argv[]) {
 #ifdef MaxWire
 	if (count_max_wire<=NMaxWire)
 #endif
-	  MainTree->Fill();
+	  MainFill.Fill();
 #endif
     }//end of event loop
+    read_stats += input.GetStats();
   }//end of file loop
+  MainFill.Finish();
+  read_stats.Print("Input MainTree");
   outputfile->cd();
   RootObjects->Write(); 
   outputfile->Close();
@@ -875,33 +920,3 @@ Int_t FindMaxPC(Double_t phi, PCHit& PC){
 /////////////////////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////////////////////
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX){
-  try{
-    fhmap.at(name)->Fill(valueX);
-  } catch(out_of_range e) {
-    TH1F* newHist = new TH1F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX);
-    newHist->Fill(valueX);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }
-}
-////=================================================================================
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY){
-
-  try{
-    //cout << name << endl;
-    fhmap.at(name)->Fill(valueX,valueY);
-  } catch(std::out_of_range e) {
-    TH2F* newHist = new TH2F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX,
-			     binsY,lowY,highY);
-    newHist->Fill(valueX,valueY);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }  
-}
-/////////////////////////////////////////////////////////////////////////////////////
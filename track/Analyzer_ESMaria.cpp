@@ -17,6 +17,11 @@
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #define FillTree
+#define FillThread (Bool_t) kTRUE //fill MainTree on a background thread (../include/TreeFillThread.h)
+#define FillIMT (Bool_t) kFALSE   //compress the baskets in parallel (ROOT implicit multi-threading)
+#define OutputConfig "../include/tree_output.dat" //compression, basket sizes and auto-flush (../include/TreeOutputConfig.h)
+#define InputCache (Long64_t) 30000000 //bytes of TTreeCache for the branches read from the input MainTree (../include/TreeInput.h)
+#define AsyncPrefetch (Bool_t) kFALSE  //read the next cache blocks on a ROOT thread, for input files on a network file system
 #define FillEdE_cor
 #define CheckBasic
 
@@ -105,19 +110,45 @@
 #include <TVector3.h>
 
 #include "tree_structure.h"
+#include "../include/FlatMainTree.h"
+#include "../include/TreeInput.h"
+#include "../include/EntrySelection.h"
 #include "LookUp.h"
+#include "../include/TreeFillThread.h"
+#include "../include/TreeOutputConfig.h"
+#include "../include/HistRegistry.h"
+#include "../include/CutRegistry.h"
 
 using namespace std;
 ////////////////////////////////////////////////////////////////////////////////////
 Int_t FindMaxPC(Double_t phi, PCHit& PC);
 
-void MyFill(string name,int binsX, double lowX, double highX, double valueX);
-
-void MyFill(string name,int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY);
-
 TList* fhlist;
-std::map<string,TH1*> fhmap;
+HistRegistry fh; //histograms of fhlist, filled through the handles below (../include/HistRegistry.h)
+HistFamily hMCP_RF_Wrapped = fh.Book("MCP_RF_Wrapped");
+HistFamily hSi_ReadHit_size = fh.Book("Si_ReadHit_size");
+HistFamily hPC_ReadHit_size = fh.Book("PC_ReadHit_size");
+HistFamily h4He_E_si = fh.Book("4He_E_si");
+HistFamily h4He_E_si_vs_Theta = fh.Book("4He_E_si_vs_Theta");
+HistFamily h4He_E_si_vs_IntPoint = fh.Book("4He_E_si_vs_IntPoint");
+HistFamily h4He_E_si_Q3 = fh.Book("4He_E_si_Q3");
+HistFamily h4He_E_si_vs_Theta_Q3 = fh.Book("4He_E_si_vs_Theta_Q3");
+HistFamily h4He_E_si_vs_IntPoint_Q3 = fh.Book("4He_E_si_vs_IntPoint_Q3");
+HistFamily h4He_E_si_SX3_1 = fh.Book("4He_E_si_SX3_1");
+HistFamily h4He_E_si_vs_Theta_SX3_1 = fh.Book("4He_E_si_vs_Theta_SX3_1");
+HistFamily h4He_E_si_vs_IntPoint_SX3_1 = fh.Book("4He_E_si_vs_IntPoint_SX3_1");
+HistFamily h4He_E_si_SX3_2 = fh.Book("4He_E_si_SX3_2");
+HistFamily h4He_E_si_vs_Theta_SX3_2 = fh.Book("4He_E_si_vs_Theta_SX3_2");
+HistFamily h4He_E_si_vs_IntPoint_SX3_2 = fh.Book("4He_E_si_vs_IntPoint_SX3_2");
+HistFamily h4He_E_rxn = fh.Book("4He_E_rxn");
+HistFamily h16O_4He_Energy = fh.Book("16O_4He_Energy");
+HistFamily h16O_4He_Energy_VS_BeamEnergy = fh.Book("16O_4He_Energy_VS_BeamEnergy");
+HistFamily h16O_4He_Energy_Q3 = fh.Book("16O_4He_Energy_Q3");
+HistFamily h16O_4He_Energy_VS_BeamEnergy_Q3 = fh.Book("16O_4He_Energy_VS_BeamEnergy_Q3");
+HistFamily h16O_4He_Energy_SX3_1 = fh.Book("16O_4He_Energy_SX3_1");
+HistFamily h16O_4He_Energy_VS_BeamEnergy_SX3_1 = fh.Book("16O_4He_Energy_VS_BeamEnergy_SX3_1");
+HistFamily h16O_4He_Energy_SX3_2 = fh.Book("16O_4He_Energy_SX3_2");
+HistFamily h16O_4He_Energy_VS_BeamEnergy_SX3_2 = fh.Book("16O_4He_Energy_VS_BeamEnergy_SX3_2");
 ////////////////////////////////////////////////////////////////////////////////////
 bool Track::Tr_Sisort_method(struct TrackEvent a,struct TrackEvent b){
   if(a.SiEnergy > b.SiEnergy)
@@ -135,9 +166,13 @@ int main(int argc, char* argv[]) {
 
   //Don't know what this does, but libraries won't load without it
   TApplication *myapp=new TApplication("myapp",0,0); 
+  //the entries processed in each file: -first, -last, -every, -random, -stratified, -seed
+  EntrySelection Entries;
+  if (!Entries.ParseArgs(argc,argv)) exit(EXIT_FAILURE);
 
   if (argc!=4) {
     cout << "Error: Wrong Number of Arguments\n";
+    cout << "Options: " << EntrySelection::Usage() << ", applied to each file of the list\n";
     exit(EXIT_FAILURE);
   }
 
@@ -154,13 +189,13 @@ int main(int argc, char* argv[]) {
  
 
   //D2 cut
-  TFile *cut_file1 = new TFile(file_cut1);
-  if (!cut_file1->IsOpen()){
+  CutRegistry Cuts; //all the cuts of the files, read once (../include/CutRegistry.h)
+  if (!Cuts.LoadFile(file_cut1)){
     cout << "Cut file1: " << file_cut1 << " could not be opened.\n";
     exit(EXIT_FAILURE);
   }
-  TCutG *cut1 = NULL;
-  cut1 = (TCutG*)cut_file1->Get("D2");
+  const FastCut *cut1 = NULL;
+  cut1 = Cuts.Get(file_cut1,"D2");
   
   if (cut1 == NULL){
     cout << "Cut1 does not exist\n";
@@ -192,19 +227,27 @@ int main(int argc, char* argv[]) {
 
   ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+  if(FillIMT) ROOT::EnableImplicitMT();
   TFile *outputfile = new TFile(file_cal,"RECREATE");
   TTree *MainTree = new TTree("MainTree","MainTree");
+  TreeFillThread MainFill(MainTree,FillThread);
   //++
-  MainTree->Branch("Tr.NTracks",&Tr.NTracks,"NTracks/I");
-  MainTree->Branch("Tr.NTracks1",&Tr.NTracks1,"NTracks1/I");
-  MainTree->Branch("Tr.NTracks2",&Tr.NTracks2,"NTracks2/I");
-  MainTree->Branch("Tr.NTracks3",&Tr.NTracks3,"NTracks3/I");
-  MainTree->Branch("Tr.TrEvent",&Tr.TrEvent);   
+  MainTree->Branch("Tr.NTracks",MainFill.Copy(Tr.NTracks),"NTracks/I");
+  MainTree->Branch("Tr.NTracks1",MainFill.Copy(Tr.NTracks1),"NTracks1/I");
+  MainTree->Branch("Tr.NTracks2",MainFill.Copy(Tr.NTracks2),"NTracks2/I");
+  MainTree->Branch("Tr.NTracks3",MainFill.Copy(Tr.NTracks3),"NTracks3/I");
+  MainTree->Branch("Tr.TrEvent",MainFill.Copy(Tr.TrEvent));   
   
+  DefaultTreeOutputConfig().Load(OutputConfig);
+  DefaultTreeOutputConfig().Apply(MainTree);
+
   RootObjects->Add(MainTree);
 
   fhlist = new TList;
+  fh.SetList(fhlist);
   RootObjects->Add(fhlist);  
+  //the histograms made in the loop stay out of the output file, which the fill thread writes to; written with fhlist
+  if (FillThread) TH1::AddDirectory(kFALSE);
   ////////////////////////////////////////////////////  
   Int_t count_2A_1P=0, count_2A=0, count_1A_1P=0;
   Int_t count_1track=0, count_2tracks=0, count_3tracks =0,count_morethan3tracks=0;
@@ -222,6 +265,8 @@ int main(int argc, char* argv[]) {
   
   string rootfile;
   char rootfile_char[100];
+  TreeInput::SetAsyncPrefetch(AsyncPrefetch);
+  TreeReadStats read_stats;
 
   while (!inFileList.eof()){//===================loop over all of the incoming root files================
     getline(inFileList,rootfile);
@@ -238,22 +283,23 @@ int main(int argc, char* argv[]) {
     cout << "Processing File: " << rootfile << endl;   
 
     TTree *raw_tree = (TTree*) inputFile->Get("MainTree");
-    raw_tree->SetBranchAddress("Si.NSiHits",&Si.NSiHits);
-    raw_tree->SetBranchAddress("Si.Detector",&Si.ReadDet);
-    raw_tree->SetBranchAddress("Si.Hit",&Si.ReadHit);
-    raw_tree->SetBranchAddress("PC.NPCHits",&PC.NPCHits);
-    raw_tree->SetBranchAddress("PC.Hit",&PC.ReadHit);
-    raw_tree->SetBranchAddress("RFTime",&RFTime);
-    raw_tree->SetBranchAddress("MCPTime",&MCPTime);
+    //only the branches bound here are read (../include/TreeInput.h)
+    TreeInput input(raw_tree,InputCache);
+    //Si and PC hits, from a nested or flat MainTree (../include/FlatMainTree.h); Si.Detector is not used
+    MainTreeReader reader(input,Si,PC,kFALSE);
+    input.Read("RFTime",&RFTime);
+    input.Read("MCPTime",&MCPTime);
  
-    Long64_t nentries = raw_tree->GetEntries();
-    cout<<"nentries = "<<nentries<<endl;
+    cout<<"nentries = "<<raw_tree->GetEntries()<<endl;
+    Long64_t nentries = Entries.Select(raw_tree->GetEntries()); //entries selected
+    Entries.Print();
+    Entries.Apply(input);
 
     Int_t status;
     for (Long64_t i=0; i<nentries; i++){//====================loop over all events=================
       //cout<<" i =  "<<i<<endl;
 
-      status = raw_tree->GetEvent(i);
+      status = reader.GetEntry(Entries.GetEntry(i));
 
       if (i == TMath::Nint(0.01*nentries))  cout << " 1% through the data" << endl;
       if (i == TMath::Nint(0.10*nentries))  cout << " 10% through the data" << endl;
@@ -270,7 +316,7 @@ int main(int argc, char* argv[]) {
 #ifdef MCP_RF_Cut    
       if(MCPTime > 0 && RFTime>0){
 	//cout<<"   RFTime  == "<<RFTime<<"   MCPTime  =="<<MCPTime<<endl;
-	MyFill("MCP_RF_Wrapped",400,-600,600,(MCPTime-RFTime)%538);
+	fh.Fill(hMCP_RF_Wrapped(),400,-600,600,(MCPTime-RFTime)%538);
 
 	if( (((MCPTime - RFTime)% 538)<47) || (((MCPTime - RFTime)% 538)>118  && ((MCPTime - RFTime)% 538)<320) || ((MCPTime - RFTime)% 538)>384 ){
 	  //if( (((MCPTime - RFTime)% 538)<60) || (((MCPTime - RFTime)% 538)>110  && ((MCPTime - RFTime)% 538)<325) || ((MCPTime - RFTime)% 538)>380 ){
@@ -287,7 +333,7 @@ int main(int argc, char* argv[]) {
       /////////////////////////////////////////////////////////////////////////////////////////////////////    
       //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++  
       //cout<<"Si.ReadHit->size() = "<<Si.ReadHit->size()<<endl;  
-      MyFill("Si_ReadHit_size",500,0,50,Si.ReadHit->size());  
+      fh.Fill(hSi_ReadHit_size(),500,0,50,Si.ReadHit->size());  
 
       for (Int_t j=0; j<Si.ReadHit->size(); j++) {//loop over all silicon
 	
@@ -365,7 +411,7 @@ int main(int argc, char* argv[]) {
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////    
       //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
       //cout<<"PC.ReadHit->size() = "<<PC.ReadHit->size()<<endl;
-      MyFill("PC_ReadHit_size",500,0,50,PC.ReadHit->size());  
+      fh.Fill(hPC_ReadHit_size(),500,0,50,PC.ReadHit->size());  
 
       for (Int_t l=0; l<PC.ReadHit->size(); l++ ){//loop over pc
 	
@@ -480,27 +526,27 @@ int main(int argc, char* argv[]) {
 	 
 	if (cut1->IsInside(Tr.TrEvent[c].SiEnergy,Tr.TrEvent[c].PCEnergy*sin(Tr.TrEvent[c].Theta))){
 
-	  MyFill("4He_E_si",500,0,20,Tr.TrEvent[c].SiEnergy);
-	  MyFill("4He_E_si_vs_Theta",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,15,Tr.TrEvent[c].SiEnergy);
-	  MyFill("4He_E_si_vs_IntPoint",500,0,100,Tr.TrEvent[c].IntPoint,500,0,15,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(h4He_E_si(),500,0,20,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(h4He_E_si_vs_Theta(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,15,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(h4He_E_si_vs_IntPoint(),500,0,100,Tr.TrEvent[c].IntPoint,500,0,15,Tr.TrEvent[c].SiEnergy);
 
 	  if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1){
-	    MyFill("4He_E_si_Q3",500,0,20,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_Theta_Q3",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,15,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_IntPoint_Q3",500,0,100,Tr.TrEvent[c].IntPoint,500,0,15,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_Q3(),500,0,20,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_Theta_Q3(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,15,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_IntPoint_Q3(),500,0,100,Tr.TrEvent[c].IntPoint,500,0,15,Tr.TrEvent[c].SiEnergy);
 	  }else if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3){
-	    MyFill("4He_E_si_SX3_1",500,0,20,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_Theta_SX3_1",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,15,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_IntPoint_SX3_1",500,0,100,Tr.TrEvent[c].IntPoint,500,0,15,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_SX3_1(),500,0,20,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_Theta_SX3_1(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,15,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_IntPoint_SX3_1(),500,0,100,Tr.TrEvent[c].IntPoint,500,0,15,Tr.TrEvent[c].SiEnergy);
 	  }else if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15){
-	    MyFill("4He_E_si_SX3_2",500,0,20,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_Theta_SX3_2",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,15,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_IntPoint_SX3_2",500,0,100,Tr.TrEvent[c].IntPoint,500,0,15,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_SX3_2(),500,0,20,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_Theta_SX3_2(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,15,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_IntPoint_SX3_2(),500,0,100,Tr.TrEvent[c].IntPoint,500,0,15,Tr.TrEvent[c].SiEnergy);
 	  }
 
 	  if(Tr.TrEvent[c].SiEnergy>0.0 && Tr.TrEvent[c].SiEnergy<20.0 && Tr.TrEvent[c].PathLength>0.0 && Tr.TrEvent[c].PathLength< 100.0){
 	    E_4He_rxn = E_Loss_deuteron->GetLookupEnergy(Tr.TrEvent[c].SiEnergy,(-Tr.TrEvent[c].PathLength));
-	    MyFill("4He_E_rxn",500,0,20,E_deut_rxn);
+	    fh.Fill(h4He_E_rxn(),500,0,20,E_deut_rxn);
 
 
 	    //Be-7 Energy Calculation from the Elastic scattering:
@@ -508,31 +554,34 @@ int main(int argc, char* argv[]) {
 	    //Be-7 Theta Calculation from the Elastic scattering:
 	    Theta_16O_4He = asin((sin(Tr.TrEvent[c].Theta)*sqrt(M_D2/M_Be7))/sqrt((Energy_16O_4He/E_4He_rxn)-1));
 
-	    MyFill("16O_4He_Energy",1000,0,25,Energy_16O_4He);
-	    MyFill("16O_4He_Energy_VS_BeamEnergy",1000,0,25,Energy_16O_4He,1000,0,25,Tr.TrEvent[c].BeamEnergy);
+	    fh.Fill(h16O_4He_Energy(),1000,0,25,Energy_16O_4He);
+	    fh.Fill(h16O_4He_Energy_VS_BeamEnergy(),1000,0,25,Energy_16O_4He,1000,0,25,Tr.TrEvent[c].BeamEnergy);
   
 	    if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1){
-	      MyFill("16O_4He_Energy_Q3",1000,0,25,Energy_16O_4He);
-	      MyFill("16O_4He_Energy_VS_BeamEnergy_Q3",1000,0,25,Energy_16O_4He,1000,0,25,Tr.TrEvent[c].BeamEnergy);	     
+	      fh.Fill(h16O_4He_Energy_Q3(),1000,0,25,Energy_16O_4He);
+	      fh.Fill(h16O_4He_Energy_VS_BeamEnergy_Q3(),1000,0,25,Energy_16O_4He,1000,0,25,Tr.TrEvent[c].BeamEnergy);	     
 	    }else if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3){
-	      MyFill("16O_4He_Energy_SX3_1",1000,0,25,Energy_16O_4He);
-	      MyFill("16O_4He_Energy_VS_BeamEnergy_SX3_1",1000,0,25,Energy_16O_4He,1000,0,25,Tr.TrEvent[c].BeamEnergy);	     
+	      fh.Fill(h16O_4He_Energy_SX3_1(),1000,0,25,Energy_16O_4He);
+	      fh.Fill(h16O_4He_Energy_VS_BeamEnergy_SX3_1(),1000,0,25,Energy_16O_4He,1000,0,25,Tr.TrEvent[c].BeamEnergy);	     
 	    }else if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15){
-	      MyFill("16O_4He_Energy_SX3_2",1000,0,25,Energy_16O_4He);
-	      MyFill("16O_4He_Energy_VS_BeamEnergy_SX3_2",1000,0,25,Energy_16O_4He,1000,0,25,Tr.TrEvent[c].BeamEnergy);	     
+	      fh.Fill(h16O_4He_Energy_SX3_2(),1000,0,25,Energy_16O_4He);
+	      fh.Fill(h16O_4He_Energy_VS_BeamEnergy_SX3_2(),1000,0,25,Energy_16O_4He,1000,0,25,Tr.TrEvent[c].BeamEnergy);	     
 	    }
 	  }
 	}
       }
       //////////////////////////////////////////////////////////////////////////////////////////// 
 #ifdef FillTree
-      MainTree->Fill();
+      MainFill.Fill();
 #endif
       //////////////////////////////////////////////////////////////////////////////
     }
+    read_stats += input.GetStats();
     ////////////////////////////////////////////////////////////////////////////////   
   }
   //////////////////////////////////////////////////////////////////////////////////
+  MainFill.Finish();
+  read_stats.Print("Input MainTree");
   outputfile->cd();
   RootObjects->Write(); 
   cout << "RootObjects are Written" << endl;
@@ -626,33 +675,3 @@ Int_t FindMaxPC(Double_t phi, PCHit& PC){
 /////////////////////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////////////////////
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX){
-  try{
-    fhmap.at(name)->Fill(valueX);
-  } catch(out_of_range e) {
-    TH1F* newHist = new TH1F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX);
-    newHist->Fill(valueX);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }
-}
-////=================================================================================
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY){
-
-  try{
-    //cout << name << endl;
-    fhmap.at(name)->Fill(valueX,valueY);
-  } catch(std::out_of_range e) {
-    TH2F* newHist = new TH2F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX,
-			     binsY,lowY,highY);
-    newHist->Fill(valueX,valueY);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }  
-}
-/////////////////////////////////////////////////////////////////////////////////////
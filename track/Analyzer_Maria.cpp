@@ -17,6 +17,11 @@
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #define FillTree
+#define FillThread (Bool_t) kTRUE //fill MainTree on a background thread (../include/TreeFillThread.h)
+#define FillIMT (Bool_t) kFALSE   //compress the baskets in parallel (ROOT implicit multi-threading)
+#define OutputConfig "../include/tree_output.dat" //compression, basket sizes and auto-flush (../include/TreeOutputConfig.h)
+#define InputCache (Long64_t) 30000000 //bytes of TTreeCache for the branches read from the input MainTree (../include/TreeInput.h)
+#define AsyncPrefetch (Bool_t) kFALSE  //read the next cache blocks on a ROOT thread, for input files on a network file system
 #define FillEdE_cor
 #define CheckBasic
 //#define DoCut
@@ -94,7 +99,14 @@
 #include <TVector3.h>
 
 #include "../include/tree_structure.h"
+#include "../include/FlatMainTree.h"
+#include "../include/TreeInput.h"
+#include "../include/EntrySelection.h"
 #include "LookUp.h"
+#include "../include/TreeFillThread.h"
+#include "../include/TreeOutputConfig.h"
+#include "../include/HistRegistry.h"
+#include "../include/CutRegistry.h"
 #include "/home/manasta/Desktop/parker_codes/Include/ReconstructMaria.h" // so that the Reconstruction process is in separate script
 //#include "/home/maria/rayMountPoint/Desktop/parker_codes/Include/ReconstructMaria.h"
 //#include "/home/manasta/Desktop/parker_codes/Include/EnergyLoss.h" // used to be the method to use
@@ -103,13 +115,123 @@ using namespace std;
 ////////////////////////////////////////////////////////////////////////////////////
 Int_t FindMaxPC(Double_t phi, PCHit& PC);
 
-void MyFill(string name,int binsX, double lowX, double highX, double valueX);
-
-void MyFill(string name,int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY);
-
 TList* fhlist;
-std::map<string,TH1*> fhmap;
+HistRegistry fh; //histograms of fhlist, filled through the handles below (../include/HistRegistry.h)
+HistFamily hTiming = fh.Book("Timing");
+HistFamily hSi_ReadHit_size = fh.Book("Si_ReadHit_size");
+HistFamily hPC_ReadHit_size = fh.Book("PC_ReadHit_size");
+HistFamily hPCEnergyPlus_WireN_WireN = fh.Book("PCEnergyPlus_Wire%i_Wire%i",NPCWires,NPCWires);
+HistFamily hPCEnergyMinus_WireN_WireN = fh.Book("PCEnergyMinus_Wire%i_Wire%i",NPCWires,NPCWires);
+HistFamily hPCEnergy_NTracks3_R2 = fh.Book("PCEnergy_NTracks3_R2");
+HistFamily hPCEnergy_NTracks3_QQQ_R1 = fh.Book("PCEnergy_NTracks3_QQQ_R1");
+HistFamily hWireID_vs_PCEnegy = fh.Book("WireID_vs_PCEnegy");
+HistFamily hWireID_mod1_vs_PCEnegy_12 = fh.Book("WireID_mod1_vs_PCEnegy_12");
+HistFamily hWireID_mod1_vs_PCEnegy_0 = fh.Book("WireID_mod1_vs_PCEnegy_0");
+HistFamily hPCWireID_DetID_N = fh.Book("PCWireID_DetID_%i",28);
+HistFamily hPCWireID_DetID2_N = fh.Book("PCWireID_DetID2_%i",28);
+HistFamily hPCZ_RefN = fh.Book("PCZ_Ref%i",NPCWires);
+HistFamily hSiZ_vs_SiEnergy_WireIDN = fh.Book("SiZ_vs_SiEnergy_WireID%i",NPCWires);
+HistFamily hSiZ_vs_SiEnergy_R1_R2 = fh.Book("SiZ_vs_SiEnergy_R1_R2");
+HistFamily hPCZ_vs_Z_beforeCalN = fh.Book("PCZ_vs_Z_beforeCal%i",NPCWires);
+HistFamily hPCZ_vs_Z_afterCalN = fh.Book("PCZ_vs_Z_afterCal%i",NPCWires);
+HistFamily hPCZ_vs_Z_afterCal_q3_r1N = fh.Book("PCZ_vs_Z_afterCal_q3_r1%i",NPCWires);
+HistFamily hPCZ_vs_Z_afterCal_q3_r1 = fh.Book("PCZ_vs_Z_afterCal_q3_r1");
+HistFamily hPCZ_vs_Z_afterCal_r1_r2N = fh.Book("PCZ_vs_Z_afterCal_r1_r2%i",NPCWires);
+HistFamily hPCZ_vs_Z_afterCal_All = fh.Book("PCZ_vs_Z_afterCal_All");
+HistFamily hPCEnergy_vs_PCZ_beforeCal_WireIDN = fh.Book("PCEnergy_vs_PCZ_beforeCal_WireID%i",NPCWires);
+HistFamily hPCEnergy_vs_PCZ_afterCal_WireIDN = fh.Book("PCEnergy_vs_PCZ_afterCal_WireID%i",NPCWires);
+HistFamily hPCEnergy_vs_PCZ_q3_r1_N = fh.Book("PCEnergy_vs_PCZ_q3_r1_%i",NPCWires);
+HistFamily hPCEnergy_vs_PCZ_q3_r1 = fh.Book("PCEnergy_vs_PCZ_q3_r1");
+HistFamily hPCEnergy_vs_PCZ_All = fh.Book("PCEnergy_vs_PCZ_All");
+HistFamily hPCZoffset_vs_PCEnergy_N = fh.Book("PCZoffset_vs_PCEnergy_%i",NPCWires);
+HistFamily hPCZoffset_vs_PCEnergy_q3_r1_N = fh.Book("PCZoffset_vs_PCEnergy_q3_r1_%i",NPCWires);
+HistFamily hPCZoffset_vs_PCEnergy_q3_r1 = fh.Book("PCZoffset_vs_PCEnergy_q3_r1");
+HistFamily hPCZoffset_vs_PCEnergy_All = fh.Book("PCZoffset_vs_PCEnergy_All");
+HistFamily hPCZoffset_vs_PCZ_beforeCalN = fh.Book("PCZoffset_vs_PCZ_beforeCal%i",NPCWires);
+HistFamily hPCZoffset_vs_PCZ_afterCalN = fh.Book("PCZoffset_vs_PCZ_afterCal%i",NPCWires);
+HistFamily hPCZoffset_vs_PCZ_q3_r1_N = fh.Book("PCZoffset_vs_PCZ_q3_r1_%i",NPCWires);
+HistFamily hPCZoffset_vs_PCZ_q3_r1 = fh.Book("PCZoffset_vs_PCZ_q3_r1");
+HistFamily hPCZoffset_vs_PCZ_All = fh.Book("PCZoffset_vs_PCZ_All");
+HistFamily hPCZoffset_vs_Theta_N = fh.Book("PCZoffset_vs_Theta_%i",NPCWires);
+HistFamily hPCZoffset_vs_Theta_q3_r1_N = fh.Book("PCZoffset_vs_Theta_q3_r1_%i",NPCWires);
+HistFamily hPCZoffset_vs_Theta_q3_r1 = fh.Book("PCZoffset_vs_Theta_q3_r1");
+HistFamily hPCZoffset_vs_Theta_All = fh.Book("PCZoffset_vs_Theta_All");
+HistFamily hPCZoffset_vs_PCPhi = fh.Book("PCZoffset_vs_PCPhi");
+HistFamily hPCZoffset_vs_SiPhi = fh.Book("PCZoffset_vs_SiPhi");
+HistFamily hIntPoint_cut_Q3 = fh.Book("IntPoint_cut_Q3");
+HistFamily hIntPoint_cut_SX3_R1 = fh.Book("IntPoint_cut_SX3_R1");
+HistFamily hIntPoint_cut_SX3_R2 = fh.Book("IntPoint_cut_SX3_R2");
+HistFamily hPCEnergyPlus_cut_WireN_WireN = fh.Book("PCEnergyPlus_cut_Wire%i_Wire%i",NPCWires,NPCWires);
+HistFamily hPCEnergyMinus_cut_WireN_WireN = fh.Book("PCEnergyMinus_cut_Wire%i_Wire%i",NPCWires,NPCWires);
+HistFamily hPCEnergy_vs_PCZ_WireIDN = fh.Book("PCEnergy_vs_PCZ_WireID%i",NPCWires);
+HistFamily hBeamEnergy_vs_IntPoint = fh.Book("BeamEnergy_vs_IntPoint");
+HistFamily hE_de = fh.Book("E_de");
+HistFamily hE_de_corrected_ALL = fh.Book("E_de_corrected_ALL");
+HistFamily hInteractionPoint = fh.Book("InteractionPoint");
+HistFamily hE_si_vs_Theta = fh.Book("E_si_vs_Theta");
+HistFamily hE_de_Q3 = fh.Book("E_de_Q3");
+HistFamily hE_de_corrected_Q3 = fh.Book("E_de_corrected_Q3");
+HistFamily hInteractionPoint_Q3 = fh.Book("InteractionPoint_Q3");
+HistFamily hE_si_vs_Theta_Q3 = fh.Book("E_si_vs_Theta_Q3");
+HistFamily hE_de_SX3_1 = fh.Book("E_de_SX3_1");
+HistFamily hE_de_corrected_SX3_1 = fh.Book("E_de_corrected_SX3_1");
+HistFamily hInteractionPoint_SX3_1 = fh.Book("InteractionPoint_SX3_1");
+HistFamily hE_si_vs_Theta_SX3_1 = fh.Book("E_si_vs_Theta_SX3_1");
+HistFamily hE_de_SX3_2 = fh.Book("E_de_SX3_2");
+HistFamily hE_de_corrected_SX3_2 = fh.Book("E_de_corrected_SX3_2");
+HistFamily hInteractionPoint_SX3_2 = fh.Book("InteractionPoint_SX3_2");
+HistFamily hE_si_vs_Theta_SX3_2 = fh.Book("E_si_vs_Theta_SX3_2");
+HistFamily hTiming_Cut = fh.Book("Timing_Cut");
+HistFamily h4He_E_si = fh.Book("4He_E_si");
+HistFamily h4He_E_si_vs_Theta = fh.Book("4He_E_si_vs_Theta");
+HistFamily h4He_E_si_vs_IntPoint = fh.Book("4He_E_si_vs_IntPoint");
+HistFamily h4He_E_si_Q3 = fh.Book("4He_E_si_Q3");
+HistFamily h4He_E_si_vs_Theta_Q3 = fh.Book("4He_E_si_vs_Theta_Q3");
+HistFamily h4He_E_si_vs_IntPoint_Q3 = fh.Book("4He_E_si_vs_IntPoint_Q3");
+HistFamily h4He_E_si_SX3_1 = fh.Book("4He_E_si_SX3_1");
+HistFamily h4He_E_si_vs_Theta_SX3_1 = fh.Book("4He_E_si_vs_Theta_SX3_1");
+HistFamily h4He_E_si_vs_IntPoint_SX3_1 = fh.Book("4He_E_si_vs_IntPoint_SX3_1");
+HistFamily h4He_E_si_SX3_2 = fh.Book("4He_E_si_SX3_2");
+HistFamily h4He_E_si_vs_Theta_SX3_2 = fh.Book("4He_E_si_vs_Theta_SX3_2");
+HistFamily h4He_E_si_vs_IntPoint_SX3_2 = fh.Book("4He_E_si_vs_IntPoint_SX3_2");
+HistFamily h4He_E_rxn = fh.Book("4He_E_rxn");
+HistFamily h4He_E_rxn_q3 = fh.Book("4He_E_rxn_q3");
+HistFamily h4He_E_rxn_r1 = fh.Book("4He_E_rxn_r1");
+HistFamily h4He_E_rxn_r2 = fh.Book("4He_E_rxn_r2");
+HistFamily h4He_Elastic = fh.Book("4He_Elastic");
+HistFamily h4He_Elastic_q3 = fh.Book("4He_Elastic_q3");
+HistFamily h4He_Elastic_r1 = fh.Book("4He_Elastic_r1");
+HistFamily h4He_Elastic_r2 = fh.Book("4He_Elastic_r2");
+HistFamily hLightPar_rxn_vs_Elastic_4He_Energy_Q3 = fh.Book("LightPar_rxn_vs_Elastic_4He_Energy_Q3");
+HistFamily hLightPar_rxn_vs_Elastic_4He_Energy_SX3_1 = fh.Book("LightPar_rxn_vs_Elastic_4He_Energy_SX3_1");
+HistFamily hLightPar_rxn_vs_Elastic_4He_Energy_SX3_2 = fh.Book("LightPar_rxn_vs_Elastic_4He_Energy_SX3_2");
+HistFamily hBeam_4He_Energy = fh.Book("Beam_4He_Energy");
+HistFamily hBeamEnergy_vs_Beam_4He_Energy = fh.Book("BeamEnergy_vs_Beam_4He_Energy");
+HistFamily hBeam_4He_Energy_Q3 = fh.Book("Beam_4He_Energy_Q3");
+HistFamily hBeamEnergy_vs_Beam_4He_Energy_Q3 = fh.Book("BeamEnergy_vs_Beam_4He_Energy_Q3");
+HistFamily hBeam_4He_Energy_SX3_1 = fh.Book("Beam_4He_Energy_SX3_1");
+HistFamily hBeamEnergy_vs_Beam_4He_Energy_SX3_1 = fh.Book("BeamEnergy_vs_Beam_4He_Energy_SX3_1");
+HistFamily hBeam_4He_Energy_SX3_2 = fh.Book("Beam_4He_Energy_SX3_2");
+HistFamily hBeamEnergy_vs_Beam_4He_Energy_SX3_2 = fh.Book("BeamEnergy_vs_Beam_4He_Energy_SX3_2");
+HistFamily hproton_E_si = fh.Book("proton_E_si");
+HistFamily hproton_E_si_vs_Theta = fh.Book("proton_E_si_vs_Theta");
+HistFamily hproton_E_si_vs_IntPoint = fh.Book("proton_E_si_vs_IntPoint");
+HistFamily hproton_E_si_Q3 = fh.Book("proton_E_si_Q3");
+HistFamily hproton_E_si_vs_Theta_Q3 = fh.Book("proton_E_si_vs_Theta_Q3");
+HistFamily hproton_E_si_vs_IntPoint_Q3 = fh.Book("proton_E_si_vs_IntPoint_Q3");
+HistFamily hproton_E_si_SX3_1 = fh.Book("proton_E_si_SX3_1");
+HistFamily hproton_E_si_vs_Theta_SX3_1 = fh.Book("proton_E_si_vs_Theta_SX3_1");
+HistFamily hproton_E_si_vs_IntPoint_SX3_1 = fh.Book("proton_E_si_vs_IntPoint_SX3_1");
+HistFamily hproton_E_si_SX3_2 = fh.Book("proton_E_si_SX3_2");
+HistFamily hproton_E_si_vs_Theta_SX3_2 = fh.Book("proton_E_si_vs_Theta_SX3_2");
+HistFamily hproton_E_si_vs_IntPoint_SX3_2 = fh.Book("proton_E_si_vs_IntPoint_SX3_2");
+HistFamily hproton_E_rxn = fh.Book("proton_E_rxn");
+HistFamily hproton_E_q3 = fh.Book("proton_E_q3");
+HistFamily hInteractionPoint_protoncut_QQQ = fh.Book("InteractionPoint_protoncut_QQQ");
+HistFamily hproton_E_r1 = fh.Book("proton_E_r1");
+HistFamily hInteractionPoint_protoncut_r1 = fh.Book("InteractionPoint_protoncut_r1");
+HistFamily hproton_E_r2 = fh.Book("proton_E_r2");
+HistFamily hInteractionPoint__protoncut_r2 = fh.Book("InteractionPoint__protoncut_r2");
 ////////////////////////////////////////////////////////////////////////////////////
 bool Track::Tr_Sisort_method(struct TrackEvent a,struct TrackEvent b){
   if(a.SiEnergy > b.SiEnergy)
@@ -127,6 +249,9 @@ int main(int argc, char* argv[]) {
 
   //Don't know what this does, but libraries won't load without it
   TApplication *myapp=new TApplication("myapp",0,0); 
+  //the entries processed in each file: -first, -last, -every, -random, -stratified, -seed
+  EntrySelection Entries;
+  if (!Entries.ParseArgs(argc,argv)) exit(EXIT_FAILURE);
 
   Int_t numarg=3;
 #ifdef DoCut
@@ -134,6 +259,7 @@ int main(int argc, char* argv[]) {
 #endif
   if (argc!=numarg) {
     cout << "Error: Wrong Number of Arguments\n";
+    cout << "Options: " << EntrySelection::Usage() << ", applied to each file of the list\n";
     exit(EXIT_FAILURE);
   }
 
@@ -154,14 +280,14 @@ int main(int argc, char* argv[]) {
   strcpy( file_cut1, argv[3] );
  
   //He4 cut
-  TFile *cut_file1 = new TFile(file_cut1);
-  if (!cut_file1->IsOpen()){
+  CutRegistry Cuts; //all the cuts of the files, read once (../include/CutRegistry.h)
+  if (!Cuts.LoadFile(file_cut1)){
     cout << "Cut file1: " << file_cut1 << " could not be opened.\n";
     exit(EXIT_FAILURE);
   }
-  TCutG *cut1 = NULL;
-  //cut1 = (TCutG*)cut_file1->Get("alphasRun924newPCThres03212017QQQ"); // cut for 160(a,a) run924
-  cut1 = (TCutG*)cut_file1->Get("alphas_run778_911_timecut_protoncut_Qvalue_BeamCorrect_05252017"); // cut for 18Ne(a,a) run778_911_timecut
+  const FastCut *cut1 = NULL;
+  //cut1 = Cuts.Get(file_cut1,"alphasRun924newPCThres03212017QQQ"); // cut for 160(a,a) run924
+  cut1 = Cuts.Get(file_cut1,"alphas_run778_911_timecut_protoncut_Qvalue_BeamCorrect_05252017"); // cut for 18Ne(a,a) run778_911_timecut
   
   if (cut1 == NULL){
     cout << "Cut1 does not exist\n";
@@ -174,13 +300,12 @@ int main(int argc, char* argv[]) {
   strcpy( file_cut2, argv[3] );
     
   //proton cut
-  TFile *cut_file2 = new TFile(file_cut2);
-  if (!cut_file2->IsOpen()){
+  if (!Cuts.LoadFile(file_cut2)){
     cout << "Cut file2: " << file_cut2 << " could not be opened.\n";
     exit(EXIT_FAILURE);
   }
-  TCutG *cut2 = NULL;
-  cut2 = (TCutG*)cut_file2->Get("protonsQ3R1_run778_911_05232017");
+  const FastCut *cut2 = NULL;
+  cut2 = Cuts.Get(file_cut2,"protonsQ3R1_run778_911_05232017");
   
   if (cut2 == NULL){
     cout << "Cut2 does not exist\n";
@@ -255,22 +380,30 @@ cout << argv[3] << endl;
   */
   ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+  if(FillIMT) ROOT::EnableImplicitMT();
   TFile *outputfile = new TFile(file_cal,"RECREATE");
   TTree *MainTree = new TTree("MainTree","MainTree");
+  TreeFillThread MainFill(MainTree,FillThread);
   //++
-  MainTree->Branch("Tr.NTracks",&Tr.NTracks,"NTracks/I");
-  MainTree->Branch("Tr.NTracks1",&Tr.NTracks1,"NTracks1/I");
-  MainTree->Branch("Tr.NTracks2",&Tr.NTracks2,"NTracks2/I");
-  MainTree->Branch("Tr.NTracks3",&Tr.NTracks3,"NTracks3/I");
-  MainTree->Branch("Tr.TrEvent",&Tr.TrEvent); 
-  MainTree->Branch("Tr.HeavyEvent",&Tr.HeavyEvent);
-  MainTree->Branch("RFTime",&RFTime,"RFTime/I");
-  MainTree->Branch("MCPTime",&MCPTime,"MCPTime/I");
+  MainTree->Branch("Tr.NTracks",MainFill.Copy(Tr.NTracks),"NTracks/I");
+  MainTree->Branch("Tr.NTracks1",MainFill.Copy(Tr.NTracks1),"NTracks1/I");
+  MainTree->Branch("Tr.NTracks2",MainFill.Copy(Tr.NTracks2),"NTracks2/I");
+  MainTree->Branch("Tr.NTracks3",MainFill.Copy(Tr.NTracks3),"NTracks3/I");
+  MainTree->Branch("Tr.TrEvent",MainFill.Copy(Tr.TrEvent)); 
+  MainTree->Branch("Tr.HeavyEvent",MainFill.Copy(Tr.HeavyEvent));
+  MainTree->Branch("RFTime",MainFill.Copy(RFTime),"RFTime/I");
+  MainTree->Branch("MCPTime",MainFill.Copy(MCPTime),"MCPTime/I");
+
+  DefaultTreeOutputConfig().Load(OutputConfig);
+  DefaultTreeOutputConfig().Apply(MainTree);
 
   RootObjects->Add(MainTree);
 
   fhlist = new TList;
+  fh.SetList(fhlist);
   RootObjects->Add(fhlist);  
+  //the histograms made in the loop stay out of the output file, which the fill thread writes to; written with fhlist
+  if (FillThread) TH1::AddDirectory(kFALSE);
   ////////////////////////////////////////////////////  
   Int_t count_2A_1P=0, count_2A=0, count_1A_1P=0;
   Int_t count_1track=0, count_2tracks=0, count_3tracks =0,count_morethan3tracks=0;
@@ -288,6 +421,8 @@ cout << argv[3] << endl;
   
   string rootfile;
   char rootfile_char[200];
+  TreeInput::SetAsyncPrefetch(AsyncPrefetch);
+  TreeReadStats read_stats;
 
   //------------------counters--------------------------//
   /////////////////////////////////////////////////////////
@@ -355,24 +490,25 @@ cout << argv[3] << endl;
     cout << "Processing File: " << rootfile << endl;   
 
     TTree *raw_tree = (TTree*) inputFile->Get("MainTree");
-    raw_tree->SetBranchAddress("Si.NSiHits",&Si.NSiHits);
-    raw_tree->SetBranchAddress("Si.Detector",&Si.ReadDet);
-    raw_tree->SetBranchAddress("Si.Hit",&Si.ReadHit);
-    raw_tree->SetBranchAddress("PC.NPCHits",&PC.NPCHits);
-    raw_tree->SetBranchAddress("PC.Hit",&PC.ReadHit);
+    //only the branches bound here are read (../include/TreeInput.h)
+    TreeInput input(raw_tree,InputCache);
+    //Si and PC hits, from a nested or flat MainTree (../include/FlatMainTree.h); Si.Detector is not used
+    MainTreeReader reader(input,Si,PC,kFALSE);
     //raw_tree->SetBranchAddress("RFTime",&RFTime);
     //raw_tree->SetBranchAddress("MCPTime",&MCPTime);
-    raw_tree->SetBranchAddress("RFTime",&Old_RFTime);
-    raw_tree->SetBranchAddress("MCPTime",&Old_MCPTime);
+    input.Read("RFTime",&Old_RFTime);
+    input.Read("MCPTime",&Old_MCPTime);
  
-    Long64_t nentries = raw_tree->GetEntries();
-    cout<<"nentries = "<<nentries<<endl;
+    cout<<"nentries = "<<raw_tree->GetEntries()<<endl;
+    Long64_t nentries = Entries.Select(raw_tree->GetEntries()); //entries selected
+    Entries.Print();
+    Entries.Apply(input);
 
     Int_t status;
     for (Long64_t i=0; i<nentries; i++){//====================loop over all events=================
       //cout<<" i =  "<<i<<endl;
 
-      status = raw_tree->GetEvent(i);
+      status = reader.GetEntry(Entries.GetEntry(i));
       std::cout << "\rDone: " << i*100./nentries << "%          " << std::flush;
     
       ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -382,7 +518,7 @@ cout << argv[3] << endl;
       MCPTime = Old_MCPTime;
       RFTime = Old_RFTime;
 
-      MyFill("Timing",600,1,600,fmod((MCPTime*correct-RFTime),546));
+      fh.Fill(hTiming(),600,1,600,fmod((MCPTime*correct-RFTime),546));
       
       //if((fmod((MCPTime*correct-RFTime),546)>26.54 && fmod((MCPTime*correct-RFTime),546)<53.86) || (fmod((MCPTime*correct-RFTime),546)>302.91 && fmod((MCPTime*correct-RFTime),546)<326.21))
       //	MyFill("Timing_Cut",600,1,600,fmod((MCPTime*correct-RFTime),546));
@@ -411,7 +547,7 @@ cout << argv[3] << endl;
       /////////////////////////////////////////////////////////////////////////////////////////////////////    
       //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++  
       //cout<<"Si.ReadHit->size() = "<<Si.ReadHit->size()<<endl;  
-      MyFill("Si_ReadHit_size",500,0,50,Si.ReadHit->size());  
+      fh.Fill(hSi_ReadHit_size(),500,0,50,Si.ReadHit->size());  
 
       for (Int_t j=0; j<Si.ReadHit->size(); j++) {//loop over all silicon
 	
@@ -547,7 +683,7 @@ cout << argv[3] << endl;
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////    
       //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
       //cout<<"PC.ReadHit->size() = "<<PC.ReadHit->size()<<endl;
-      MyFill("PC_ReadHit_size",500,0,50,PC.ReadHit->size());  
+      fh.Fill(hPC_ReadHit_size(),500,0,50,PC.ReadHit->size());  
 
       for (Int_t l=0; l<PC.ReadHit->size(); l++ ){//loop over pc
 	
@@ -618,10 +754,10 @@ cout << argv[3] << endl;
 
       if(Tr.NTracks1==1){
 	if(Tr.TrEvent[0].WireID >-1 && Tr.TrEvent[0].WireID < 23)
-	  MyFill(Form("PCEnergyPlus_Wire%i_Wire%i",Tr.TrEvent[0].WireID+1,Tr.TrEvent[0].WireID),300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID],300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID+1]);
+	  fh.Fill(hPCEnergyPlus_WireN_WireN(Tr.TrEvent[0].WireID+1,Tr.TrEvent[0].WireID),300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID],300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID+1]);
 	
 	if(Tr.TrEvent[0].WireID >0 && Tr.TrEvent[0].WireID < 24)
-	  MyFill(Form("PCEnergyMinus_Wire%i_Wire%i",Tr.TrEvent[0].WireID-1,Tr.TrEvent[0].WireID),300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID],300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID-1]);
+	  fh.Fill(hPCEnergyMinus_WireN_WireN(Tr.TrEvent[0].WireID-1,Tr.TrEvent[0].WireID),300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID],300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID-1]);
 
       }
 	 
@@ -631,12 +767,12 @@ cout << argv[3] << endl;
       if(Tr.NTracks1==1 && Tr.TrEvent[0].DetID > 15 && Tr.TrEvent[0].DetID < 28){
 	for(Int_t m=0; m<Tr.NTracks3; m++)
 	  {
-	    MyFill("PCEnergy_NTracks3_R2",1000,-0.1,1,Tr.TrEvent[m+Tr.NTracks1+Tr.NTracks2].PCEnergy);
+	    fh.Fill(hPCEnergy_NTracks3_R2(),1000,-0.1,1,Tr.TrEvent[m+Tr.NTracks1+Tr.NTracks2].PCEnergy);
 	  }
       }else if(Tr.NTracks1==1 && Tr.TrEvent[0].DetID>-1 && Tr.TrEvent[0].DetID < 16){
 	for(Int_t m=0; m<Tr.NTracks3; m++)
 	  {
-	    MyFill("PCEnergy_NTracks3_QQQ_R1",1000,-0.1,1,Tr.TrEvent[m+Tr.NTracks1+Tr.NTracks2].PCEnergy);
+	    fh.Fill(hPCEnergy_NTracks3_QQQ_R1(),1000,-0.1,1,Tr.TrEvent[m+Tr.NTracks1+Tr.NTracks2].PCEnergy);
 	  }
       }
 
@@ -649,23 +785,23 @@ cout << argv[3] << endl;
 	//cout<<"   Check 10 " <<Tr.NTracks<<endl;
 
 	//All PCWire vs Energy
-	MyFill("WireID_vs_PCEnegy",25,0,24,Tr.TrEvent[pc].WireID,500,0,0.35,Tr.TrEvent[pc].PCEnergy);
+	fh.Fill(hWireID_vs_PCEnegy(),25,0,24,Tr.TrEvent[pc].WireID,500,0,0.35,Tr.TrEvent[pc].PCEnergy);
 
 	for(Int_t pca=0; pca<Tr.NTracks1; pca++){
 
 	  //PCWire with track in channel 12 & other tracks & non-tracks in other channels
-	  MyFill("WireID_mod1_vs_PCEnegy_12",
+	  fh.Fill(hWireID_mod1_vs_PCEnegy_12(),
 		 25,0,24,(((Int_t)Tr.TrEvent[pc].WireID-(Int_t)Tr.TrEvent[pca].WireID +12)%24),
 		 500,0,0.35,Tr.TrEvent[pc].PCEnergy);
-	  MyFill("WireID_mod1_vs_PCEnegy_0" ,
+	  fh.Fill(hWireID_mod1_vs_PCEnegy_0(),
 		 25,0,24,(((Int_t)Tr.TrEvent[pc].WireID-(Int_t)Tr.TrEvent[pca].WireID)%24),
 		 500,0,0.35,Tr.TrEvent[pc].PCEnergy);
 	}
       }
 
       for(Int_t m=0; m<Tr.NTracks; m++) {
-	MyFill(Form("PCWireID_DetID_%i",Tr.TrEvent[m].DetID),25,0,24,Tr.TrEvent[m].WireID); 
-	MyFill(Form("PCWireID_DetID2_%i",Tr.TrEvent[0].DetID),25,0,24,Tr.TrEvent[m].WireID); 
+	fh.Fill(hPCWireID_DetID_N(Tr.TrEvent[m].DetID),25,0,24,Tr.TrEvent[m].WireID); 
+	fh.Fill(hPCWireID_DetID2_N(Tr.TrEvent[0].DetID),25,0,24,Tr.TrEvent[m].WireID); 
       }
 #endif     
 
@@ -805,96 +941,96 @@ cout << argv[3] << endl;
 	//cout<<" BeamE = "<<BeamE<<"  pcr = "<<pcr<<endl;
 	//cout<<"bpc = "<<bpc<<"  PCZ_Ref = "<<Tr.TrEvent[s].PCZ_Ref<<endl;
 
-	MyFill(Form("PCZ_Ref%i",Tr.TrEvent[s].WireID),300,1,30,Tr.TrEvent[s].pcz_ref);
+	fh.Fill(hPCZ_RefN(Tr.TrEvent[s].WireID),300,1,30,Tr.TrEvent[s].pcz_ref);
 
-	MyFill(Form("SiZ_vs_SiEnergy_WireID%i",Tr.TrEvent[s].WireID),600,-1,30,Tr.TrEvent[s].SiEnergy,600,-1,25,Tr.TrEvent[s].SiZ);
+	fh.Fill(hSiZ_vs_SiEnergy_WireIDN(Tr.TrEvent[s].WireID),600,-1,30,Tr.TrEvent[s].SiEnergy,600,-1,25,Tr.TrEvent[s].SiZ);
 	if(Tr.TrEvent[s].DetID<28 && Tr.TrEvent[s].DetID>3)
-	  MyFill("SiZ_vs_SiEnergy_R1_R2",600,-1,30,Tr.TrEvent[s].SiEnergy,600,-1,25,Tr.TrEvent[s].SiZ);
+	  fh.Fill(hSiZ_vs_SiEnergy_R1_R2(),600,-1,30,Tr.TrEvent[s].SiEnergy,600,-1,25,Tr.TrEvent[s].SiZ);
 
 	////////////////////////////////////////////////////////////////
 
-	MyFill(Form("PCZ_vs_Z_beforeCal%i",Tr.TrEvent[s].WireID),600,-1.5,1.5,Tr.TrEvent[s].PCZ,600,1.0,30.0,Tr.TrEvent[s].pcz_ref); // before PCWIRECAL applied
-	MyFill(Form("PCZ_vs_Z_afterCal%i",Tr.TrEvent[s].WireID),600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref); // after PCWIRECAL applied
+	fh.Fill(hPCZ_vs_Z_beforeCalN(Tr.TrEvent[s].WireID),600,-1.5,1.5,Tr.TrEvent[s].PCZ,600,1.0,30.0,Tr.TrEvent[s].pcz_ref); // before PCWIRECAL applied
+	fh.Fill(hPCZ_vs_Z_afterCalN(Tr.TrEvent[s].WireID),600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref); // after PCWIRECAL applied
 
 	if(Tr.TrEvent[s].DetID<16 && Tr.TrEvent[s].DetID>-1) {
-	  MyFill(Form("PCZ_vs_Z_afterCal_q3_r1%i",Tr.TrEvent[s].WireID),600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref);
-	  MyFill("PCZ_vs_Z_afterCal_q3_r1",600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref);
+	  fh.Fill(hPCZ_vs_Z_afterCal_q3_r1N(Tr.TrEvent[s].WireID),600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref);
+	  fh.Fill(hPCZ_vs_Z_afterCal_q3_r1(),600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref);
 	}
 
 	if(Tr.TrEvent[s].DetID<28 && Tr.TrEvent[s].DetID>3){
-	  MyFill(Form("PCZ_vs_Z_afterCal_r1_r2%i",Tr.TrEvent[s].WireID),600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref);
+	  fh.Fill(hPCZ_vs_Z_afterCal_r1_r2N(Tr.TrEvent[s].WireID),600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref);
 	}
 	
-	MyFill("PCZ_vs_Z_afterCal_All",600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref);
+	fh.Fill(hPCZ_vs_Z_afterCal_All(),600,-1.0,30.0,Tr.TrEvent[s].PCZ,600,-1.0,30.0,Tr.TrEvent[s].pcz_ref);
 
 	///////////////////////////////////////////////////////////////
 
-	MyFill(Form("PCEnergy_vs_PCZ_beforeCal_WireID%i",Tr.TrEvent[s].WireID),600,-1.5,1.5,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);// before PCWIRECAL applied 
-	MyFill(Form("PCEnergy_vs_PCZ_afterCal_WireID%i",Tr.TrEvent[s].WireID),600,-10,60,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);// after PCWIRECAL applied
+	fh.Fill(hPCEnergy_vs_PCZ_beforeCal_WireIDN(Tr.TrEvent[s].WireID),600,-1.5,1.5,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);// before PCWIRECAL applied 
+	fh.Fill(hPCEnergy_vs_PCZ_afterCal_WireIDN(Tr.TrEvent[s].WireID),600,-10,60,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);// after PCWIRECAL applied
 	
 	if(Tr.TrEvent[s].DetID<16 && Tr.TrEvent[s].DetID>-1){
-	  MyFill(Form("PCEnergy_vs_PCZ_q3_r1_%i",Tr.TrEvent[s].WireID),600,-10,60,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);
-	  MyFill("PCEnergy_vs_PCZ_q3_r1",600,-10,60,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);
+	  fh.Fill(hPCEnergy_vs_PCZ_q3_r1_N(Tr.TrEvent[s].WireID),600,-10,60,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);
+	  fh.Fill(hPCEnergy_vs_PCZ_q3_r1(),600,-10,60,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);
 	}
 	
-	MyFill("PCEnergy_vs_PCZ_All",600,-10,60,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);
+	fh.Fill(hPCEnergy_vs_PCZ_All(),600,-10,60,Tr.TrEvent[s].PCZ,600,-0.1,0.5,Tr.TrEvent[s].PCEnergy);
 	
 
 	//--------PCOffset = PCZ-PCZ_ref----------------------//////////////////
 
-	MyFill(Form("PCZoffset_vs_PCEnergy_%i",Tr.TrEvent[s].WireID),600,-0.1,0.5,Tr.TrEvent[s].PCEnergy,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	fh.Fill(hPCZoffset_vs_PCEnergy_N(Tr.TrEvent[s].WireID),600,-0.1,0.5,Tr.TrEvent[s].PCEnergy,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 
 	if(Tr.TrEvent[s].DetID<16 && Tr.TrEvent[s].DetID>-1){
-	  MyFill(Form("PCZoffset_vs_PCEnergy_q3_r1_%i",Tr.TrEvent[s].WireID),600,-0.1,0.5,Tr.TrEvent[s].PCEnergy,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
-	  MyFill("PCZoffset_vs_PCEnergy_q3_r1",600,-0.1,0.5,Tr.TrEvent[s].PCEnergy,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	  fh.Fill(hPCZoffset_vs_PCEnergy_q3_r1_N(Tr.TrEvent[s].WireID),600,-0.1,0.5,Tr.TrEvent[s].PCEnergy,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	  fh.Fill(hPCZoffset_vs_PCEnergy_q3_r1(),600,-0.1,0.5,Tr.TrEvent[s].PCEnergy,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 	}
 
-	MyFill("PCZoffset_vs_PCEnergy_All",600,-0.1,0.5,Tr.TrEvent[s].PCEnergy,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	fh.Fill(hPCZoffset_vs_PCEnergy_All(),600,-0.1,0.5,Tr.TrEvent[s].PCEnergy,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 
 	/////////////////////////////////////////////////////////////////////////
 
-	MyFill(Form("PCZoffset_vs_PCZ_beforeCal%i",Tr.TrEvent[s].WireID),600,-1.5,1.5,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref)); // before PCWIRECAL applied
-	MyFill(Form("PCZoffset_vs_PCZ_afterCal%i",Tr.TrEvent[s].WireID),600,-1,30,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref)); // after PCWIRECAL applied
+	fh.Fill(hPCZoffset_vs_PCZ_beforeCalN(Tr.TrEvent[s].WireID),600,-1.5,1.5,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref)); // before PCWIRECAL applied
+	fh.Fill(hPCZoffset_vs_PCZ_afterCalN(Tr.TrEvent[s].WireID),600,-1,30,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref)); // after PCWIRECAL applied
 
 	if(Tr.TrEvent[s].DetID<16 && Tr.TrEvent[s].DetID>-1){
-	  MyFill(Form("PCZoffset_vs_PCZ_q3_r1_%i",Tr.TrEvent[s].WireID),600,-1,30,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
-	  MyFill("PCZoffset_vs_PCZ_q3_r1",600,-1,30,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	  fh.Fill(hPCZoffset_vs_PCZ_q3_r1_N(Tr.TrEvent[s].WireID),600,-1,30,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	  fh.Fill(hPCZoffset_vs_PCZ_q3_r1(),600,-1,30,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 	}
 
-	MyFill("PCZoffset_vs_PCZ_All",600,-1,30,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	fh.Fill(hPCZoffset_vs_PCZ_All(),600,-1,30,Tr.TrEvent[s].PCZ,600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 	
 	////////////////////////////////////////////////////////////////////////////
 
-	MyFill(Form("PCZoffset_vs_Theta_%i",Tr.TrEvent[s].WireID),600,0,190,Tr.TrEvent[s].Theta*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	fh.Fill(hPCZoffset_vs_Theta_N(Tr.TrEvent[s].WireID),600,0,190,Tr.TrEvent[s].Theta*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 
 	if(Tr.TrEvent[s].DetID<16 && Tr.TrEvent[s].DetID>-1){
-	  MyFill(Form("PCZoffset_vs_Theta_q3_r1_%i",Tr.TrEvent[s].WireID),600,0,190,Tr.TrEvent[s].Theta*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
-	  MyFill("PCZoffset_vs_Theta_q3_r1",600,0,190,Tr.TrEvent[s].Theta*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	  fh.Fill(hPCZoffset_vs_Theta_q3_r1_N(Tr.TrEvent[s].WireID),600,0,190,Tr.TrEvent[s].Theta*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	  fh.Fill(hPCZoffset_vs_Theta_q3_r1(),600,0,190,Tr.TrEvent[s].Theta*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 	}
-	MyFill("PCZoffset_vs_Theta_All",600,0,190,Tr.TrEvent[s].Theta*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	fh.Fill(hPCZoffset_vs_Theta_All(),600,0,190,Tr.TrEvent[s].Theta*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 
 	// for all the wires together the Phi_s make more sense
-	MyFill("PCZoffset_vs_PCPhi",600,0,360,Tr.TrEvent[s].PCPhi*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
-	MyFill("PCZoffset_vs_SiPhi",600,0,360,Tr.TrEvent[s].SiPhi*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	fh.Fill(hPCZoffset_vs_PCPhi(),600,0,360,Tr.TrEvent[s].PCPhi*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
+	fh.Fill(hPCZoffset_vs_SiPhi(),600,0,360,Tr.TrEvent[s].SiPhi*180/TMath::Pi(),600,-20,20,(Tr.TrEvent[s].PCZ-Tr.TrEvent[s].pcz_ref));
 
 
 	//IntPoint Reconstruction
 	if(Tr.TrEvent[s].DetID<4 && Tr.TrEvent[s].DetID>-1)
-	  MyFill("IntPoint_cut_Q3",600,-10,60,Tr.TrEvent[s].IntPoint);
+	  fh.Fill(hIntPoint_cut_Q3(),600,-10,60,Tr.TrEvent[s].IntPoint);
 	if(Tr.TrEvent[s].DetID<16 && Tr.TrEvent[s].DetID>3)
-	  MyFill("IntPoint_cut_SX3_R1",600,-10,60,Tr.TrEvent[s].IntPoint);
+	  fh.Fill(hIntPoint_cut_SX3_R1(),600,-10,60,Tr.TrEvent[s].IntPoint);
 	if(Tr.TrEvent[s].DetID<28 && Tr.TrEvent[s].DetID>15)
-	  MyFill("IntPoint_cut_SX3_R2",600,-10,60,Tr.TrEvent[s].IntPoint);
+	  fh.Fill(hIntPoint_cut_SX3_R2(),600,-10,60,Tr.TrEvent[s].IntPoint);
 	
 
 	  
 
 	if(Tr.NTracks1==1){
 	if(Tr.TrEvent[0].WireID >-1 && Tr.TrEvent[0].WireID < 23)
-	  MyFill(Form("PCEnergyPlus_cut_Wire%i_Wire%i",Tr.TrEvent[0].WireID+1,Tr.TrEvent[0].WireID),300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID],300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID+1]);
+	  fh.Fill(hPCEnergyPlus_cut_WireN_WireN(Tr.TrEvent[0].WireID+1,Tr.TrEvent[0].WireID),300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID],300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID+1]);
 	
 	if(Tr.TrEvent[0].WireID >0 && Tr.TrEvent[0].WireID < 24)
-	  MyFill(Form("PCEnergyMinus_cut_Wire%i_Wire%i",Tr.TrEvent[0].WireID-1,Tr.TrEvent[0].WireID),300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID],300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID-1]);
+	  fh.Fill(hPCEnergyMinus_cut_WireN_WireN(Tr.TrEvent[0].WireID-1,Tr.TrEvent[0].WireID),300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID],300,0,0.25,PCGoodEnergy[Tr.TrEvent[0].WireID-1]);
 
       }
 	//} //end of cut2 loop
@@ -907,32 +1043,32 @@ cout << argv[3] << endl;
 #ifdef FillEdE_cor
       for(Int_t q=0; q<Tr.NTracks1;q++){
 	
-	MyFill(Form("PCEnergy_vs_PCZ_WireID%i",Tr.TrEvent[q].WireID),600,-10,60,Tr.TrEvent[q].PCZ,600,-0.1,0.5,Tr.TrEvent[q].PCEnergy);
-	MyFill("BeamEnergy_vs_IntPoint",100,-20,80,Tr.TrEvent[q].IntPoint,100,0,90,Tr.TrEvent[q].BeamEnergy);
+	fh.Fill(hPCEnergy_vs_PCZ_WireIDN(Tr.TrEvent[q].WireID),600,-10,60,Tr.TrEvent[q].PCZ,600,-0.1,0.5,Tr.TrEvent[q].PCEnergy);
+	fh.Fill(hBeamEnergy_vs_IntPoint(),100,-20,80,Tr.TrEvent[q].IntPoint,100,0,90,Tr.TrEvent[q].BeamEnergy);
 
-	MyFill("E_de",600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy);
-	MyFill("E_de_corrected_ALL",600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));
-	MyFill("InteractionPoint",300,-10,56,Tr.TrEvent[q].IntPoint);	
-	MyFill("E_si_vs_Theta",500,0,200,Tr.TrEvent[q].Theta*ConvAngle,500,0,35,Tr.TrEvent[q].SiEnergy);
+	fh.Fill(hE_de(),600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy);
+	fh.Fill(hE_de_corrected_ALL(),600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));
+	fh.Fill(hInteractionPoint(),300,-10,56,Tr.TrEvent[q].IntPoint);	
+	fh.Fill(hE_si_vs_Theta(),500,0,200,Tr.TrEvent[q].Theta*ConvAngle,500,0,35,Tr.TrEvent[q].SiEnergy);
 
 	if(Tr.TrEvent[q].DetID<4 && Tr.TrEvent[q].DetID>-1){
-	  MyFill("E_de_Q3",600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy);
-	  MyFill("E_de_corrected_Q3",600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));
-	  MyFill("InteractionPoint_Q3",300,-10,56,Tr.TrEvent[q].IntPoint);
-	  MyFill("E_si_vs_Theta_Q3",500,0,200,Tr.TrEvent[q].Theta*ConvAngle,500,0,35,Tr.TrEvent[q].SiEnergy);
+	  fh.Fill(hE_de_Q3(),600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy);
+	  fh.Fill(hE_de_corrected_Q3(),600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));
+	  fh.Fill(hInteractionPoint_Q3(),300,-10,56,Tr.TrEvent[q].IntPoint);
+	  fh.Fill(hE_si_vs_Theta_Q3(),500,0,200,Tr.TrEvent[q].Theta*ConvAngle,500,0,35,Tr.TrEvent[q].SiEnergy);
 	}
 	if(Tr.TrEvent[q].DetID<16 && Tr.TrEvent[q].DetID>3){
-	  MyFill("E_de_SX3_1",600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy);
-	  MyFill("E_de_corrected_SX3_1",600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));
-	  MyFill("InteractionPoint_SX3_1",300,-10,56,Tr.TrEvent[q].IntPoint);
-	  MyFill("E_si_vs_Theta_SX3_1",500,0,200,Tr.TrEvent[q].Theta*ConvAngle,500,0,35,Tr.TrEvent[q].SiEnergy);
+	  fh.Fill(hE_de_SX3_1(),600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy);
+	  fh.Fill(hE_de_corrected_SX3_1(),600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));
+	  fh.Fill(hInteractionPoint_SX3_1(),300,-10,56,Tr.TrEvent[q].IntPoint);
+	  fh.Fill(hE_si_vs_Theta_SX3_1(),500,0,200,Tr.TrEvent[q].Theta*ConvAngle,500,0,35,Tr.TrEvent[q].SiEnergy);
 	}
 	if(Tr.TrEvent[q].DetID<28 && Tr.TrEvent[q].DetID>15){
 	  
-	  MyFill("E_de_SX3_2",600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy);
-	  MyFill("E_de_corrected_SX3_2",600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));
-	  MyFill("InteractionPoint_SX3_2",300,-10,56,Tr.TrEvent[q].IntPoint);
-	  MyFill("E_si_vs_Theta_SX3_2",500,0,200,Tr.TrEvent[q].Theta*ConvAngle,500,0,35,Tr.TrEvent[q].SiEnergy);
+	  fh.Fill(hE_de_SX3_2(),600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy);
+	  fh.Fill(hE_de_corrected_SX3_2(),600,-1,35,Tr.TrEvent[q].SiEnergy,600,-0.01,0.35,Tr.TrEvent[q].PCEnergy *sin(Tr.TrEvent[q].Theta));
+	  fh.Fill(hInteractionPoint_SX3_2(),300,-10,56,Tr.TrEvent[q].IntPoint);
+	  fh.Fill(hE_si_vs_Theta_SX3_2(),500,0,200,Tr.TrEvent[q].Theta*ConvAngle,500,0,35,Tr.TrEvent[q].SiEnergy);
 	}
 
       }
@@ -954,7 +1090,7 @@ cout << argv[3] << endl;
 	if((Tr.TrEvent[c].DetID>-1 && Tr.TrEvent[c].DetID<16) && (Tr.TrEvent[c].BeamEnergy>0 && Tr.TrEvent[c].BeamEnergy<20)){
 #ifdef DoCut
 	  if (cut2->IsInside(Tr.TrEvent[c].SiEnergy,Tr.TrEvent[c].PCEnergy*sin(Tr.TrEvent[c].Theta))) {
-	    MyFill("Timing_Cut",600,1,600,fmod((MCPTime*correct-RFTime),546));
+	    fh.Fill(hTiming_Cut(),600,1,600,fmod((MCPTime*correct-RFTime),546));
 	    //Elastic1.ReconstructHeavy(Tr,0);
 	    Elastic1.ReconstructHeavy_Qvalue(QValue,Tr,c);
 	    std::cout << Tr.NTracks1 << " " << c  << std::endl;
@@ -985,23 +1121,23 @@ cout << argv[3] << endl;
 	 
 	if (cut1->IsInside(Tr.TrEvent[c].SiEnergy,Tr.TrEvent[c].PCEnergy*sin(Tr.TrEvent[c].Theta))) {
 
-	  MyFill("4He_E_si",500,0,35,Tr.TrEvent[c].SiEnergy);
-	  MyFill("4He_E_si_vs_Theta",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
-	  MyFill("4He_E_si_vs_IntPoint",500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(h4He_E_si(),500,0,35,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(h4He_E_si_vs_Theta(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(h4He_E_si_vs_IntPoint(),500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
 
 	  if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1){
-	    MyFill("4He_E_si_Q3",500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_Theta_Q3",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_IntPoint_Q3",500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_Q3(),500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_Theta_Q3(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_IntPoint_Q3(),500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
 	  }else if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3){
-	    MyFill("4He_E_si_SX3_1",500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_Theta_SX3_1",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_IntPoint_SX3_1",500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_SX3_1(),500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_Theta_SX3_1(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_IntPoint_SX3_1(),500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
 	  }else if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15){
-	    MyFill("4He_E_si_SX3_2",500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("4He_E_si_vs_Theta_SX3_2",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_SX3_2(),500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_Theta_SX3_2(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
 	    //cout << "IntPoint: " << Tr.TrEvent[c].IntPoint << " La-IntPoint: " << (La-Tr.TrEvent[c].IntPoint) << " BeamEnergy: " << Tr.TrEvent[c].BeamEnergy <<endl;	
-	    MyFill("4He_E_si_vs_IntPoint_SX3_2",500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(h4He_E_si_vs_IntPoint_SX3_2(),500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
 	  }
 
 
@@ -1012,13 +1148,13 @@ cout << argv[3] << endl;
 	    E_4He_rxn = E_Loss_alpha->GetLookupEnergy(Tr.TrEvent[c].SiEnergy,(-Tr.TrEvent[c].PathLength));
 	    Tr.TrEvent[c].LightParEnergy = E_4He_rxn;
 	    //E_4He_rxn = E_Loss_alpha->GetInitialEnergy(Tr.TrEvent[c].SiEnergy,Tr.TrEvent[c].PathLength,0.1);
-	      MyFill("4He_E_rxn",500,0,40,E_4He_rxn);
+	      fh.Fill(h4He_E_rxn(),500,0,40,E_4He_rxn);
 	      if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1)
-		MyFill("4He_E_rxn_q3",500,0,40,E_4He_rxn);
+		fh.Fill(h4He_E_rxn_q3(),500,0,40,E_4He_rxn);
 	      if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3)
-		MyFill("4He_E_rxn_r1",500,0,40,E_4He_rxn);
+		fh.Fill(h4He_E_rxn_r1(),500,0,40,E_4He_rxn);
 	      if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15)
-		MyFill("4He_E_rxn_r2",500,0,40,E_4He_rxn);
+		fh.Fill(h4He_E_rxn_r2(),500,0,40,E_4He_rxn);
 
 
 	      //Beam Energy Calculation from the Elastic scattering: 
@@ -1035,41 +1171,41 @@ cout << argv[3] << endl;
 	      Tr.TrEvent[c].HeEnergyQvalue =  Energy_4He_elastic;
 
 	      ///--------------Alpha particles elastic graphs-----------------------///////////////////////////
-	       MyFill("4He_Elastic",500,0,40,Energy_4He_elastic);
+	       fh.Fill(h4He_Elastic(),500,0,40,Energy_4He_elastic);
 	      if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1)
-		MyFill("4He_Elastic_q3",500,0,40,Energy_4He_elastic);
+		fh.Fill(h4He_Elastic_q3(),500,0,40,Energy_4He_elastic);
 	      if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3)
-		MyFill("4He_Elastic_r1",500,0,40,Energy_4He_elastic);
+		fh.Fill(h4He_Elastic_r1(),500,0,40,Energy_4He_elastic);
 	      if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15)
-		MyFill("4He_Elastic_r2",500,0,40,Energy_4He_elastic);
+		fh.Fill(h4He_Elastic_r2(),500,0,40,Energy_4He_elastic);
 
 
 	      if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1){
-		MyFill("LightPar_rxn_vs_Elastic_4He_Energy_Q3",600,0,40,Energy_4He_elastic,600,0,40,E_4He_rxn);
+		fh.Fill(hLightPar_rxn_vs_Elastic_4He_Energy_Q3(),600,0,40,Energy_4He_elastic,600,0,40,E_4He_rxn);
 	      }else if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3){
-		MyFill("LightPar_rxn_vs_Elastic_4He_Energy_SX3_1",600,0,40,Energy_4He_elastic,600,0,40,E_4He_rxn);
+		fh.Fill(hLightPar_rxn_vs_Elastic_4He_Energy_SX3_1(),600,0,40,Energy_4He_elastic,600,0,40,E_4He_rxn);
 	      }else if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15){
-		MyFill("LightPar_rxn_vs_Elastic_4He_Energy_SX3_2",600,0,40,Energy_4He_elastic,600,0,40,E_4He_rxn);
+		fh.Fill(hLightPar_rxn_vs_Elastic_4He_Energy_SX3_2(),600,0,40,Energy_4He_elastic,600,0,40,E_4He_rxn);
 	      }
 		
 	      ///--------------Beam particles elastic graphs-----------------------///////////////////////////
 	      
-	      MyFill("Beam_4He_Energy",1000,0,100,Energy_Beam_4He);
-	      MyFill("BeamEnergy_vs_Beam_4He_Energy",1000,0,100,Energy_Beam_4He,1000,0,100,Tr.TrEvent[c].BeamEnergy);
+	      fh.Fill(hBeam_4He_Energy(),1000,0,100,Energy_Beam_4He);
+	      fh.Fill(hBeamEnergy_vs_Beam_4He_Energy(),1000,0,100,Energy_Beam_4He,1000,0,100,Tr.TrEvent[c].BeamEnergy);
 
   
 	      if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1){
-		MyFill("Beam_4He_Energy_Q3",1000,0,100,Energy_Beam_4He);
-		MyFill("BeamEnergy_vs_Beam_4He_Energy_Q3",1000,0,100,Energy_Beam_4He,1000,0,100,Tr.TrEvent[c].BeamEnergy);	     
+		fh.Fill(hBeam_4He_Energy_Q3(),1000,0,100,Energy_Beam_4He);
+		fh.Fill(hBeamEnergy_vs_Beam_4He_Energy_Q3(),1000,0,100,Energy_Beam_4He,1000,0,100,Tr.TrEvent[c].BeamEnergy);	     
 	      }else if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3){
 		//cout << "IntPoint: " << Tr.TrEvent[c].IntPoint << " La-IntPoint: " << (La-Tr.TrEvent[c].IntPoint) << " BeamEnergy: " << Tr.TrEvent[c].BeamEnergy <<endl;
-		MyFill("Beam_4He_Energy_SX3_1",1000,0,100,Energy_Beam_4He);
-		MyFill("BeamEnergy_vs_Beam_4He_Energy_SX3_1",1000,0,100,Energy_Beam_4He,1000,0,100,Tr.TrEvent[c].BeamEnergy);	     
+		fh.Fill(hBeam_4He_Energy_SX3_1(),1000,0,100,Energy_Beam_4He);
+		fh.Fill(hBeamEnergy_vs_Beam_4He_Energy_SX3_1(),1000,0,100,Energy_Beam_4He,1000,0,100,Tr.TrEvent[c].BeamEnergy);	     
 	      }else if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15){
 		//cout << "IntPoint: " << Tr.TrEvent[c].IntPoint << " La-IntPoint: " << (La-Tr.TrEvent[c].IntPoint) << " BeamEnergy: " 
 		//     << Tr.TrEvent[c].BeamEnergy << " BeamQval: " << Energy_16O_4He << endl;
-		MyFill("Beam_4He_Energy_SX3_2",1000,0,100,Energy_Beam_4He);
-		MyFill("BeamEnergy_vs_Beam_4He_Energy_SX3_2",1000,0,100,Energy_Beam_4He,1000,0,100,Tr.TrEvent[c].BeamEnergy);	     
+		fh.Fill(hBeam_4He_Energy_SX3_2(),1000,0,100,Energy_Beam_4He);
+		fh.Fill(hBeamEnergy_vs_Beam_4He_Energy_SX3_2(),1000,0,100,Energy_Beam_4He,1000,0,100,Tr.TrEvent[c].BeamEnergy);	     
 	      }
 
 	      
@@ -1139,22 +1275,22 @@ cout << argv[3] << endl;
 	
 	if (cut2->IsInside(Tr.TrEvent[c].SiEnergy,Tr.TrEvent[c].PCEnergy*sin(Tr.TrEvent[c].Theta))){
 
-	  MyFill("proton_E_si",500,0,35,Tr.TrEvent[c].SiEnergy);
-	  MyFill("proton_E_si_vs_Theta",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
-	  MyFill("proton_E_si_vs_IntPoint",500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(hproton_E_si(),500,0,35,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(hproton_E_si_vs_Theta(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
+	  fh.Fill(hproton_E_si_vs_IntPoint(),500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
 
 	  if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1){
-	    MyFill("proton_E_si_Q3",500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("proton_E_si_vs_Theta_Q3",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("proton_E_si_vs_IntPoint_Q3",500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_Q3(),500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_vs_Theta_Q3(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_vs_IntPoint_Q3(),500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
 	  }else if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3){
-	    MyFill("proton_E_si_SX3_1",500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("proton_E_si_vs_Theta_SX3_1",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("proton_E_si_vs_IntPoint_SX3_1",500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_SX3_1(),500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_vs_Theta_SX3_1(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_vs_IntPoint_SX3_1(),500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
 	  }else if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15){
-	    MyFill("proton_E_si_SX3_2",500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("proton_E_si_vs_Theta_SX3_2",500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
-	    MyFill("proton_E_si_vs_IntPoint_SX3_2",500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_SX3_2(),500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_vs_Theta_SX3_2(),500,0,200,Tr.TrEvent[c].Theta*ConvAngle,500,0,35,Tr.TrEvent[c].SiEnergy);
+	    fh.Fill(hproton_E_si_vs_IntPoint_SX3_2(),500,0,60,Tr.TrEvent[c].IntPoint,500,0,35,Tr.TrEvent[c].SiEnergy);
 	  }
 
 	  if(Tr.TrEvent[c].SiEnergy>0.0 && Tr.TrEvent[c].SiEnergy<40.0 && Tr.TrEvent[c].PathLength>0.0 && Tr.TrEvent[c].PathLength<100.0 &&
@@ -1163,19 +1299,19 @@ cout << argv[3] << endl;
 	    E_proton_rxn = E_Loss_proton->GetLookupEnergy(Tr.TrEvent[c].SiEnergy,(-Tr.TrEvent[c].PathLength));
 	    Tr.TrEvent[c].LightParEnergy = E_proton_rxn;
 	    
-	      MyFill("proton_E_rxn",500,0,40,E_proton_rxn);
+	      fh.Fill(hproton_E_rxn(),500,0,40,E_proton_rxn);
 
 	      if(Tr.TrEvent[c].DetID<4 && Tr.TrEvent[c].DetID>-1){
-		MyFill("proton_E_q3",500,0,40,E_proton_rxn);
-		MyFill("InteractionPoint_protoncut_QQQ",300,-10,56,Tr.TrEvent[c].IntPoint);
+		fh.Fill(hproton_E_q3(),500,0,40,E_proton_rxn);
+		fh.Fill(hInteractionPoint_protoncut_QQQ(),300,-10,56,Tr.TrEvent[c].IntPoint);
 	      }
 	      if(Tr.TrEvent[c].DetID<16 && Tr.TrEvent[c].DetID>3){
-		MyFill("proton_E_r1",500,0,40,E_proton_rxn);
-		MyFill("InteractionPoint_protoncut_r1",300,-10,56,Tr.TrEvent[c].IntPoint);
+		fh.Fill(hproton_E_r1(),500,0,40,E_proton_rxn);
+		fh.Fill(hInteractionPoint_protoncut_r1(),300,-10,56,Tr.TrEvent[c].IntPoint);
 	      }
 	      if(Tr.TrEvent[c].DetID<28 && Tr.TrEvent[c].DetID>15){
-		MyFill("proton_E_r2",500,0,40,E_proton_rxn);
-		MyFill("InteractionPoint__protoncut_r2",300,-10,56,Tr.TrEvent[c].IntPoint);
+		fh.Fill(hproton_E_r2(),500,0,40,E_proton_rxn);
+		fh.Fill(hInteractionPoint__protoncut_r2(),300,-10,56,Tr.TrEvent[c].IntPoint);
 	      }
 
 	    //16O beam Energy Calculation from the Elastic scattering: 
@@ -1197,7 +1333,7 @@ cout << argv[3] << endl;
       */
       //////////////////////////////////////////////////////////////////////////////////////////// 
 #ifdef FillTree
-      MainTree->Fill();
+      MainFill.Fill();
 #endif
       //////////////////////////////////////////////////////////////////////////////
 
@@ -1234,6 +1370,7 @@ cout << argv[3] << endl;
    //cout << "Tr.NTracks= " << Tr.NTracks << " Tr.NTracks1= " << Tr.NTracks1 << " Tr.NTracks2= " << Tr.NTracks2 << " Tr.NTracks3= " << Tr.NTracks3 <<endl;
 
     }
+    read_stats += input.GetStats();
     ////////////////////////////////////////////////////////////////////////////////   
   }
   //////////////////////////////////////////////////////////////////////////////////
@@ -1246,6 +1383,8 @@ cout << argv[3] << endl;
   */
 
   cout << endl;
+  MainFill.Finish();
+  read_stats.Print("Input MainTree");
   outputfile->cd();
   RootObjects->Write(); 
   cout << "RootObjects are Written" << endl;
@@ -1382,33 +1521,3 @@ Int_t FindMaxPC(Double_t phi, PCHit& PC){
 /////////////////////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////////////////////
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX){
-  try{
-    fhmap.at(name)->Fill(valueX);
-  } catch(out_of_range e) {
-    TH1F* newHist = new TH1F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX);
-    newHist->Fill(valueX);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }
-}
-////=================================================================================
-void MyFill(string name,
-	    int binsX, double lowX, double highX, double valueX,
-	    int binsY, double lowY, double highY, double valueY){
-
-  try{
-    //cout << name << endl;
-    fhmap.at(name)->Fill(valueX,valueY);
-  } catch(std::out_of_range e) {
-    TH2F* newHist = new TH2F(name.c_str(),name.c_str(),
-			     binsX,lowX,highX,
-			     binsY,lowY,highY);
-    newHist->Fill(valueX,valueY);
-    fhlist->Add(newHist);
-    fhmap[name] = newHist;
-  }  
-}
-/////////////////////////////////////////////////////////////////////////////////////